@@ -0,0 +1,167 @@
+// A small timing harness in the spirit of Google Benchmark, for the flippy benchmarks.
+//
+// Every benchmark is a callable that performs a given number of operations. The harness first grows the number of
+// operations until one batch takes at least the minimal time, and then times several batches of that size.
+// The reported time per operation is the median of those batches, and the fastest batch is reported as well.
+#ifndef FLIPPY_BENCH_HARNESS_HPP
+#define FLIPPY_BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "flippy.hpp"
+
+namespace bench {
+
+//! Keeps the compiler from optimizing away the computation of `value`.
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<T const volatile*>(&value));
+#endif
+}
+
+struct Result{
+    std::string name;
+    std::string size;
+    std::size_t n_nodes;
+    std::uint64_t operations_per_batch;
+    double ns_per_operation;
+    double min_ns_per_operation;
+};
+
+struct Options{
+    double min_batch_seconds = 0.05;
+    unsigned repetitions = 5;
+    std::string filter{};
+    std::string format = "table";
+    std::string output_file{};
+    bool full = false;
+};
+
+//! Parses `--min-time=<seconds>`, `--repetitions=<n>`, `--filter=<substring>`, `--format=<table|json|csv>`,
+//! `--out=<file>` and `--full`. Unknown arguments are reported and ignored.
+inline Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i<argc; ++i) {
+        std::string_view const arg(argv[i]);
+        auto value_of = [&](std::string_view key) { return std::string(arg.substr(key.size())); };
+        if (arg.starts_with("--min-time=")) { options.min_batch_seconds = std::stod(value_of("--min-time=")); }
+        else if (arg.starts_with("--repetitions=")) { options.repetitions = static_cast<unsigned>(std::stoul(value_of("--repetitions="))); }
+        else if (arg.starts_with("--filter=")) { options.filter = value_of("--filter="); }
+        else if (arg.starts_with("--format=")) { options.format = value_of("--format="); }
+        else if (arg.starts_with("--out=")) { options.output_file = value_of("--out="); }
+        else if (arg=="--full") { options.full = true; }
+        else { std::cerr << "ignoring unknown argument " << arg << '\n'; }
+    }
+    options.repetitions = std::max(1u, options.repetitions);
+    return options;
+}
+
+class Harness
+{
+private:
+    Options options_;
+    std::vector<Result> results_{};
+
+    template<typename Operation>
+    static double batch_seconds(Operation& operation, std::uint64_t n_operations)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        operation(n_operations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    explicit Harness(Options options) :options_(std::move(options)) { }
+
+    [[nodiscard]] Options const& options() const { return options_; }
+
+    [[nodiscard]] bool is_selected(std::string const& name) const
+    {
+        return options_.filter.empty() || name.find(options_.filter)!=std::string::npos;
+    }
+
+    //! Times `operation(n)`, which has to perform `n` operations, and records the time per operation.
+    template<typename Operation>
+    void run(std::string const& name, std::string const& size, std::size_t n_nodes, Operation&& operation)
+    {
+        if (!is_selected(name)) { return; }
+        std::uint64_t n_operations = 1;
+        double seconds = batch_seconds(operation, n_operations);
+        while (seconds<options_.min_batch_seconds) {
+            double const growth = seconds>0 ? std::min(10., 1.4*options_.min_batch_seconds/seconds) : 10.;
+            n_operations = std::max(n_operations + 1, static_cast<std::uint64_t>(static_cast<double>(n_operations)*growth));
+            seconds = batch_seconds(operation, n_operations);
+        }
+        std::vector<double> ns_per_operation;
+        for (unsigned repetition = 0; repetition<options_.repetitions; ++repetition) {
+            ns_per_operation.push_back(1e9*batch_seconds(operation, n_operations)/static_cast<double>(n_operations));
+        }
+        std::sort(ns_per_operation.begin(), ns_per_operation.end());
+        results_.push_back({name, size, n_nodes, n_operations, ns_per_operation[ns_per_operation.size()/2], ns_per_operation.front()});
+        if (options_.format=="table") { print_row(results_.back()); }
+    }
+
+    [[nodiscard]] std::vector<Result> const& results() const { return results_; }
+
+    static void print_header()
+    {
+        std::printf("%-34s %-12s %10s %14s %14s %14s\n", "benchmark", "size", "nodes", "ops/batch", "ns/op", "min ns/op");
+    }
+
+    static void print_row(Result const& result)
+    {
+        std::printf("%-34s %-12s %10zu %14llu %14.1f %14.1f\n", result.name.c_str(), result.size.c_str(), result.n_nodes,
+                    static_cast<unsigned long long>(result.operations_per_batch), result.ns_per_operation, result.min_ns_per_operation);
+        std::fflush(stdout);
+    }
+
+    [[nodiscard]] fp::Json json() const
+    {
+        fp::Json data;
+        data["context"] = {{"min_batch_seconds", options_.min_batch_seconds}, {"repetitions", options_.repetitions}};
+        data["benchmarks"] = fp::Json::array();
+        for (auto const& result: results_) {
+            data["benchmarks"].push_back({{"name", result.name}, {"size", result.size}, {"n_nodes", result.n_nodes},
+                                          {"operations_per_batch", result.operations_per_batch},
+                                          {"ns_per_operation", result.ns_per_operation},
+                                          {"min_ns_per_operation", result.min_ns_per_operation}});
+        }
+        return data;
+    }
+
+    void write_csv(std::ostream& out) const
+    {
+        out << "name,size,n_nodes,operations_per_batch,ns_per_operation,min_ns_per_operation\n";
+        for (auto const& result: results_) {
+            out << result.name << ',' << result.size << ',' << result.n_nodes << ',' << result.operations_per_batch << ','
+                << result.ns_per_operation << ',' << result.min_ns_per_operation << '\n';
+        }
+    }
+
+    //! Writes the machine-readable report to the output file, or to the standard output if no file was requested.
+    void report() const
+    {
+        if (options_.format=="table") { return; }
+        std::ofstream file;
+        if (!options_.output_file.empty()) { file.open(options_.output_file); }
+        std::ostream& out = options_.output_file.empty() ? std::cout : file;
+        if (options_.format=="json") { out << json().dump(2) << '\n'; }
+        else if (options_.format=="csv") { write_csv(out); }
+        else { std::cerr << "unknown format " << options_.format << '\n'; }
+    }
+};
+
+}
+#endif //FLIPPY_BENCH_HARNESS_HPP
@@ -0,0 +1,221 @@
+// Microbenchmarks of the hot paths of flippy, on spheres and planes of increasing size.
+//
+// By default, spheres with n_iter 5 to 20 and planes from 30x30 to 100x100 nodes are measured. `--full` adds spheres
+// up to n_iter 100 and planes up to 1000x1000 nodes. See bench_harness.hpp for the other command line options.
+#define TESTING_FLIPPY_TRIANGULATION_ndh6jclc0qnp274b = 1
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench_harness.hpp"
+
+namespace {
+
+std::vector<std::string> const local_benchmark_names{"update_bulk_node_geometry", "move_node", "flip_bond+unflip_bond",
+                                                     "make_verlet_list", "make_egg_data", "sweep"};
+
+using Sphere = fp::Triangulation<double, unsigned>;
+using Plane = fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>;
+
+constexpr double l_min = 2;
+constexpr double l_max = 2*l_min;
+
+struct EnergyParameters{double kappa, K_V, K_A, V_t, A_t;};
+
+template<fp::TriangulationType triangulation_type>
+double surface_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                      fp::Triangulation<double, unsigned, triangulation_type> const& trg, EnergyParameters const& prms)
+{
+    double const dA = trg.global_geometry().area - prms.A_t;
+    double energy = prms.kappa*trg.global_geometry().unit_bending_energy + prms.K_A*dA*dA/prms.A_t;
+    if constexpr (triangulation_type==fp::SPHERICAL_TRIANGULATION) {
+        double const dV = trg.global_geometry().volume - prms.V_t;
+        energy += prms.K_V*dV*dV/prms.V_t;
+    }
+    return energy;
+}
+
+//! Radius of a sphere whose bonds are about l_min long, as in the demos.
+double sphere_radius(unsigned n_iter)
+{
+    return l_min/(2*std::sin(std::asin(1./(2*std::sin(2.*std::numbers::pi/5.)))/(n_iter + 1.)));
+}
+
+Sphere make_sphere(unsigned n_iter) { return Sphere(n_iter, sphere_radius(n_iter), 2*l_max); }
+
+Plane make_plane(unsigned n_side)
+{
+    double const side = 1.2*l_min*n_side;
+    return Plane(n_side, n_side, side, side, 2*l_max);
+}
+
+std::string sphere_size(unsigned n_iter) { return "n_iter=" + std::to_string(n_iter); }
+
+std::string plane_size(unsigned n_side) { return std::to_string(n_side) + "x" + std::to_string(n_side); }
+
+//! Ids of nodes that are not on the boundary, in a random order.
+template<fp::TriangulationType triangulation_type>
+std::vector<unsigned> shuffled_bulk_nodes(fp::Triangulation<double, unsigned, triangulation_type> const& trg, std::mt19937& rng)
+{
+    std::vector<unsigned> node_ids;
+    for (auto const& node: trg.nodes()) {
+        if constexpr (triangulation_type==fp::EXPERIMENTAL_PLANAR_TRIANGULATION) {
+            if (trg.boundary_nodes_ids_set().contains(node.id)) { continue; }
+        }
+        node_ids.push_back(node.id);
+    }
+    std::shuffle(node_ids.begin(), node_ids.end(), rng);
+    return node_ids;
+}
+
+template<fp::TriangulationType triangulation_type>
+void local_benchmarks(bench::Harness& harness, std::string const& kind, std::string const& size,
+                      fp::Triangulation<double, unsigned, triangulation_type>& trg)
+{
+    std::mt19937 rng(2024);
+    std::vector<unsigned> const node_ids = shuffled_bulk_nodes(trg, rng);
+    std::normal_distribution<double> displacement_distr(0, 1e-3*l_min);
+    std::vector<fp::vec3<double>> displacements;
+    for (std::size_t i = 0; i<node_ids.size(); ++i) {
+        displacements.push_back({displacement_distr(rng), displacement_distr(rng), displacement_distr(rng)});
+    }
+
+    harness.run("update_bulk_node_geometry/" + kind, size, trg.size(), [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i<n; ++i) { trg.update_bulk_node_geometry(node_ids[i%node_ids.size()]); }
+        bench::do_not_optimize(trg[node_ids.front()].area);
+    });
+
+    harness.run("move_node/" + kind, size, trg.size(), [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i<n; ++i) {
+            std::size_t const k = i%node_ids.size();
+            trg.move_node(node_ids[k], displacements[k]);
+            displacements[k] = -displacements[k];
+        }
+        bench::do_not_optimize(trg.global_geometry().area);
+    });
+
+    // every flip is undone right away, so the same bonds can be flipped over and over
+    harness.run("flip_bond+unflip_bond/" + kind, size, trg.size(), [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i<n; ++i) {
+            unsigned const node_id = node_ids[i%node_ids.size()];
+            auto const& nn_ids = trg[node_id].nn_ids;
+            unsigned const nn_id = nn_ids[i%nn_ids.size()];
+            auto const bfd = trg.flip_bond(node_id, nn_id, 0, l_max*l_max);
+            if (bfd.flipped) { trg.unflip_bond(node_id, nn_id, bfd); }
+        }
+        bench::do_not_optimize(trg.global_geometry().area);
+    });
+
+    harness.run("make_verlet_list/" + kind, size, trg.size(), [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i<n; ++i) { trg.make_verlet_list(); }
+        bench::do_not_optimize(trg[node_ids.front()].verlet_list.size());
+    });
+
+    harness.run("make_egg_data/" + kind, size, trg.size(), [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i<n; ++i) {
+            fp::Json const data = trg.make_egg_data();
+            bench::do_not_optimize(data.size());
+        }
+    });
+}
+
+//! Cost of one uniform number in `[0, 1)`, drawn one at a time or in batches of `batch_size` numbers.
+template<fp::full_range_engine Engine>
+void uniform_benchmarks(bench::Harness& harness, std::string const& engine_name, Engine engine)
+{
+    constexpr std::size_t batch_size = 1024;
+    harness.run("uniform/" + engine_name, "double", 0, [&](std::uint64_t n) {
+        double sum = 0;
+        for (std::uint64_t i = 0; i<n; ++i) { sum += fp::uniform_real<double>(engine); }
+        bench::do_not_optimize(sum);
+    });
+    if constexpr (requires(std::span<double> out) { engine.fill_uniform(out); }) {
+        std::vector<double> batch(batch_size);
+        harness.run("uniform/" + engine_name + "/batch", "double", 0, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i<n; i += batch_size) {
+                engine.fill_uniform(std::span<double>(batch.data(), std::min<std::uint64_t>(batch_size, n - i)));
+                bench::do_not_optimize(batch.front());
+            }
+        });
+    }
+}
+
+void random_number_benchmarks(bench::Harness& harness)
+{
+    std::mt19937 mt19937(2024);
+    std::uniform_real_distribution<double> unif_distr_on_01(0, 1);
+    harness.run("uniform/mt19937/std::uniform_real_distribution", "double", 0, [&](std::uint64_t n) {
+        double sum = 0;
+        for (std::uint64_t i = 0; i<n; ++i) { sum += unif_distr_on_01(mt19937); }
+        bench::do_not_optimize(sum);
+    });
+    uniform_benchmarks(harness, "mt19937", std::mt19937(2024));
+    uniform_benchmarks(harness, "mt19937_64", std::mt19937_64(2024));
+    uniform_benchmarks(harness, "Philox4x32", fp::Philox4x32(2024));
+    uniform_benchmarks(harness, "Xoshiro256StarStar", fp::Xoshiro256StarStar(2024));
+}
+
+template<fp::TriangulationType triangulation_type>
+void sweep_benchmark(bench::Harness& harness, std::string const& kind, std::string const& size,
+                     fp::Triangulation<double, unsigned, triangulation_type>& trg)
+{
+    EnergyParameters const prms{.kappa=10, .K_V=100, .K_A=1000,
+                                .V_t=0.9*trg.global_geometry().volume, .A_t=trg.global_geometry().area};
+    std::mt19937 rng(2023);
+    fp::MonteCarloUpdater<double, unsigned, EnergyParameters, std::mt19937, triangulation_type>
+            updater(trg, prms, surface_energy<triangulation_type>, rng, l_min, l_max);
+    updater.reset_linear_displacement(l_min/8);
+    harness.run("sweep/" + kind, size, trg.size(), [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i<n; ++i) { updater.sweep(); }
+        bench::do_not_optimize(trg.global_geometry().area);
+    });
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    bench::Harness harness(bench::parse_options(argc, argv));
+    bool const full = harness.options().full;
+    std::vector<unsigned> const sphere_n_iters = full ? std::vector<unsigned>{5, 10, 20, 50, 100} : std::vector<unsigned>{5, 10, 20};
+    std::vector<unsigned> const plane_sides = full ? std::vector<unsigned>{30, 100, 300, 1000} : std::vector<unsigned>{30, 100};
+    if (harness.options().format=="table") { bench::Harness::print_header(); }
+    random_number_benchmarks(harness);
+
+    for (unsigned n_iter: sphere_n_iters) {
+        std::string const size = sphere_size(n_iter);
+        Sphere sphere = make_sphere(n_iter);
+        Sphere const unswept_sphere = sphere;
+        harness.run("triangulate_sphere_nodes", size, sphere.size(), [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i<n; ++i) {
+                auto const nodes = Sphere::triangulate_sphere_nodes(n_iter);
+                bench::do_not_optimize(nodes.size());
+            }
+        });
+        local_benchmarks(harness, "sphere", size, sphere);
+        sweep_benchmark(harness, "sphere", size, sphere);
+        // the same sweeps after the nodes were sorted along a space-filling curve, to compare with the generation order
+        for (auto const& [curve_name, curve]: {std::pair{"hilbert", fp::HILBERT_CURVE}, std::pair{"morton", fp::MORTON_CURVE}}) {
+            if (!harness.is_selected(std::string("sweep/sphere/") + curve_name)) { continue; }
+            Sphere reordered_sphere = unswept_sphere;
+            reordered_sphere.reorder_nodes(curve);
+            sweep_benchmark(harness, std::string("sphere/") + curve_name, size, reordered_sphere);
+        }
+    }
+
+    for (unsigned n_side: plane_sides) {
+        std::string const size = plane_size(n_side);
+        // building the largest planes takes a while, so they are skipped if the filter excludes all plane benchmarks
+        if (std::none_of(local_benchmark_names.begin(), local_benchmark_names.end(),
+                         [&](std::string const& name) { return harness.is_selected(name + "/plane"); })) { continue; }
+        Plane plane = make_plane(n_side);
+        local_benchmarks(harness, "plane", size, plane);
+        sweep_benchmark(harness, "plane", size, plane);
+    }
+
+    harness.report();
+    return 0;
+}
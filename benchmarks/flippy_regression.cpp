@@ -0,0 +1,390 @@
+// Performance regression check of the demo workloads against a saved baseline.
+//
+// The biconcave vesicle of demo/biconcave_shapes_MC and the annealed planar sheet of
+// demo/planar_membrane_sheet_fluctuation_MC are run with fixed seeds and a fixed number of sweeps. For every workload,
+// the sweeps per second, the peak resident set size and the number and size of the heap allocations during the sweeps
+// are measured and compared with the baseline file, together with the energy at the end of the run. The program exits
+// with a non-zero status if any metric is worse than the baseline by more than the threshold, or if the final energy
+// differs from the baseline by more than the energy tolerance, which catches changes of the behavior at fixed seeds.
+// The sweeps per second depend on the machine and the peak resident set size depends on the C and C++ runtime, so the
+// ctest registration skips them with --no-timing and --no-rss.
+//
+// The workloads draw from fp::Xoshiro256StarStar, the displacements and flip partners come from fp::uniform_real() and
+// the node order is shuffled by a Fisher-Yates shuffle of its own, so the trajectories do not depend on the
+// implementation-defined std::uniform_real_distribution and std::shuffle of the standard library. The only standard
+// distribution left is the one of the Metropolis decisions in MonteCarloUpdater, which turns one number of the 64 bit
+// engine into a uniform number with std::generate_canonical, whose algorithm the standard specifies.
+//
+// Every run of a workload happens in a child process of its own, so that the peak resident set size of one workload does
+// not hide the one of the next. This needs fork() and getrusage(), so the harness only builds on POSIX systems.
+// The workloads are deterministic, so only the speed differs between repetitions, and the fastest repetition is used.
+//
+// Options:
+//   --baseline=<file>     baseline to compare with (default: regression_baseline.json next to this file)
+//   --threshold=<frac>    allowed relative regression of every metric (default 0.1, i.e. 10%)
+//   --energy-tolerance=<frac>  allowed relative difference of the final energy (default 1e-9)
+//   --no-timing           do not compare the sweeps per second
+//   --no-rss              do not compare the peak resident set size
+//   --repetitions=<n>     number of runs of every workload (default 3)
+//   --write-baseline      overwrite the baseline with the current measurements instead of comparing
+//   --filter=<substring>  only run the workloads whose name contains the substring
+//   --out=<file>          also write the current measurements to a file, in the format of the baseline
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <numbers>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bench_harness.hpp"
+
+#ifndef FLIPPY_REGRESSION_BASELINE
+#define FLIPPY_REGRESSION_BASELINE "regression_baseline.json"
+#endif
+
+namespace {
+
+std::atomic<std::uint64_t> allocation_count{0};
+std::atomic<std::uint64_t> allocated_bytes{0};
+
+void* counted_allocation(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size>0 ? size : 1)) { return pointer; }
+    throw std::bad_alloc();
+}
+
+}
+
+// every allocation of the program goes through these replacements, so the allocations of flippy, the standard library
+// and the json library are all counted
+void* operator new(std::size_t size) { return counted_allocation(size); }
+void* operator new[](std::size_t size) { return counted_allocation(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    try { return counted_allocation(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    try { return counted_allocation(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace {
+
+constexpr double l_min = 2;
+constexpr double l_max = 2*l_min;
+
+//! Direction in which a metric gets worse. Metrics that are `changed` must reproduce the baseline.
+enum class Worse{lower, higher, changed};
+
+struct Metric{
+    char const* name;
+    Worse worse;
+    bool is_timing{false};
+    bool is_resident_set_size{false};
+};
+
+std::vector<Metric> const metrics{
+        {"sweeps_per_second", Worse::lower, true},
+        {"peak_rss_kib", Worse::higher, false, true},
+        {"allocations_per_sweep", Worse::higher},
+        {"allocated_bytes_per_sweep", Worse::higher},
+        {"final_energy", Worse::changed},
+};
+
+struct Options{
+    std::string baseline_file = FLIPPY_REGRESSION_BASELINE;
+    std::string output_file{};
+    std::string filter{};
+    double threshold = 0.1;
+    double energy_tolerance = 1e-9;
+    bool compare_timing = true;
+    bool compare_rss = true;
+    unsigned repetitions = 3;
+    bool write_baseline = false;
+};
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i<argc; ++i) {
+        std::string_view const arg(argv[i]);
+        auto value_of = [&](std::string_view key) { return std::string(arg.substr(key.size())); };
+        if (arg.starts_with("--baseline=")) { options.baseline_file = value_of("--baseline="); }
+        else if (arg.starts_with("--threshold=")) { options.threshold = std::stod(value_of("--threshold=")); }
+        else if (arg.starts_with("--energy-tolerance=")) { options.energy_tolerance = std::stod(value_of("--energy-tolerance=")); }
+        else if (arg=="--no-timing") { options.compare_timing = false; }
+        else if (arg=="--no-rss") { options.compare_rss = false; }
+        else if (arg.starts_with("--repetitions=")) { options.repetitions = static_cast<unsigned>(std::stoul(value_of("--repetitions="))); }
+        else if (arg.starts_with("--filter=")) { options.filter = value_of("--filter="); }
+        else if (arg.starts_with("--out=")) { options.output_file = value_of("--out="); }
+        else if (arg=="--write-baseline") { options.write_baseline = true; }
+        else { std::cerr << "ignoring unknown argument " << arg << '\n'; }
+    }
+    options.repetitions = std::max(1u, options.repetitions);
+    return options;
+}
+
+//! Duration and heap allocations of the sweeps of a workload.
+struct SweepMeasurement{
+    double seconds{0};
+    std::uint64_t allocations{0}, allocated_bytes{0};
+};
+
+//! Runs `sweep(i)` for `n_sweeps` sweeps.
+template<typename Sweep>
+SweepMeasurement measure_sweeps(unsigned n_sweeps, Sweep&& sweep)
+{
+    std::uint64_t const allocations_before = allocation_count.load(std::memory_order_relaxed);
+    std::uint64_t const bytes_before = allocated_bytes.load(std::memory_order_relaxed);
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i<n_sweeps; ++i) { sweep(i); }
+    return {.seconds=std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+            .allocations=allocation_count.load(std::memory_order_relaxed) - allocations_before,
+            .allocated_bytes=allocated_bytes.load(std::memory_order_relaxed) - bytes_before};
+}
+
+//! Peak resident set size of the calling process in KiB.
+std::uint64_t peak_rss_kib()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss)/1024;
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#endif
+}
+
+//! Metrics of a workload.
+fp::Json metrics_json(SweepMeasurement const& measurement, unsigned n_sweeps, std::size_t n_nodes, double final_energy)
+{
+    double const sweeps = n_sweeps;
+    return {{"n_nodes", n_nodes}, {"sweeps", n_sweeps}, {"final_energy", final_energy},
+            {"sweeps_per_second", sweeps/measurement.seconds},
+            {"peak_rss_kib", peak_rss_kib()},
+            {"allocations_per_sweep", static_cast<double>(measurement.allocations)/sweeps},
+            {"allocated_bytes_per_sweep", static_cast<double>(measurement.allocated_bytes)/sweeps}};
+}
+
+//! Uniform random index in `[0, n)`.
+std::size_t uniform_index(std::size_t n, fp::Xoshiro256StarStar& rng)
+{
+    return std::min(n - 1, static_cast<std::size_t>(fp::uniform_real<double>(rng)*static_cast<double>(n)));
+}
+
+//! Node move and bond flip sweep of the demos. The nodes are moved in the order of the previous shuffle, then the order
+//! is shuffled again and the bonds are flipped.
+template<typename Updater, typename Triangulation>
+void demo_sweep(Updater& updater, Triangulation& trg, std::vector<unsigned>& shuffled_ids, double max_displ,
+                fp::Xoshiro256StarStar& rng)
+{
+    auto draw_displ = [&]() { return max_displ*(2*fp::uniform_real<double>(rng) - 1); };
+    for (unsigned node_id: shuffled_ids) {
+        fp::vec3<double> const displ{draw_displ(), draw_displ(), draw_displ()};
+        updater.move_MC_updater(trg[node_id], displ);
+    }
+    for (std::size_t i = shuffled_ids.size(); i>1; --i) { std::swap(shuffled_ids[i - 1], shuffled_ids[uniform_index(i, rng)]); }
+    for (unsigned node_id: shuffled_ids) {
+        auto const& node = trg[node_id];
+        updater.flip_MC_updater(node, node.nn_ids[uniform_index(node.nn_ids.size(), rng)]);
+    }
+}
+
+struct SphereParameters{double kappa, K_V, K_A, V_t, A_t;};
+
+double sphere_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                     fp::Triangulation<double, unsigned> const& trg, SphereParameters const& prms)
+{
+    double const dV = trg.global_geometry().volume - prms.V_t;
+    double const dA = trg.global_geometry().area - prms.A_t;
+    return prms.kappa*trg.global_geometry().unit_bending_energy + prms.K_V*dV*dV/prms.V_t + prms.K_A*dA*dA/prms.A_t;
+}
+
+//! The setup of demo/biconcave_shapes_MC: a squished vesicle with 642 nodes that relaxes towards a biconcave shape.
+fp::Json biconcave_sphere()
+{
+    constexpr unsigned n_triang = 7;
+    constexpr unsigned n_sweeps = 1000;
+    double const R = l_min/(2*std::sin(std::asin(1./(2*std::sin(2.*std::numbers::pi/5.)))/(n_triang + 1.)));
+    SphereParameters const prms{.kappa=10, .K_V=100, .K_A=1000,
+                                .V_t=0.6*4./3.*std::numbers::pi*R*R*R, .A_t=4.*std::numbers::pi*R*R};
+    fp::Xoshiro256StarStar rng(2023);
+    fp::Triangulation<double, unsigned> guv(n_triang, R, 2*l_max);
+    fp::MonteCarloUpdater<double, unsigned, SphereParameters, fp::Xoshiro256StarStar, fp::SPHERICAL_TRIANGULATION>
+            updater(guv, prms, sphere_energy, rng, l_min, l_max);
+    guv.scale_node_coordinates(1, 1, 0.8);
+
+    std::vector<unsigned> shuffled_ids;
+    for (auto const& node: guv.nodes()) { shuffled_ids.push_back(node.id); }
+    auto const measurement = measure_sweeps(n_sweeps, [&](unsigned) { demo_sweep(updater, guv, shuffled_ids, l_min/8., rng); });
+    return metrics_json(measurement, n_sweeps, guv.size(), sphere_energy(guv[0], guv, prms));
+}
+
+struct PlaneParameters{double kappa, K_A, A_t;};
+
+double plane_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                    fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION> const& trg,
+                    PlaneParameters const& prms)
+{
+    double const dA = trg.global_geometry().area - prms.A_t;
+    return prms.kappa*trg.global_geometry().unit_bending_energy + prms.K_A*dA*dA/prms.A_t;
+}
+
+//! The setup of demo/planar_membrane_sheet_fluctuation_MC: a 30x30 sheet that is annealed during the second half of the run.
+fp::Json planar_fluctuation()
+{
+    constexpr unsigned n_side = 30;
+    constexpr unsigned n_sweeps = 1000;
+    double const side = 1.05*(n_side - 1)*l_min;
+    PlaneParameters const prms{.kappa=2, .K_A=1000, .A_t=side*side};
+    fp::Xoshiro256StarStar rng(2023);
+    fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION> sheet(n_side, n_side, side, side, 2*l_max);
+    fp::MonteCarloUpdater<double, unsigned, PlaneParameters, fp::Xoshiro256StarStar, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>
+            updater(sheet, prms, plane_energy, rng, l_min, l_max);
+
+    std::vector<unsigned> shuffled_ids;
+    for (auto const& node: sheet.nodes()) { shuffled_ids.push_back(node.id); }
+    auto const measurement = measure_sweeps(n_sweeps, [&](unsigned sweep) {
+        demo_sweep(updater, sheet, shuffled_ids, l_min/10., rng);
+        if (sweep>=n_sweeps/2) { updater.reset_kBT(1. - 2.*(static_cast<double>(sweep)/n_sweeps - 0.5)); }
+    });
+    return metrics_json(measurement, n_sweeps, sheet.size(), plane_energy(sheet[0], sheet, prms));
+}
+
+struct Workload{
+    char const* name;
+    std::function<fp::Json()> run;
+};
+
+std::vector<Workload> const workloads{
+        {"biconcave_sphere", biconcave_sphere},
+        {"planar_fluctuation", planar_fluctuation},
+};
+
+//! Runs the workload in a child process and returns its metrics, or `null` if the child failed.
+fp::Json run_in_child_process(Workload const& workload)
+{
+    int pipe_ends[2];
+    if (pipe(pipe_ends)!=0) { return nullptr; }
+    std::fflush(nullptr);
+    pid_t const pid = fork();
+    if (pid<0) { return nullptr; }
+    if (pid==0) {
+        close(pipe_ends[0]);
+        std::string const data = workload.run().dump();
+        bool const written = write(pipe_ends[1], data.data(), data.size())==static_cast<ssize_t>(data.size());
+        close(pipe_ends[1]);
+        _exit(written ? 0 : 1);
+    }
+    close(pipe_ends[1]);
+    std::string data;
+    char buffer[4096];
+    for (ssize_t n; (n = read(pipe_ends[0], buffer, sizeof(buffer)))>0;) { data.append(buffer, static_cast<std::size_t>(n)); }
+    close(pipe_ends[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status)!=0) { return nullptr; }
+    return fp::Json::parse(data, nullptr, false);
+}
+
+//! Relative change of a metric.
+double relative_change(double baseline, double current)
+{
+    if (baseline==current) { return 0; }
+    if (baseline==0) { return current>0 ? INFINITY : -INFINITY; }
+    return (current - baseline)/baseline;
+}
+
+//! Prints the comparison of every metric and returns the number of regressions.
+unsigned compare(std::string const& workload, fp::Json const& baseline, fp::Json const& current, Options const& options)
+{
+    unsigned n_regressions = 0;
+    for (auto const& metric: metrics) {
+        if (metric.is_timing && !options.compare_timing) { continue; }
+        if (metric.is_resident_set_size && !options.compare_rss) { continue; }
+        double const current_value = current[metric.name].get<double>();
+        if (!baseline.contains(metric.name)) {
+            std::printf("%-20s %-26s %14s %14.6g %9s  no baseline\n", workload.c_str(), metric.name, "-", current_value, "-");
+            continue;
+        }
+        double const baseline_value = baseline[metric.name].get<double>();
+        double const change = relative_change(baseline_value, current_value);
+        bool const failed = metric.worse==Worse::changed ? std::abs(change)>options.energy_tolerance
+                                                         : (metric.worse==Worse::higher ? change : -change)>options.threshold;
+        n_regressions += failed;
+        std::printf("%-20s %-26s %14.6g %14.6g %+8.1f%%  %s\n", workload.c_str(), metric.name, baseline_value,
+                    current_value, 100*change, failed ? "REGRESSION" : "ok");
+    }
+    return n_regressions;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options const options = parse_options(argc, argv);
+    fp::Json baseline;
+    if (!options.write_baseline) {
+        std::ifstream baseline_file(options.baseline_file);
+        if (!baseline_file) {
+            std::cerr << "can not read the baseline " << options.baseline_file << ", create it with --write-baseline\n";
+            return 2;
+        }
+        baseline = fp::Json::parse(baseline_file);
+    }
+
+    fp::Json current;
+    current["workloads"] = fp::Json::object();
+    unsigned n_regressions = 0, n_failures = 0;
+    if (!options.write_baseline) {
+        std::printf("%-20s %-26s %14s %14s %9s\n", "workload", "metric", "baseline", "current", "change");
+    }
+    for (auto const& workload: workloads) {
+        if (!options.filter.empty() && std::string(workload.name).find(options.filter)==std::string::npos) { continue; }
+        fp::Json result;
+        for (unsigned repetition = 0; repetition<options.repetitions; ++repetition) {
+            fp::Json const run = run_in_child_process(workload);
+            if (run.is_discarded() || run.is_null()) {
+                result = nullptr;
+                break;
+            }
+            if (repetition==0 || run["sweeps_per_second"].get<double>()>result["sweeps_per_second"].get<double>()) { result = run; }
+        }
+        if (result.is_null()) {
+            std::cerr << "workload " << workload.name << " failed\n";
+            ++n_failures;
+            continue;
+        }
+        current["workloads"][workload.name] = result;
+        if (options.write_baseline) { continue; }
+        if (!baseline["workloads"].contains(workload.name)) {
+            std::printf("%-20s has no baseline\n", workload.name);
+            continue;
+        }
+        n_regressions += compare(workload.name, baseline["workloads"][workload.name], result, options);
+    }
+
+    if (!options.output_file.empty()) { std::ofstream(options.output_file) << current.dump(2) << '\n'; }
+    if (options.write_baseline) {
+        std::ofstream(options.baseline_file) << current.dump(2) << '\n';
+        std::printf("wrote the baseline %s\n", options.baseline_file.c_str());
+    }
+    else if (n_regressions>0) {
+        std::printf("%u metrics regressed by more than %.0f%% or changed the final energy\n", n_regressions, 100*options.threshold);
+    }
+    return n_failures>0 || n_regressions>0 ? 1 : 0;
+}
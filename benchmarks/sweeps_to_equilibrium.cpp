@@ -0,0 +1,105 @@
+// Compares how many sweeps a vesicle needs to relax towards a biconcave shape with a fixed displacement amplitude and
+// with the adaptive displacement controller of the MonteCarloUpdater.
+//
+// A run counts as equilibrated at the first sweep at which the moving average of its energy has covered 95% of the
+// way from the initial energy to the lowest plateau energy of all runs.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "flippy.hpp"
+
+namespace {
+
+struct EnergyParameters{double kappa, K_V, K_A, V_t, A_t;};
+
+double surface_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                      fp::Triangulation<double, unsigned> const& trg, EnergyParameters const& prms)
+{
+    double dV = trg.global_geometry().volume - prms.V_t;
+    double dA = trg.global_geometry().area - prms.A_t;
+    return prms.kappa*trg.global_geometry().unit_bending_energy + prms.K_V*dV*dV/prms.V_t + prms.K_A*dA*dA/prms.A_t;
+}
+
+struct Run{
+    std::string name;
+    double initial_displacement;
+    bool adaptive;
+    std::vector<double> energies{};
+    double seconds{0}, final_displacement{0}, move_acceptance{0};
+};
+
+constexpr unsigned long n_sweeps = 3000;
+constexpr unsigned long n_adaptation_sweeps = 200;
+constexpr unsigned long averaging_window = 50;
+constexpr double target_move_acceptance_rate = 0.3;
+
+double moving_average(std::vector<double> const& energies, unsigned long end)
+{
+    unsigned long begin = end>averaging_window ? end - averaging_window : 0;
+    double sum = 0;
+    for (unsigned long i = begin; i<end; ++i) { sum += energies[i]; }
+    return sum/static_cast<double>(end - begin);
+}
+
+}
+
+int main()
+{
+    unsigned n_triang = 5;
+    double l_min = 2;
+    double R = l_min/(2*std::sin(std::asin(1./(2*std::sin(2.*M_PI/5.)))/(n_triang + 1.)));
+    double l_max = 2*l_min;
+    fp::Triangulation<double, unsigned> prototype(n_triang, R, 2*l_max);
+    prototype.scale_node_coordinates(1, 1, 0.8);
+    EnergyParameters prms{.kappa=10, .K_V=100, .K_A=1000,
+                          .V_t=0.6*4./3.*M_PI*R*R*R, .A_t=4.*M_PI*R*R};
+
+    std::vector<Run> runs{
+            {"fixed l_min/8", l_min/8, false},
+            {"fixed l_min/100", l_min/100, false},
+            {"fixed l_min", l_min, false},
+            {"adaptive from l_min/100", l_min/100, true},
+            {"adaptive from l_min", l_min, true},
+    };
+
+    for (auto& run: runs) {
+        fp::Triangulation<double, unsigned> guv(prototype);
+        std::mt19937 rng(2023);
+        fp::MonteCarloUpdater<double, unsigned, EnergyParameters, std::mt19937, fp::SPHERICAL_TRIANGULATION>
+                updater(guv, prms, surface_energy, rng, l_min, l_max);
+        updater.reset_linear_displacement(run.initial_displacement);
+        if (run.adaptive) { updater.adapt_linear_displacement(target_move_acceptance_rate, n_adaptation_sweeps); }
+        run.energies.push_back(surface_energy(guv[0], guv, prms));
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long sweep = 0; sweep<n_sweeps; ++sweep) {
+            updater.sweep();
+            run.energies.push_back(surface_energy(guv[0], guv, prms));
+        }
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        run.final_displacement = updater.linear_displacement();
+        run.move_acceptance = updater.last_sweep_move_acceptance_rate();
+    }
+
+    double plateau_energy = runs.front().energies.back();
+    for (auto const& run: runs) { plateau_energy = std::min(plateau_energy, moving_average(run.energies, run.energies.size())); }
+    double initial_energy = runs.front().energies.front();
+    double threshold = plateau_energy + 0.05*(initial_energy - plateau_energy);
+
+    std::printf("%zu nodes, %lu sweeps per run, initial energy %.1f, plateau energy %.1f\n",
+                static_cast<std::size_t>(prototype.size()), n_sweeps, initial_energy, plateau_energy);
+    std::printf("%-26s %12s %14s %12s %12s %10s\n", "run", "equilibrium", "final energy", "displacement", "acceptance", "seconds");
+    for (auto const& run: runs) {
+        std::string equilibrium = ">" + std::to_string(n_sweeps);
+        for (unsigned long sweep = 1; sweep<=n_sweeps; ++sweep) {
+            if (moving_average(run.energies, sweep + 1)<=threshold) {
+                equilibrium = std::to_string(sweep);
+                break;
+            }
+        }
+        std::printf("%-26s %12s %14.1f %12.4f %12.3f %10.2f\n", run.name.c_str(), equilibrium.c_str(),
+                    moving_average(run.energies, run.energies.size()), run.final_displacement, run.move_acceptance, run.seconds);
+    }
+    return 0;
+}
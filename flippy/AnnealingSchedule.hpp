@@ -0,0 +1,162 @@
+#ifndef FLIPPY_ANNEALINGSCHEDULE_HPP
+#define FLIPPY_ANNEALINGSCHEDULE_HPP
+/**
+ * @file
+ * @brief This file contains the AnnealingSchedule class template, which describes how the temperature of a
+ * MonteCarloUpdater changes from sweep to sweep.
+ */
+
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <stdexcept>
+#include "custom_concepts.hpp"
+
+namespace fp {
+
+//! This enum defines the types of temperature schedules that are implemented in AnnealingSchedule.
+/**
+ * @see AnnealingSchedule::type()
+ */
+enum AnnealingScheduleType{
+    //! The temperature stays constant. A constant temperature of zero is a greedy quench.
+    CONSTANT_KBT,
+    //! The temperature changes linearly from a start value to an end value.
+    LINEAR_ANNEALING,
+    //! The temperature changes geometrically from a start value to an end value.
+    EXPONENTIAL_ANNEALING,
+    //! The temperature oscillates between a high and a low value.
+    CYCLIC_ANNEALING,
+    //! The temperature is lowered while the move acceptance rate is above a target value and raised otherwise.
+    ADAPTIVE_ANNEALING
+};
+
+/**
+ * @brief Temperature schedule for simulated annealing.
+ *
+ * A schedule is created with one of the static factory functions and can be attached to a MonteCarloUpdater with
+ * MonteCarloUpdater::set_annealing_schedule(). The updater then asks the schedule for the temperature at the beginning
+ * of every sweep.
+ *
+ * @tparam Real @RealStub
+ */
+template<floating_point_number Real>
+class AnnealingSchedule
+{
+private:
+    AnnealingScheduleType type_;
+    Real kBT_start_, kBT_end_;
+    unsigned long n_sweeps_;
+    Real target_acceptance_rate_{0}, factor_{1};
+
+    AnnealingSchedule(AnnealingScheduleType type, Real kBT_start, Real kBT_end, unsigned long n_sweeps)
+            :type_(type), kBT_start_(kBT_start), kBT_end_(kBT_end), n_sweeps_(n_sweeps) { }
+
+    [[nodiscard]] Real progress(unsigned long sweep) const
+    {
+        if (n_sweeps_==0) { return 1; }
+        return static_cast<Real>(std::min(sweep, n_sweeps_))/static_cast<Real>(n_sweeps_);
+    }
+
+public:
+    //! Schedule that keeps the temperature at `kBT`.
+    static AnnealingSchedule constant(Real kBT)
+    {
+        return AnnealingSchedule(CONSTANT_KBT, kBT, kBT, 0);
+    }
+
+    //! Greedy quench, i.e. a constant temperature of zero.
+    /**
+     * At zero temperature the updater only accepts moves and flips that do not increase the energy, and it does not
+     * draw any random numbers for the Metropolis test.
+     */
+    static AnnealingSchedule quench()
+    {
+        return constant(0);
+    }
+
+    //! Schedule that changes the temperature linearly from `kBT_start` to `kBT_end` in `n_sweeps` sweeps and stays at `kBT_end` afterwards.
+    static AnnealingSchedule linear(Real kBT_start, Real kBT_end, unsigned long n_sweeps)
+    {
+        return AnnealingSchedule(LINEAR_ANNEALING, kBT_start, kBT_end, n_sweeps);
+    }
+
+    //! Schedule that changes the temperature geometrically from `kBT_start` to `kBT_end` in `n_sweeps` sweeps and stays at `kBT_end` afterwards.
+    /**
+     * Both temperatures must be positive.
+     */
+    static AnnealingSchedule exponential(Real kBT_start, Real kBT_end, unsigned long n_sweeps)
+    {
+        if (!(kBT_start>0) || !(kBT_end>0)) {
+            throw std::invalid_argument("The temperatures of an exponential annealing schedule must be positive.");
+        }
+        return AnnealingSchedule(EXPONENTIAL_ANNEALING, kBT_start, kBT_end, n_sweeps);
+    }
+
+    //! Schedule that oscillates between `kBT_high` and `kBT_low`.
+    /**
+     * The temperature follows a cosine that starts at `kBT_high` and reaches `kBT_low` after half of the period.
+     * @param kBT_high highest temperature of a cycle.
+     * @param kBT_low lowest temperature of a cycle.
+     * @param period number of sweeps in one cycle.
+     */
+    static AnnealingSchedule cyclic(Real kBT_high, Real kBT_low, unsigned long period)
+    {
+        if (period==0) { throw std::invalid_argument("The period of a cyclic annealing schedule must not be zero."); }
+        return AnnealingSchedule(CYCLIC_ANNEALING, kBT_high, kBT_low, period);
+    }
+
+    //! Schedule that adapts the temperature to the move acceptance rate of the previous sweep.
+    /**
+     * If more moves than `target_acceptance_rate` were accepted in the previous sweep, the temperature is multiplied by
+     * `factor`, otherwise it is divided by it. The temperature never leaves the interval `[kBT_min, kBT_start]`.
+     * @param kBT_start temperature of the first sweep, and the highest temperature of the schedule.
+     * @param kBT_min lowest temperature of the schedule.
+     * @param target_acceptance_rate acceptance rate of moves, between 0 and 1, that the schedule aims for.
+     * @param factor cooling factor between 0 and 1.
+     */
+    static AnnealingSchedule adaptive(Real kBT_start, Real kBT_min, Real target_acceptance_rate, Real factor)
+    {
+        if (!(factor>0) || !(factor<1)) {
+            throw std::invalid_argument("The cooling factor of an adaptive annealing schedule must be between 0 and 1.");
+        }
+        AnnealingSchedule schedule(ADAPTIVE_ANNEALING, kBT_start, kBT_min, 0);
+        schedule.target_acceptance_rate_ = target_acceptance_rate;
+        schedule.factor_ = factor;
+        return schedule;
+    }
+
+    //! Temperature of a sweep.
+    /**
+     * @param sweep number of sweeps that were performed before the current one.
+     * @param current_kBT temperature of the previous sweep. Only used by the adaptive schedule.
+     * @param acceptance_rate move acceptance rate of the previous sweep. Only used by the adaptive schedule.
+     * @return Temperature at which the current sweep should be performed.
+     */
+    [[nodiscard]] Real kBT(unsigned long sweep, Real current_kBT, Real acceptance_rate) const
+    {
+        switch (type_) {
+        case LINEAR_ANNEALING:
+            return kBT_start_ + (kBT_end_ - kBT_start_)*progress(sweep);
+        case EXPONENTIAL_ANNEALING:
+            return kBT_start_*std::pow(kBT_end_/kBT_start_, progress(sweep));
+        case CYCLIC_ANNEALING: {
+            Real phase = static_cast<Real>(sweep%n_sweeps_)/static_cast<Real>(n_sweeps_);
+            return kBT_end_ + (kBT_start_ - kBT_end_)*(1 + std::cos(2*std::numbers::pi_v<Real>*phase))/2;
+        }
+        case ADAPTIVE_ANNEALING:
+            if (sweep==0) { return kBT_start_; }
+            if (acceptance_rate>target_acceptance_rate_) { return std::max(kBT_end_, current_kBT*factor_); }
+            return std::min(kBT_start_, current_kBT/factor_);
+        case CONSTANT_KBT:
+        default:
+            return kBT_start_;
+        }
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] AnnealingScheduleType type() const { return type_; }
+};
+
+}
+#endif //FLIPPY_ANNEALINGSCHEDULE_HPP
@@ -0,0 +1,176 @@
+#ifndef FLIPPY_ENSEMBLE_HPP
+#define FLIPPY_ENSEMBLE_HPP
+/**
+ * @file
+ * @brief This file contains the Ensemble class template, which advances many independent copies of the same system
+ * on a thread pool.
+ */
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include "custom_concepts.hpp"
+#include "Triangulation.hpp"
+#include "MonteCarloUpdater.hpp"
+#include "utilities/parallel.hpp"
+
+namespace fp {
+
+/**
+ * @brief Seed sequence of a single replica, derived from a master seed.
+ *
+ * Every stream id gives a different, but reproducible, seed sequence for the same master seed.
+ * @param master_seed seed of the whole ensemble.
+ * @param stream id of the replica, or of any other consumer of random numbers that needs its own stream.
+ * @return A seed sequence that can be used to seed the random number engine of the replica.
+ */
+inline std::seed_seq make_replica_seed_seq(std::uint64_t master_seed, std::size_t stream)
+{
+    return std::seed_seq{static_cast<std::uint32_t>(master_seed), static_cast<std::uint32_t>(master_seed >> 32),
+                         static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(static_cast<std::uint64_t>(stream) >> 32)};
+}
+
+/**
+ * @brief A single member of a replica ensemble.
+ *
+ * A replica owns a triangulation, the random number engine of the replica, and a MonteCarloUpdater that acts on both.
+ * Since the updater stores references to the triangulation and the engine, a replica can not be copied or moved.
+ *
+ * @tparam Real @RealStub
+ * @tparam Index @IndexStub
+ * @tparam EnergyFunctionParameters Same as in MonteCarloUpdater.
+ * @tparam RandomNumberEngine Same as in MonteCarloUpdater. The engine must be constructible from a std::seed_seq.
+ * @tparam triangulation_type One of the types specified by the TriangulationType enum.
+ */
+template<floating_point_number Real, indexing_number Index, typename EnergyFunctionParameters, typename RandomNumberEngine, TriangulationType triangulation_type>
+struct Replica
+{
+    using Updater = MonteCarloUpdater<Real, Index, EnergyFunctionParameters, RandomNumberEngine, triangulation_type>;
+    using EnergyFunction = std::function<Real(fp::Node<Real, Index> const&, fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)>;
+
+    fp::Triangulation<Real, Index, triangulation_type> triangulation;
+    RandomNumberEngine rng;
+    Updater updater;
+
+    /**
+     * @param prototype Triangulation that is copied into the replica.
+     * @param seeds Seed sequence of the random number engine of the replica.
+     * @param prms The instance of the struct that contains the parameters of the system energy.
+     * @param energy_function Energy function of the updater.
+     * @param min_bond_length Same as in MonteCarloUpdater.
+     * @param max_bond_length Same as in MonteCarloUpdater.
+     */
+    Replica(fp::Triangulation<Real, Index, triangulation_type> const& prototype, std::seed_seq& seeds,
+            EnergyFunctionParameters const& prms, EnergyFunction const& energy_function,
+            Real min_bond_length, Real max_bond_length)
+            :triangulation(prototype), rng(seeds),
+             updater(triangulation, prms, energy_function, rng, min_bond_length, max_bond_length) { }
+
+    Replica(Replica const&) = delete;
+    Replica& operator=(Replica const&) = delete;
+};
+
+/**
+ * @brief Runs many independent replicas of the same system in parallel.
+ *
+ * The starting triangulation is built once by the user and copied into every replica, so the triangulation of the
+ * initial mesh, or the parsing of an egg file, only happens once. The energy parameters are shared by all replicas
+ * and are never modified.
+ * The random number engine of each replica is seeded from the master seed and the replica id, see make_replica_seed_seq().
+ * Replicas are handed out to the threads one at a time, so that threads that finish early pick up the remaining replicas.
+ * The state of each replica after a run only depends on the master seed, and not on the number of threads.
+ *
+ * @tparam Real @RealStub
+ * @tparam Index @IndexStub
+ * @tparam EnergyFunctionParameters Same as in MonteCarloUpdater.
+ * @tparam RandomNumberEngine Same as in MonteCarloUpdater. The engine must be constructible from a std::seed_seq.
+ * @tparam triangulation_type One of the types specified by the TriangulationType enum.
+ *
+ * @warning The energy function and the sweep function are called concurrently from several threads, for different
+ * replicas. They must not modify any shared state.
+ */
+template<floating_point_number Real, indexing_number Index, typename EnergyFunctionParameters, typename RandomNumberEngine, TriangulationType triangulation_type>
+class Ensemble
+{
+public:
+    using Replica = fp::Replica<Real, Index, EnergyFunctionParameters, RandomNumberEngine, triangulation_type>;
+    using Updater = typename Replica::Updater;
+    using EnergyFunction = typename Replica::EnergyFunction;
+    using SweepFunction = std::function<void(Replica&)>;
+
+private:
+    std::uint64_t master_seed_;
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    ThreadPool pool_;
+
+public:
+    /**
+     * @param prototype Triangulation that is copied into every replica.
+     * @param n_replicas Number of replicas.
+     * @param prms The instance of the struct that contains the parameters of the system energy. It is shared by all replicas.
+     * @param energy_function Energy function that is used by the updaters of all replicas.
+     * @param min_bond_length Same as in MonteCarloUpdater.
+     * @param max_bond_length Same as in MonteCarloUpdater.
+     * @param master_seed Seed from which the random number engines of all replicas are derived.
+     * @param n_threads Number of threads that the replicas are distributed on. If set to zero, the number of
+     * hardware threads is used. The pool never has more threads than there are replicas.
+     */
+    Ensemble(fp::Triangulation<Real, Index, triangulation_type> const& prototype, std::size_t n_replicas,
+             EnergyFunctionParameters const& prms, EnergyFunction const& energy_function,
+             Real min_bond_length, Real max_bond_length, std::uint64_t master_seed, unsigned n_threads = 0)
+            :master_seed_(master_seed),
+             pool_(static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(
+                     n_threads==0 ? std::thread::hardware_concurrency() : n_threads, n_replicas))))
+    {
+        if (n_replicas==0) { throw std::invalid_argument("An ensemble needs at least one replica."); }
+        replicas_.reserve(n_replicas);
+        for (std::size_t replica_id = 0; replica_id<n_replicas; ++replica_id) {
+            std::seed_seq seeds = make_replica_seed_seq(master_seed_, replica_id);
+            replicas_.push_back(std::make_unique<Replica>(prototype, seeds, prms, energy_function,
+                                                          min_bond_length, max_bond_length));
+        }
+    }
+
+    //! Calls `task` once for every replica, in parallel.
+    /**
+     * @param task callable that receives the replica and its id.
+     */
+    void for_each_replica(std::function<void(Replica&, std::size_t)> const& task)
+    {
+        pool_.parallel_for(replicas_.size(), [&](std::size_t replica_id) { task(*replicas_[replica_id], replica_id); });
+    }
+
+    //! Advances every replica by `n_sweeps` calls of the sweep function.
+    /**
+     * All sweeps of a replica are executed by the same task, so the threads only synchronize once per call.
+     * @param n_sweeps number of sweeps per replica.
+     * @param sweep user-defined function that advances a single replica by one sweep.
+     */
+    void run(unsigned long n_sweeps, SweepFunction const& sweep)
+    {
+        for_each_replica([&](Replica& replica, std::size_t) {
+            for (unsigned long sweep_id = 0; sweep_id<n_sweeps; ++sweep_id) { sweep(replica); }
+        });
+    }
+
+    //! Number of replicas.
+    [[nodiscard]] std::size_t size() const { return replicas_.size(); }
+
+    //! Number of threads that the replicas are distributed on.
+    [[nodiscard]] unsigned n_threads() const { return pool_.size(); }
+
+    //! Seed from which the random number engines of all replicas are derived.
+    [[nodiscard]] std::uint64_t master_seed() const { return master_seed_; }
+
+    //! Access to a replica by its id.
+    Replica& replica(std::size_t replica_id) { return *replicas_.at(replica_id); }
+    //! @copydoc replica(std::size_t)
+    Replica const& replica(std::size_t replica_id) const { return *replicas_.at(replica_id); }
+};
+
+}
+#endif //FLIPPY_ENSEMBLE_HPP
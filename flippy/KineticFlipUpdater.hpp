@@ -0,0 +1,258 @@
+#ifndef FLIPPY_KINETICFLIPUPDATER_HPP
+#define FLIPPY_KINETICFLIPUPDATER_HPP
+/**
+ * @file
+ * @brief This file contains the KineticFlipUpdater class template, a rejection-free (n-fold way) alternative to the
+ * bond flips of the MonteCarloUpdater.
+ */
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include "custom_concepts.hpp"
+#include "Triangulation.hpp"
+#include "utilities/fenwick_tree.hpp"
+
+namespace fp {
+
+/**
+ * @brief Rejection-free bond flips with the n-fold way (BKL) algorithm.
+ *
+ * The updater keeps the Metropolis rate \f$\min\left(1, e^{-\Delta E/k_BT}\right)\f$ of every bond of the
+ * triangulation in a FenwickTree. Bonds that can not be flipped, because of the topology or the bond length
+ * constraints, have the rate zero. Every call of kinetic_flip() draws a bond with a probability proportional to its
+ * rate and flips it, so no step is wasted on rejections. The simulation time advances by an exponentially distributed
+ * amount with the mean \f$1/R\f$, where \f$R\f$ is the total rate.
+ *
+ * After a flip, only the geometry of the four nodes of the flipped diamond changes. Hence, only the rates of the bonds
+ * that have one of those nodes as an end or as a tip of their diamond are re-evaluated.
+ * This is exact for energies that are sums of local terms, or linear combinations of the global area, volume and bending energy.
+ * Energies that depend non-linearly on global quantities (like a volume constraint) slightly change the energy
+ * difference of every bond after each flip. For those, the rates of distant bonds are only approximate, and
+ * refresh_flip_rates() should be called regularly, e.g. after every node move sweep.
+ *
+ * The rates are evaluated by flipping the bond, evaluating the energy, and flipping it back. Node moves that are
+ * performed by other updaters change the rates as well, and refresh_flip_rates() needs to be called after them.
+ * Changes of the connectivity by others are detected by kinetic_flip() through Triangulation::connectivity_version():
+ * after Triangulation::reorder_nodes, the bonds are renumbered and keep their rates, and after bond flips of
+ * other updaters, all rates are refreshed.
+ *
+ * @tparam Real @RealStub
+ * @tparam Index @IndexStub
+ * @tparam EnergyFunctionParameters Same as in MonteCarloUpdater.
+ * @tparam RandomNumberEngine Same as in MonteCarloUpdater.
+ * @tparam triangulation_type One of the types specified by the TriangulationType enum.
+ */
+template<floating_point_number Real, indexing_number Index, typename EnergyFunctionParameters, typename RandomNumberEngine, TriangulationType triangulation_type>
+class KineticFlipUpdater
+{
+public:
+    using EnergyFunction = std::function<Real(fp::Node<Real, Index> const&, fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)>;
+
+private:
+    fp::Triangulation<Real, Index, triangulation_type>& triangulation;
+    EnergyFunctionParameters const& prms;
+    EnergyFunction energy_function;
+    RandomNumberEngine& rng;
+    std::uniform_real_distribution<Real> unif_distr_on_01{0, 1};
+    Real kBT_{1};
+    Real min_bond_length_square, max_bond_length_square;
+    std::vector<std::pair<Index, Index>> bonds_{};
+    std::unordered_map<std::uint64_t, std::size_t> bond_slots_{};
+    FenwickTree<Real> rates_{};
+    std::vector<std::size_t> affected_slots_{};
+    Real time_{0};
+    unsigned long flip_count_{0}, rate_evaluation_count_{0};
+    //! Connectivity version of the triangulation after the last change of the bonds by this updater.
+    unsigned long connectivity_version_{0};
+    //! Original ids of the nodes that the bonds are stored with, see Triangulation::original_node_ids().
+    std::vector<Index> original_ids_{};
+
+    [[nodiscard]] std::uint64_t bond_key(Index node_id, Index nn_id) const
+    {
+        auto const [low, high] = std::minmax(node_id, nn_id);
+        return static_cast<std::uint64_t>(low)*static_cast<std::uint64_t>(triangulation.size()) + static_cast<std::uint64_t>(high);
+    }
+
+    [[nodiscard]] Real metropolis_rate(Real e_diff) const
+    {
+        if (e_diff<=0) { return 1; }
+        if (kBT_>0) { return std::exp(-e_diff/kBT_); }
+        return 0;
+    }
+
+    //! Rate of the bond in a slot, evaluated by flipping the bond and flipping it back.
+    Real evaluate_rate(std::size_t slot)
+    {
+        ++rate_evaluation_count_;
+        auto const [node_id, nn_id] = bonds_[slot];
+        Real const e_old = energy_function(triangulation[node_id], triangulation, prms);
+        auto const bfd = triangulation.flip_bond(node_id, nn_id, min_bond_length_square, max_bond_length_square);
+        if (!bfd.flipped) { return 0; }
+        Real const e_new = energy_function(triangulation[node_id], triangulation, prms);
+        triangulation.unflip_bond(node_id, nn_id, bfd);
+        return metropolis_rate(e_new - e_old);
+    }
+
+    //! Collects the slots of all bonds that end on the node or connect two of its consecutive neighbors.
+    void collect_affected_slots(Index node_id)
+    {
+        auto const& nn_ids = triangulation[node_id].nn_ids;
+        for (std::size_t i = 0; i<nn_ids.size(); ++i) {
+            affected_slots_.push_back(bond_slots_.at(bond_key(node_id, nn_ids[i])));
+            auto const link = bond_slots_.find(bond_key(nn_ids[i], nn_ids[(i + 1)%nn_ids.size()]));
+            if (link!=bond_slots_.end()) { affected_slots_.push_back(link->second); }
+        }
+    }
+
+    //! Renumbers the bonds after Triangulation::reorder_nodes, or refreshes all rates if the bonds changed otherwise.
+    void adopt_external_connectivity_changes()
+    {
+        std::vector<Index> original_ids = triangulation.original_node_ids();
+        if (original_ids!=original_ids_) {
+            std::vector<Index> new_ids(original_ids.size());
+            for (std::size_t node_id = 0; node_id<original_ids.size(); ++node_id) { new_ids[original_ids[node_id]] = static_cast<Index>(node_id); }
+            bond_slots_.clear();
+            for (std::size_t slot = 0; slot<bonds_.size(); ++slot) {
+                bonds_[slot] = std::minmax(new_ids[original_ids_[bonds_[slot].first]], new_ids[original_ids_[bonds_[slot].second]]);
+                bond_slots_[bond_key(bonds_[slot].first, bonds_[slot].second)] = slot;
+            }
+            original_ids_ = std::move(original_ids);
+        }
+        auto is_bond = [this](std::pair<Index, Index> const& bond) {
+            auto const& nn_ids = triangulation[bond.first].nn_ids;
+            return std::find(nn_ids.begin(), nn_ids.end(), bond.second)!=nn_ids.end();
+        };
+        if (std::all_of(bonds_.begin(), bonds_.end(), is_bond)) { connectivity_version_ = triangulation.connectivity_version(); }
+        else { refresh_flip_rates(); }
+    }
+
+public:
+    /**
+     * @param triangulation_inp Reference to the triangulation that will be updated.
+     * @param prms_inp The instance of the struct that contains the parameters of the system energy.
+     * @param energy_function_inp Same as in MonteCarloUpdater.
+     * @param rng_inp Reference to a random number engine.
+     * @param min_bond_length Same as in MonteCarloUpdater.
+     * @param max_bond_length Same as in MonteCarloUpdater.
+     */
+    KineticFlipUpdater(fp::Triangulation<Real, Index, triangulation_type>& triangulation_inp,
+                       EnergyFunctionParameters const& prms_inp, EnergyFunction energy_function_inp,
+                       RandomNumberEngine& rng_inp, Real min_bond_length, Real max_bond_length)
+            :triangulation(triangulation_inp), prms(prms_inp), energy_function(std::move(energy_function_inp)), rng(rng_inp),
+             min_bond_length_square(min_bond_length*min_bond_length), max_bond_length_square(max_bond_length*max_bond_length)
+    {
+        refresh_flip_rates();
+    }
+
+    //! Re-create the list of bonds and re-evaluate all flip rates.
+    /**
+     * This is necessary after nodes were moved, after the temperature was changed, and regularly for energies that
+     * depend non-linearly on global quantities. It also removes the rounding errors of the incremental rate updates.
+     */
+    void refresh_flip_rates()
+    {
+        bonds_.clear();
+        bond_slots_.clear();
+        for (auto const& node: triangulation.nodes()) {
+            for (Index nn_id: node.nn_ids) {
+                if (node.id<nn_id) {
+                    bond_slots_[bond_key(node.id, nn_id)] = bonds_.size();
+                    bonds_.emplace_back(node.id, nn_id);
+                }
+            }
+        }
+        std::vector<Real> rates(bonds_.size());
+        for (std::size_t slot = 0; slot<bonds_.size(); ++slot) { rates[slot] = evaluate_rate(slot); }
+        rates_.assign(rates);
+        original_ids_ = triangulation.original_node_ids();
+        connectivity_version_ = triangulation.connectivity_version();
+    }
+
+    //! Flip a bond that is drawn with a probability proportional to its rate.
+    /**
+     * The simulation time is advanced by \f$-\ln(u)/R\f$, where \f$u\f$ is uniform in `(0,1]` and \f$R\f$ is the total rate.
+     * @return `false` if no bond can be flipped, i.e. if the total rate is zero. `true` otherwise.
+     */
+    bool kinetic_flip()
+    {
+        if (connectivity_version_!=triangulation.connectivity_version()) { adopt_external_connectivity_changes(); }
+        Real const total_rate = rates_.total();
+        if (!(total_rate>0)) { return false; }
+        std::size_t const slot = rates_.find(unif_distr_on_01(rng)*total_rate);
+        time_ -= std::log(1 - unif_distr_on_01(rng))/total_rate;
+
+        auto const [node_id, nn_id] = bonds_[slot];
+        auto const bfd = triangulation.flip_bond(node_id, nn_id, min_bond_length_square, max_bond_length_square);
+        if (!bfd.flipped) {
+            rates_.set(slot, 0);
+            connectivity_version_ = triangulation.connectivity_version();
+            return true;
+        }
+        ++flip_count_;
+        bond_slots_.erase(bond_key(node_id, nn_id));
+        bonds_[slot] = std::minmax(bfd.common_nn_0, bfd.common_nn_1);
+        bond_slots_[bond_key(bfd.common_nn_0, bfd.common_nn_1)] = slot;
+
+        affected_slots_.clear();
+        for (Index diamond_node_id: {node_id, nn_id, bfd.common_nn_0, bfd.common_nn_1}) { collect_affected_slots(diamond_node_id); }
+        std::sort(affected_slots_.begin(), affected_slots_.end());
+        affected_slots_.erase(std::unique(affected_slots_.begin(), affected_slots_.end()), affected_slots_.end());
+        for (std::size_t affected_slot: affected_slots_) { rates_.set(affected_slot, evaluate_rate(affected_slot)); }
+        connectivity_version_ = triangulation.connectivity_version();
+        return true;
+    }
+
+    //! Perform `n_flips` calls of kinetic_flip().
+    /**
+     * @return Number of flips that were performed. It is smaller than `n_flips` only if the total rate dropped to zero.
+     */
+    unsigned long kinetic_flips(unsigned long n_flips)
+    {
+        unsigned long performed = 0;
+        for (; performed<n_flips && kinetic_flip(); ++performed) { }
+        return performed;
+    }
+
+    //! Reset the temperature and re-evaluate all flip rates.
+    void reset_kBT(Real kBT)
+    {
+        kBT_ = kBT;
+        refresh_flip_rates();
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] Real kBT() const { return kBT_; }
+
+    //! Sum of the flip rates of all bonds.
+    [[nodiscard]] Real total_flip_rate() const { return rates_.total(); }
+
+    //! Flip rate of the bond between two neighboring nodes.
+    [[nodiscard]] Real flip_rate(Index node_id, Index nn_id) const { return rates_.weight(bond_slots_.at(bond_key(node_id, nn_id))); }
+
+    //! Number of bonds of the triangulation.
+    [[nodiscard]] std::size_t bond_count() const { return bonds_.size(); }
+
+    //! @getterFunctionStub
+    /**
+     * @return Simulation time of the n-fold way dynamics, in units of the inverse attempt frequency of a single bond.
+     */
+    [[nodiscard]] Real kinetic_time() const { return time_; }
+
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long flip_count() const { return flip_count_; }
+
+    //! @getterFunctionStub
+    /**
+     * @return Number of trial flips that were performed to evaluate the rates.
+     */
+    [[nodiscard]] unsigned long rate_evaluation_count() const { return rate_evaluation_count_; }
+};
+
+}
+#endif //FLIPPY_KINETICFLIPUPDATER_HPP
@@ -0,0 +1,361 @@
+#ifndef FLIPPY_MINIMIZER_HPP
+#define FLIPPY_MINIMIZER_HPP
+/**
+ * @file
+ * @brief This file contains the Minimizer class template, which relaxes a triangulation into a nearby energy minimum
+ * with the FIRE algorithm, interleaved with greedy bond flips.
+ */
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include "custom_concepts.hpp"
+#include "vec3.hpp"
+#include "Triangulation.hpp"
+#include "MonteCarloUpdater.hpp"
+
+namespace fp {
+
+//! Parameters of the FIRE algorithm.
+/**
+ * The default values are the ones that are recommended in the original publication of the algorithm.
+ * @tparam Real @RealStub
+ * @see Minimizer
+ */
+template<floating_point_number Real>
+struct FireParameters
+{
+  Real max_time_step_factor = 10; //!< The time step never grows beyond this multiple of the initial time step.
+  Real time_step_increase = 1.1; //!< Factor by which the time step grows while the system moves downhill.
+  Real time_step_decrease = 0.5; //!< Factor by which the time step shrinks when the system moves uphill.
+  Real alpha_start = 0.1; //!< Initial mixing between the velocity and the force direction.
+  Real alpha_decrease = 0.99; //!< Factor by which the mixing decreases while the system moves downhill.
+  unsigned long min_steps_before_increase = 5; //!< Number of downhill steps before the time step starts to grow.
+};
+
+//! Outcome of Minimizer::minimize().
+template<floating_point_number Real>
+struct MinimizationResult
+{
+  unsigned long steps = 0; //!< Number of FIRE steps that were performed.
+  Real max_force = 0; //!< Largest force on a single node in the final configuration.
+  bool converged = false; //!< `true` if the largest force dropped below the requested tolerance.
+};
+
+/**
+ * @brief Deterministic energy minimizer for triangulations.
+ *
+ * The node positions are relaxed with the [FIRE](https://doi.org/10.1103/PhysRevLett.97.170201) algorithm (fast
+ * inertial relaxation engine), which is a damped molecular dynamics that only needs forces.
+ * The forces are calculated with Triangulation::energy_gradient from the derivatives of the energy with respect to
+ * the global geometry. Every few steps, a greedy bond flip is attempted on every bond of the triangulation.
+ *
+ * The minimizer works on top of a MonteCarloUpdater, which provides the bond length and overlap constraints and the
+ * bond flips. Force and velocity components that would push a node further into a bond length limit are removed, so
+ * that the nodes slide along the limits. A node move that would still violate the constraints is not performed, and the
+ * velocity of that node is set to zero. All nodes of a step are moved at once, with Triangulation::move_nodes. Hence, the largest force that is used as the convergence criterion is the largest
+ * force that is not balanced by the constraints.
+ * The flips are performed with flip_MC_updater() at zero temperature and show up in the flip counters of the updater.
+ * The boundary nodes of a planar triangulation do not move.
+ * The nodes can be renumbered with Triangulation::reorder_nodes between the steps, the velocities of the nodes are
+ * carried over to their new ids.
+ *
+ * A typical use case is the pre-equilibration of a simulation, e.g. relaxing a squeezed sphere towards a biconcave
+ * shape before the Monte Carlo sampling starts.
+ *
+ * @tparam Real @RealStub
+ * @tparam Index @IndexStub
+ * @tparam EnergyFunctionParameters Same as in MonteCarloUpdater.
+ * @tparam RandomNumberEngine Same as in MonteCarloUpdater.
+ * @tparam triangulation_type One of the types specified by the TriangulationType enum.
+ */
+template<floating_point_number Real, indexing_number Index, typename EnergyFunctionParameters, typename RandomNumberEngine, TriangulationType triangulation_type>
+class Minimizer
+{
+public:
+    //! Relative distance from a bond length limit below which a bond counts as being at the limit.
+    static constexpr Real contact_tolerance = Real(0.01);
+    //! Number of repetitions of the contact projections, see project_out_blocked_directions().
+    static constexpr int n_projection_sweeps = 3;
+    //! A node move that violates the constraints is halved up to this many times before it is given up.
+    static constexpr int max_displacement_halvings = 4;
+    using Updater = MonteCarloUpdater<Real, Index, EnergyFunctionParameters, RandomNumberEngine, triangulation_type>;
+    using EnergyDerivativeFunction = std::function<fp::Geometry<Real, Index>(fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)>;
+
+private:
+    fp::Triangulation<Real, Index, triangulation_type>& triangulation;
+    Updater& updater;
+    EnergyFunctionParameters const& prms;
+    EnergyDerivativeFunction energy_derivative_function;
+    FireParameters<Real> fire_prms;
+    Real initial_time_step, time_step_, alpha_;
+    Real min_contact_square, max_contact_square;
+    unsigned long downhill_steps_{0}, step_count_{0}, blocked_move_count_{0};
+    std::vector<vec3<Real>> velocities_{}, forces_{}, displacements_{};
+    std::vector<Index> node_ids_{};
+    std::vector<bool> is_fixed_{};
+    //! Original ids of the nodes that the state vectors are indexed by, see Triangulation::original_node_ids().
+    std::vector<Index> state_original_ids_{};
+    unsigned long state_connectivity_version_{0};
+
+    void mark_fixed_nodes()
+    {
+        is_fixed_.assign(triangulation.size(), false);
+        if constexpr (triangulation_type==EXPERIMENTAL_PLANAR_TRIANGULATION) {
+            for (Index node_id: triangulation.boundary_nodes_ids_set()) { is_fixed_[node_id] = true; }
+        }
+    }
+
+    //! Sizes the per node state to the triangulation, and carries the velocities over a Triangulation::reorder_nodes call.
+    /**
+     * A reordering changes the connectivity version of the triangulation, so the original ids are only compared after
+     * the connectivity changed, which mostly happens by flips.
+     */
+    void resize_state()
+    {
+        if (velocities_.size()==triangulation.size()) {
+            if (state_connectivity_version_==triangulation.connectivity_version()) { return; }
+            state_connectivity_version_ = triangulation.connectivity_version();
+            std::vector<Index> original_ids = triangulation.original_node_ids();
+            if (original_ids==state_original_ids_) { return; }
+            std::vector<vec3<Real>> original_velocities(velocities_.size());
+            for (std::size_t i = 0; i<velocities_.size(); ++i) { original_velocities[state_original_ids_[i]] = velocities_[i]; }
+            for (std::size_t i = 0; i<velocities_.size(); ++i) { velocities_[i] = original_velocities[original_ids[i]]; }
+            state_original_ids_ = std::move(original_ids);
+            mark_fixed_nodes();
+            return;
+        }
+        velocities_.assign(triangulation.size(), vec3<Real>{0, 0, 0});
+        forces_.assign(triangulation.size(), vec3<Real>{0, 0, 0});
+        displacements_.assign(triangulation.size(), vec3<Real>{0, 0, 0});
+        node_ids_.resize(triangulation.size());
+        std::iota(node_ids_.begin(), node_ids_.end(), Index(0));
+        mark_fixed_nodes();
+        state_original_ids_ = triangulation.original_node_ids();
+        state_connectivity_version_ = triangulation.connectivity_version();
+    }
+
+    //! Removes the component of `v` along `distance` if it would push the node further into a length limit.
+    static void project_out_contact(vec3<Real>& v, vec3<Real> const& distance, Real min_contact_square, Real max_contact_square)
+    {
+        Real const distance_square = distance.norm_square();
+        Real const towards_other = v.dot(distance);
+        bool const at_min = (distance_square<min_contact_square) && (towards_other>0);
+        bool const at_max = (distance_square>max_contact_square) && (towards_other<0);
+        if (at_min || at_max) { v -= (towards_other/distance_square)*distance; }
+    }
+
+    //! Removes the components of `v` that would push a node further into one of its length limits.
+    /**
+     * A bond counts as being at a limit if its length is within #contact_tolerance of that limit, and a Verlet neighbor
+     * counts as being in contact if it is closer than the minimal bond length plus that tolerance.
+     * Since a node can be in contact with several neighbors, the projections are repeated a few times.
+     * Without this projection, nodes that are pressed against a limit block all of their moves, and the minimization stalls.
+     */
+    void project_out_blocked_directions(Index node_id, vec3<Real>& v) const
+    {
+        auto const& node = triangulation[node_id];
+        for (int sweep = 0; sweep<n_projection_sweeps; ++sweep) {
+            for (auto const& nn_distance: node.nn_distances) {
+                project_out_contact(v, nn_distance, min_contact_square, max_contact_square);
+            }
+            auto project_out_verlet_contacts = [&](auto const& verlet_neighbour_ids) {
+                for (auto const& verlet_neighbour_id: verlet_neighbour_ids) {
+                    project_out_contact(v, triangulation[static_cast<Index>(verlet_neighbour_id)].pos - node.pos,
+                                        min_contact_square, std::numeric_limits<Real>::max());
+                }
+            };
+            if (triangulation.uses_compact_verlet_list()) { project_out_verlet_contacts(triangulation.compact_verlet_list()[node_id]); }
+            else { project_out_verlet_contacts(node.verlet_list); }
+        }
+    }
+
+    //! Calculates the forces on all nodes and returns the largest force.
+    Real update_forces()
+    {
+        fp::Geometry<Real, Index> const energy_derivatives = energy_derivative_function(triangulation, prms);
+        Real max_force_square = 0;
+        for (Index node_id = 0; node_id<static_cast<Index>(triangulation.size()); ++node_id) {
+            if (is_fixed_[node_id]) { continue; }
+            vec3<Real> const gradient = triangulation.energy_gradient(node_id, energy_derivatives);
+            forces_[node_id] = -gradient;
+            project_out_blocked_directions(node_id, forces_[node_id]);
+            max_force_square = std::max(max_force_square, forces_[node_id].norm_square());
+        }
+        return std::sqrt(max_force_square);
+    }
+
+    //! Drops the move of a node in the current step and stops the node.
+    void block_move(Index node_id)
+    {
+        displacements_[node_id] = {0, 0, 0};
+        velocities_[node_id] = {0, 0, 0};
+        ++blocked_move_count_;
+    }
+
+    //! One FIRE update of the velocities and positions, with the forces from the last call of update_forces().
+    void fire_update()
+    {
+        Index const n_nodes = static_cast<Index>(triangulation.size());
+        Real power = 0, velocity_norm_square = 0, force_norm_square = 0;
+        for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+            if (is_fixed_[node_id]) { continue; }
+            power += forces_[node_id].dot(velocities_[node_id]);
+            velocity_norm_square += velocities_[node_id].norm_square();
+            force_norm_square += forces_[node_id].norm_square();
+        }
+
+        if (power>0) {
+            Real const mixing = force_norm_square>0 ? alpha_*std::sqrt(velocity_norm_square/force_norm_square) : Real(0);
+            for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+                velocities_[node_id] = (1 - alpha_)*velocities_[node_id] + mixing*forces_[node_id];
+            }
+            if (++downhill_steps_>fire_prms.min_steps_before_increase) {
+                time_step_ = std::min(time_step_*fire_prms.time_step_increase, fire_prms.max_time_step_factor*initial_time_step);
+                alpha_ *= fire_prms.alpha_decrease;
+            }
+        }
+        else {
+            std::fill(velocities_.begin(), velocities_.end(), vec3<Real>{0, 0, 0});
+            time_step_ *= fire_prms.time_step_decrease;
+            alpha_ = fire_prms.alpha_start;
+            downhill_steps_ = 0;
+        }
+
+        for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+            displacements_[node_id] = {0, 0, 0};
+            if (is_fixed_[node_id]) { continue; }
+            velocities_[node_id] += time_step_*forces_[node_id];
+            project_out_blocked_directions(node_id, velocities_[node_id]);
+            vec3<Real> displacement = time_step_*velocities_[node_id];
+            int halvings = 0;
+            while (!updater.new_neighbour_distances_are_between_min_and_max_length(triangulation[node_id], displacement)
+                   && halvings<max_displacement_halvings) {
+                displacement.scale(Real(0.5));
+                ++halvings;
+            }
+            if (halvings<max_displacement_halvings) { displacements_[node_id] = displacement; }
+            else { block_move(node_id); }
+        }
+        // Every remaining displacement is allowed if the neighbors stand still. Blocking a node whose pairs fail with the
+        // displacements of the neighbors included can therefore not invalidate a pair that was already checked.
+        for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+            if (displacements_[node_id].norm_square()>0
+                && !updater.new_neighbour_distances_are_between_min_and_max_length(triangulation[node_id], displacements_)) {
+                block_move(node_id);
+            }
+        }
+        triangulation.move_nodes(node_ids_, displacements_);
+        ++step_count_;
+    }
+
+public:
+    /**
+     * @param triangulation_inp Reference to the triangulation that will be relaxed. This must be the triangulation of the updater.
+     * @param updater_inp Updater that provides the bond length constraints and the bond flips.
+     * @param prms_inp The instance of the struct that contains the parameters of the system energy.
+     * @param energy_derivative_function_inp A c++ function that returns the partial derivatives of the system energy
+     * with respect to the global area, volume and unit bending energy, see MonteCarloUpdater::set_energy_derivative_function().
+     * @param time_step initial time step of the FIRE dynamics, in units of length per square root of energy.
+     * @param fire_prms_inp parameters of the FIRE algorithm.
+     */
+    Minimizer(fp::Triangulation<Real, Index, triangulation_type>& triangulation_inp, Updater& updater_inp,
+              EnergyFunctionParameters const& prms_inp, EnergyDerivativeFunction energy_derivative_function_inp,
+              Real time_step, FireParameters<Real> const& fire_prms_inp = {})
+            :triangulation(triangulation_inp), updater(updater_inp), prms(prms_inp),
+             energy_derivative_function(std::move(energy_derivative_function_inp)), fire_prms(fire_prms_inp),
+             initial_time_step(time_step), time_step_(time_step), alpha_(fire_prms_inp.alpha_start),
+             min_contact_square(updater_inp.min_bond_length()*updater_inp.min_bond_length()*(1 + contact_tolerance)*(1 + contact_tolerance)),
+             max_contact_square(updater_inp.max_bond_length()*updater_inp.max_bond_length()*(1 - contact_tolerance)*(1 - contact_tolerance)) { }
+
+    //! Perform a single FIRE step.
+    /**
+     * @return The largest force on a single node before the step.
+     */
+    Real fire_step()
+    {
+        resize_state();
+        Real const max_force = update_forces();
+        fire_update();
+        return max_force;
+    }
+
+    //! Attempt a greedy flip of every bond of the triangulation.
+    /**
+     * Every bond is visited once, in the order of the node ids, and a flip is kept if it does not increase the energy.
+     * @return Number of accepted flips.
+     */
+    unsigned long greedy_flip_pass()
+    {
+        Real const kBT = updater.kBT();
+        updater.reset_kBT(0);
+        unsigned long const accepted_before = updater.flip_attempt_count() - updater.flip_back_count() - updater.bond_length_flip_rejection_count();
+        std::vector<Index> nn_ids;
+        for (Index node_id = 0; node_id<static_cast<Index>(triangulation.size()); ++node_id) {
+            nn_ids = triangulation[node_id].nn_ids;
+            for (Index nn_id: nn_ids) {
+                auto const& current_nn_ids = triangulation[node_id].nn_ids;
+                if (nn_id<node_id || std::find(current_nn_ids.begin(), current_nn_ids.end(), nn_id)==current_nn_ids.end()) { continue; }
+                updater.flip_MC_updater(triangulation[node_id], nn_id);
+            }
+        }
+        updater.reset_kBT(kBT);
+        return updater.flip_attempt_count() - updater.flip_back_count() - updater.bond_length_flip_rejection_count() - accepted_before;
+    }
+
+    //! Relax the triangulation until the largest force on a node drops below `force_tolerance`.
+    /**
+     * @param force_tolerance the minimization stops when no node feels a larger force.
+     * @param max_steps the minimization stops after this many FIRE steps, even if it did not converge.
+     * @param flip_interval number of FIRE steps between two calls of greedy_flip_pass(). If set to zero, no bonds are flipped.
+     * @return Number of steps, the largest remaining force, and whether the minimization converged.
+     */
+    MinimizationResult<Real> minimize(Real force_tolerance, unsigned long max_steps, unsigned long flip_interval = 10)
+    {
+        resize_state();
+        MinimizationResult<Real> result;
+        for (; result.steps<max_steps; ++result.steps) {
+            if ((flip_interval>0) && (result.steps%flip_interval==0)) { greedy_flip_pass(); }
+            result.max_force = update_forces();
+            if (result.max_force<force_tolerance) {
+                result.converged = true;
+                return result;
+            }
+            fire_update();
+        }
+        result.max_force = update_forces();
+        result.converged = result.max_force<force_tolerance;
+        return result;
+    }
+
+    //! Restart the FIRE dynamics from rest, with the initial time step.
+    void reset()
+    {
+        velocities_.clear();
+        resize_state();
+        time_step_ = initial_time_step;
+        alpha_ = fire_prms.alpha_start;
+        downhill_steps_ = 0;
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] Real time_step() const { return time_step_; }
+
+    //! @getterFunctionStub
+    /**
+     * @return Number of FIRE steps that were performed so far.
+     */
+    [[nodiscard]] unsigned long step_count() const { return step_count_; }
+
+    //! @getterFunctionStub
+    /**
+     * @return Number of node moves that were not performed, because they would have violated the bond length constraints.
+     */
+    [[nodiscard]] unsigned long blocked_move_count() const { return blocked_move_count_; }
+};
+
+}
+#endif //FLIPPY_MINIMIZER_HPP
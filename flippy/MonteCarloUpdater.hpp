@@ -8,11 +8,87 @@
 
 #include "custom_concepts.hpp"
 #include <random>
+#include <vector>
+#include <numeric>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <span>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include "Nodes.hpp"
 #include "Triangulation.hpp"
+#include "AnnealingSchedule.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/profiler.hpp"
+#include "utilities/random_engines.hpp"
 
 namespace fp {
 
+//! This enum defines the classes of nodes that can have different displacement amplitudes in MonteCarloUpdater::sweep().
+/**
+ * @see MonteCarloUpdater::reset_linear_displacement(Real, DisplacementClass)
+ */
+enum DisplacementClass{
+    //! Nodes that are not on the boundary of the triangulation. For triangulations without a boundary, these are all nodes.
+    BULK_NODE_DISPLACEMENT,
+    //! Nodes on the boundary of a triangulation that has a boundary.
+    BOUNDARY_NODE_DISPLACEMENT
+};
+
+//! This enum defines how MonteCarloUpdater::parallel_sweep() decides on the moves that it evaluates in parallel.
+/**
+ * @see MonteCarloUpdater::parallel_sweep(ThreadPool&, ParallelSweepMode)
+ */
+enum ParallelSweepMode{
+    //! The moves of a color are accepted one after the other in the order of the node ids, as in a serial sweep, and all
+    //! random numbers are keyed by the sweep and the node id. The result is bitwise identical for any number of threads.
+    DETERMINISTIC_PARALLEL_SWEEP,
+    //! The moves are accepted as in the deterministic mode, but the random numbers are drawn from one stream per thread
+    //! instead of one stream per node. The sampled distribution is the same, but the result depends on the number of
+    //! threads and on their scheduling.
+    FAST_PARALLEL_SWEEP
+};
+
+//! This enum defines when a term of a staged energy is evaluated during a node move.
+/**
+ * @see MonteCarloUpdater::add_staged_energy_term(StagedEnergyTerm<Real, Index, EnergyFunctionParameters>)
+ */
+enum EnergyStage{
+    //! The term only depends on the global area, whose change is cheap to calculate from the triangles around the moved node.
+    AREA_ENERGY_STAGE,
+    //! The term depends on the global volume or unit bending energy, whose changes require the geometry of the whole two-ring.
+    GEOMETRY_ENERGY_STAGE
+};
+
+//! A term of the staged energy of a MonteCarloUpdater.
+/**
+ * @tparam Real @RealStub
+ * @tparam Index @IndexStub
+ * @tparam EnergyFunctionParameters Same as in MonteCarloUpdater.
+ * @see MonteCarloUpdater::add_staged_energy_term(StagedEnergyTerm<Real, Index, EnergyFunctionParameters>)
+ */
+template<floating_point_number Real, indexing_number Index, typename EnergyFunctionParameters>
+struct StagedEnergyTerm
+{
+    //! The energy of the term as a function of the global geometry.
+    std::function<Real(Geometry<Real, Index> const&, EnergyFunctionParameters const&)> energy;
+    //! The stage in which the term is evaluated.
+    EnergyStage stage{GEOMETRY_ENERGY_STAGE};
+    //! Lower bound of the change of the term by a node move, which is only used for terms of the GEOMETRY_ENERGY_STAGE.
+    /**
+     * The arguments are the global geometry and the geometry of the two-ring of the moved node before the move, and the
+     * displacement of the node. E.g., a bending energy \f$\kappa E_b\f$ can not decrease by more than \f$\kappa\f$
+     * times the unit bending energy of the two-ring, since the bending energies of the nodes are not negative, and the
+     * volume changes by at most \f$|\vec{d}|/3\f$ times the area of the two-ring. Without a lower bound, moves are never
+     * rejected before this term is evaluated.
+     */
+    std::function<Real(Geometry<Real, Index> const&, Geometry<Real, Index> const&, vec3<Real> const&, EnergyFunctionParameters const&)> min_delta{};
+};
+
 /**
  * @brief A helper class for updating the triangulation, using
  * [Metropolis–Hastings algorithm](https://en.wikipedia.org/wiki/Metropolis%E2%80%93Hastings_algorithm).
@@ -32,19 +108,561 @@ template<floating_point_number Real, indexing_number Index, typename EnergyFunct
 class MonteCarloUpdater
 {
 private:
+    //! A node move of parallel_sweep(), which is evaluated before it is accepted or rejected.
+    struct MoveProposal{
+        vec3<Real> displacement{0, 0, 0};
+        Geometry<Real, Index> geometry_change{};
+        Real acceptance_uniform{0};
+        bool allowed{false}, accepted{false}, deferred{false};
+    };
+
+    //! Counters at the beginning of a sweep, from which the acceptance rates of the sweep are calculated.
+    struct SweepStatistics{
+        unsigned long move_attempts, accepted_moves, flip_attempts, accepted_flips;
+        std::array<unsigned long, 2> class_attempts{0, 0}, class_accepted{0, 0};
+    };
+
+    //! Phases of parallel_sweep(), which draw from independent streams of counter-based random numbers.
+    enum ParallelSweepStream : std::uint32_t{MOVE_STREAM, FLIP_ORDER_STREAM, FLIP_STREAM, THREAD_STREAM};
+
     static constexpr Real max_float = 3.40282347e+38;
     Real e_old{}, e_new{}, e_diff{};
     fp::Triangulation<Real, Index, triangulation_type>& triangulation;
     EnergyFunctionParameters const& prms;
     std::function<Real(fp::Node<Real, Index> const&, fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> energy_function;
+    //! Engine that is owned by the updater, if it was moved into the constructor. Copies of the updater share it.
+    std::shared_ptr<RandomNumberEngine> owned_rng_{};
     RandomNumberEngine& rng;
     std::uniform_real_distribution<Real> unif_distr_on_01;
+    std::normal_distribution<Real> std_normal_distr{0, 1};
+    std::function<fp::Geometry<Real, Index>(fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> energy_derivative_function{};
+    std::function<Real(fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> total_energy_function{};
+    std::function<Real(fp::Geometry<Real, Index> const&, EnergyFunctionParameters const&)> geometry_energy_function{};
+    std::vector<StagedEnergyTerm<Real, Index, EnergyFunctionParameters>> staged_energy_terms_{};
+    unsigned long staged_early_rejection{0};
+    //! Number of candidate displacements of the moves of sweep(), see set_multiple_try_count().
+    unsigned multiple_tries_{1};
+    std::vector<vec3<Real>> try_displacements_{};
+    std::vector<Real> try_log_weights_{}, reference_log_weights_{};
     Real kBT_{1};
+    //! Uniform random numbers that were drawn in advance and their approximate logarithms, see set_log_uniform_batch_size().
+    std::vector<Real> batch_uniforms_{};
+    std::vector<double> batch_log_uniforms_{};
+    std::size_t next_batch_uniform_{0};
+    //! Logarithm of the uniform random number of the next Metropolis decision, if metropolis_threshold() drew it already.
+    std::optional<Real> drawn_log_uniform_{};
     Real min_bond_length_square{0.}, max_bond_length_square{max_float};
     unsigned long move_attempt{0}, bond_length_move_rejection{0},move_back{0};
     unsigned long flip_attempt{0}, bond_length_flip_rejection{0}, flip_back{0};
+    unsigned long trajectory_attempt{0}, bond_length_trajectory_rejection{0}, trajectory_back{0};
+    unsigned long collective_move_attempt{0}, bond_length_collective_move_rejection{0}, collective_move_back{0};
+    std::vector<vec3<Real>> trajectory_start_pos_{}, momenta_{}, energy_gradients_{};
+    std::vector<Index> collective_move_ids_{}, trajectory_node_ids_{};
+    std::vector<vec3<Real>> collective_move_displacements_{}, node_displacements_{};
+    std::optional<AnnealingSchedule<Real>> annealing_schedule_{};
+    //! Displacement amplitudes of bulk and boundary nodes, indexed by the DisplacementClass of a node.
+    std::array<Real, 2> linear_displacements_{0, 0};
+    Real target_move_acceptance_rate_{0}, displacement_adaptation_gain_{1};
+    unsigned long remaining_adaptation_sweeps_{0};
+    std::vector<Index> sweep_order_{};
+    std::vector<bool> is_boundary_node_{};
+    unsigned long sweep_count_{0};
+    Real last_sweep_move_acceptance_rate_{1}, last_sweep_flip_acceptance_rate_{1};
+    std::optional<std::uint64_t> parallel_seed_{};
+    //! Node ids of every color of the last parallel sweep, in increasing order, see update_move_colors().
+    std::vector<std::vector<Index>> move_colors_{};
+    std::vector<Index> node_colors_{};
+    Index n_node_colors_{0};
+    unsigned long colored_connectivity_version_{0};
+    unsigned long classified_connectivity_version_{0};
+    std::vector<char> color_is_taken_{};
+    std::vector<Index> deferred_proposal_positions_{};
+    std::vector<MoveProposal> move_proposals_{};
+    std::vector<Index> accepted_move_ids_{};
+    std::vector<vec3<Real>> accepted_move_displacements_{};
+
+    [[nodiscard]] unsigned long accepted_move_count() const { return move_attempt - bond_length_move_rejection - move_back; }
+    [[nodiscard]] unsigned long accepted_flip_count() const { return flip_attempt - bond_length_flip_rejection - flip_back; }
+
+    //! Marks the boundary nodes of the triangulation, so that the sweep can use their displacement amplitude.
+    void update_displacement_classes()
+    {
+        is_boundary_node_.assign(triangulation.size(), false);
+        classified_connectivity_version_ = triangulation.connectivity_version();
+        if constexpr (triangulation_type==EXPERIMENTAL_PLANAR_TRIANGULATION) {
+            for (Index node_id: triangulation.boundary_nodes_ids_set()) { is_boundary_node_[node_id] = true; }
+        }
+    }
+
+    [[nodiscard]] DisplacementClass node_displacement_class(Index node_id) const
+    {
+        return is_boundary_node_[node_id] ? BOUNDARY_NODE_DISPLACEMENT : BULK_NODE_DISPLACEMENT;
+    }
+
+    //! Scales the displacement amplitude of a node class towards the target acceptance rate.
+    void adapt_linear_displacement_of_class(DisplacementClass displacement_class, unsigned long attempts, unsigned long accepted)
+    {
+        if (attempts==0) { return; }
+        Real acceptance_rate = static_cast<Real>(accepted)/static_cast<Real>(attempts);
+        Real& displacement = linear_displacements_[displacement_class];
+        displacement *= std::exp(displacement_adaptation_gain_*(acceptance_rate - target_move_acceptance_rate_));
+        displacement = std::min(displacement, std::sqrt(max_bond_length_square));
+    }
+
+    //! Evaluates the energy gradient of every node that takes part in a Hamiltonian trajectory.
+    void update_energy_gradients()
+    {
+        fp::Geometry<Real, Index> const energy_derivatives = energy_derivative_function(triangulation, prms);
+        for (Index node_id = 0; node_id<static_cast<Index>(triangulation.size()); ++node_id) {
+            if (!is_boundary_node_[node_id]) { energy_gradients_[node_id] = triangulation.energy_gradient(node_id, energy_derivatives); }
+        }
+    }
+
+    //! Kinetic energy of the current momenta, with unit mass for every node.
+    [[nodiscard]] Real kinetic_energy() const
+    {
+        Real kinetic = 0;
+        for (auto const& momentum: momenta_) { kinetic += momentum.norm_square()/2; }
+        return kinetic;
+    }
+
+    //! Moves every node back to the position that it had at the beginning of the Hamiltonian trajectory.
+    void restore_trajectory_start()
+    {
+        for (Index node_id = 0; node_id<static_cast<Index>(triangulation.size()); ++node_id) {
+            node_displacements_[node_id] = trajectory_start_pos_[node_id] - triangulation[node_id].pos;
+        }
+        triangulation.move_nodes(trajectory_node_ids_, node_displacements_);
+        std::fill(node_displacements_.begin(), node_displacements_.end(), vec3<Real>{0, 0, 0});
+    }
+
+    //! Position of a Verlet neighbor. The access is only bounds checked in debug builds.
+    fp::vec3<Real> const& verlet_neighbour_pos(Index verlet_neighbour_id) const
+    {
+#ifdef DEBUG
+        return triangulation[verlet_neighbour_id].pos;
+#else
+        return triangulation.nodes().pos(verlet_neighbour_id);
+#endif
+    }
+
+    //! Implementation of the overlap check, for both the per-node and the compact Verlet list.
+    /**
+     * The distance vector to each Verlet neighbor is computed once and reused for the old and the new distance, and
+     * the acceptance condition is evaluated without short circuiting.
+     */
+    bool verlet_neighbours_do_not_overlap(auto const& verlet_neighbour_ids, fp::Node<Real, Index> const& node,
+                                          fp::vec3<Real> const& displacement) const
+    {
+        Real distance_square_new, distance_square_old;
+        for (auto const& verlet_neighbour_id: verlet_neighbour_ids)
+        {
+            fp::vec3<Real> const distance = verlet_neighbour_pos(static_cast<Index>(verlet_neighbour_id)) - node.pos;
+            distance_square_old = distance.norm_square();
+            distance_square_new = (distance - displacement).norm_square();
+            if ((distance_square_new<min_bond_length_square) & (distance_square_old>min_bond_length_square)) { return false; }
+        }
+        return true;
+    }
+
+    //! `true` if a collective move keeps all pairs of nodes that involve a moved node within the bond length and overlap constraints.
+    /**
+     * The moved nodes and their displacements are read from collective_move_ids_ and collective_move_displacements_.
+     */
+    bool collective_move_is_allowed()
+    {
+        node_displacements_.resize(triangulation.size(), vec3<Real>{0, 0, 0});
+        for (std::size_t i = 0; i<collective_move_ids_.size(); ++i) { node_displacements_[collective_move_ids_[i]] = collective_move_displacements_[i]; }
+        bool allowed = true;
+        for (std::size_t i = 0; allowed && i<collective_move_ids_.size(); ++i) {
+            allowed = new_neighbour_distances_are_between_min_and_max_length(triangulation[collective_move_ids_[i]], node_displacements_);
+        }
+        for (Index node_id: collective_move_ids_) { node_displacements_[node_id] = vec3<Real>{0, 0, 0}; }
+        return allowed;
+    }
+
+    //! Sum of the staged energy terms for a global geometry.
+    [[nodiscard]] Real staged_energy(Geometry<Real, Index> const& geometry) const
+    {
+        Real energy = 0;
+        for (auto const& term: staged_energy_terms_) { energy += term.energy(geometry, prms); }
+        return energy;
+    }
+
+    //! Energy for a global geometry, from the staged energy if it has terms, or else from the geometry energy function.
+    [[nodiscard]] Real geometry_energy(Geometry<Real, Index> const& geometry) const
+    {
+        if (!staged_energy_terms_.empty()) { return staged_energy(geometry); }
+        return geometry_energy_function(geometry, prms);
+    }
+
+    //! \f$\ln\sum_i e^{x_i}\f$, evaluated without overflow. Returns \f$-\infty\f$ if all \f$x_i\f$ are \f$-\infty\f$.
+    [[nodiscard]] static Real log_sum_exp(std::vector<Real> const& log_terms)
+    {
+        Real const max_log_term = *std::max_element(log_terms.begin(), log_terms.end());
+        if (max_log_term==-std::numeric_limits<Real>::infinity()) { return max_log_term; }
+        Real sum = 0;
+        for (Real log_term: log_terms) { sum += std::exp(log_term - max_log_term); }
+        return max_log_term + std::log(sum);
+    }
+
+    //! Energy of the triangulation after a speculative move of a node, or infinity if the move breaks the bond length constraints.
+    [[nodiscard]] Real energy_after_try(Index node_id, vec3<Real> const& displacement, Geometry<Real, Index> const& before_without_two_ring)
+    {
+        if (!new_neighbour_distances_are_between_min_and_max_length(triangulation[node_id], displacement)) {
+            return std::numeric_limits<Real>::infinity();
+        }
+        return geometry_energy(before_without_two_ring + triangulation.two_ring_geometry_after_move(node_id, displacement));
+    }
+
+    //! Evaluates the energy function of the updater for a node, or the staged energy if it has terms.
+    [[nodiscard]] Real node_energy(fp::Node<Real, Index> const& node) const
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::energy_function");
+        if (!staged_energy_terms_.empty()) { return staged_energy(triangulation.global_geometry()); }
+        return energy_function(node, triangulation, prms);
+    }
+
+    //! Energy of the triangulation for collective moves, see collective_move_MC_updater(Real).
+    [[nodiscard]] Real collective_move_energy() const
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::energy_function");
+        if (!staged_energy_terms_.empty()) { return staged_energy(triangulation.global_geometry()); }
+        if (total_energy_function) { return total_energy_function(triangulation, prms); }
+        return energy_function(triangulation[collective_move_ids_.front()], triangulation, prms);
+    }
+
+    //! Attempt the collective move that is stored in collective_move_ids_ and collective_move_displacements_.
+    /**
+     * All nodes are moved with a single call of Triangulation::move_nodes, and the energy is evaluated once before and
+     * once after the move.
+     * @param log_proposal_ratio same as in move_needs_undoing(Real).
+     */
+    void collective_move_MC_updater(Real log_proposal_ratio = 0)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::collective_move_MC_updater");
+        ++collective_move_attempt;
+        if (collective_move_ids_.empty()) { return; }
+        if (!collective_move_is_allowed()) {
+            ++bond_length_collective_move_rejection;
+            return;
+        }
+        e_old = collective_move_energy();
+        triangulation.move_nodes(collective_move_ids_, collective_move_displacements_);
+        e_new = collective_move_energy();
+        if (move_needs_undoing(log_proposal_ratio)) {
+            for (auto& displacement: collective_move_displacements_) { displacement = -displacement; }
+            triangulation.move_nodes(collective_move_ids_, collective_move_displacements_);
+            ++collective_move_back;
+        }
+    }
+
+    //! Updates the temperature from the annealing schedule and the displacement classes, and records the counters.
+    SweepStatistics begin_sweep()
+    {
+        if (annealing_schedule_) {
+            kBT_ = annealing_schedule_->kBT(sweep_count_, kBT_, last_sweep_move_acceptance_rate_);
+        }
+        if (sweep_order_.size()!=triangulation.size()) {
+            sweep_order_.resize(triangulation.size());
+            std::iota(sweep_order_.begin(), sweep_order_.end(), Index(0));
+        }
+        update_displacement_classes();
+        return {.move_attempts=move_attempt, .accepted_moves=accepted_move_count(),
+                .flip_attempts=flip_attempt, .accepted_flips=accepted_flip_count()};
+    }
+
+    //! Adapts the displacement amplitudes and records the acceptance rates of the sweep.
+    void finish_sweep(SweepStatistics const& statistics)
+    {
+        ++sweep_count_;
+        if (remaining_adaptation_sweeps_>0) {
+            adapt_linear_displacement_of_class(BULK_NODE_DISPLACEMENT, statistics.class_attempts[BULK_NODE_DISPLACEMENT], statistics.class_accepted[BULK_NODE_DISPLACEMENT]);
+            adapt_linear_displacement_of_class(BOUNDARY_NODE_DISPLACEMENT, statistics.class_attempts[BOUNDARY_NODE_DISPLACEMENT], statistics.class_accepted[BOUNDARY_NODE_DISPLACEMENT]);
+            --remaining_adaptation_sweeps_;
+        }
+        if (move_attempt>statistics.move_attempts) {
+            last_sweep_move_acceptance_rate_ = static_cast<Real>(accepted_move_count() - statistics.accepted_moves)
+                    /static_cast<Real>(move_attempt - statistics.move_attempts);
+        }
+        if (flip_attempt>statistics.flip_attempts) {
+            last_sweep_flip_acceptance_rate_ = static_cast<Real>(accepted_flip_count() - statistics.accepted_flips)
+                    /static_cast<Real>(flip_attempt - statistics.flip_attempts);
+        }
+    }
+
+    //! Metropolis criterion with a uniform random number that was drawn in advance.
+    /**
+     * @return `true` if the move from the energy `energy_before` to `energy_after` is rejected, like move_needs_undoing().
+     */
+    [[nodiscard]] bool move_is_rejected(Real energy_before, Real energy_after, Real uniform) const
+    {
+        Real const energy_difference = energy_before - energy_after;
+        if (kBT_>0) { return (energy_difference<0) && (uniform>std::exp(energy_difference/kBT_)); }
+        return energy_difference<0;
+    }
+
+    //! Index of the next uniform random number in the batch, which is refilled if it is used up.
+    std::size_t next_batch_index()
+    {
+        if (next_batch_uniform_==batch_uniforms_.size()) {
+            FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::refill_log_uniforms");
+            // the uniforms are drawn first, so that the logarithms are a loop of their own that the compiler vectorizes
+            for (auto& value: batch_uniforms_) { value = unif_distr_on_01(rng); }
+            for (std::size_t i = 0; i<batch_uniforms_.size(); ++i) { batch_log_uniforms_[i] = approximate_log(static_cast<double>(batch_uniforms_[i])); }
+            next_batch_uniform_ = 0;
+        }
+        return next_batch_uniform_++;
+    }
+
+    //! `true` if the Metropolis decision with the logarithm `log_acceptance` of the acceptance probability rejects the move.
+    /**
+     * The move is rejected if \f$u>e^{\mathrm{log\_acceptance}}\f$. With a logarithm of the uniform number that was drawn
+     * by metropolis_threshold() or in a batch, this is evaluated as \f$\ln u>\mathrm{log\_acceptance}\f$ without an exponential.
+     * The approximate logarithms of a batch decide unless they are within approximate_log_error of `log_acceptance`,
+     * so the decision is the same as with `std::log`.
+     */
+    bool metropolis_rejects(Real log_acceptance)
+    {
+        if (drawn_log_uniform_) {
+            Real const log_uniform = *drawn_log_uniform_;
+            drawn_log_uniform_.reset();
+            return log_uniform>log_acceptance;
+        }
+        if (log_acceptance>=0) { return false; }
+        if (batch_uniforms_.empty()) { return unif_distr_on_01(rng)>std::exp(log_acceptance); }
+        std::size_t const k = next_batch_index();
+        double const approximate_log_uniform = batch_log_uniforms_[k];
+        // uniforms that are zero or subnormal are so rare that they are always decided with std::log
+        if ((std::abs(approximate_log_uniform - log_acceptance)>approximate_log_error) & (approximate_log_uniform>-700)) {
+            return approximate_log_uniform>log_acceptance;
+        }
+        return std::log(batch_uniforms_[k])>log_acceptance;
+    }
+
+    //! Counter-based random numbers of a node in a phase of the current parallel sweep.
+    [[nodiscard]] Philox4x32 keyed_engine(Index node_id, ParallelSweepStream stream) const
+    {
+        return Philox4x32(*parallel_seed_, {0, static_cast<std::uint32_t>(node_id), static_cast<std::uint32_t>(sweep_count_), stream});
+    }
+
+    //! Random numbers of the calling thread, for the fast mode of parallel_sweep(). Every thread gets its own stream.
+    [[nodiscard]] static Philox4x32& thread_engine(std::uint64_t seed)
+    {
+        static std::atomic<std::uint32_t> n_thread_streams{0};
+        thread_local Philox4x32 engine(seed, {0, 0, n_thread_streams.fetch_add(1), THREAD_STREAM});
+        if (engine.key()!=Philox4x32(seed).key()) { engine.seed(seed, {0, 0, n_thread_streams.fetch_add(1), THREAD_STREAM}); }
+        return engine;
+    }
+
+    //! Marks the colors of all nodes within two bonds of a node in color_is_taken_, and returns the smallest free color.
+    Index smallest_free_color(Index node_id)
+    {
+        constexpr Index uncolored = std::numeric_limits<Index>::max();
+        color_is_taken_.assign(static_cast<std::size_t>(n_node_colors_) + 1, false);
+        auto take_color_of = [&](Index other_id) {
+            if (other_id!=node_id && node_colors_[other_id]!=uncolored) { color_is_taken_[node_colors_[other_id]] = true; }
+        };
+        for (Index nn_id: triangulation[node_id].nn_ids) {
+            take_color_of(nn_id);
+            for (Index nn_nn_id: triangulation[nn_id].nn_ids) { take_color_of(nn_nn_id); }
+        }
+        Index color = 0;
+        while (color_is_taken_[color]) { ++color; }
+        return color;
+    }
+
+    void set_node_color(Index node_id, Index color)
+    {
+        node_colors_[node_id] = color;
+        n_node_colors_ = std::max(n_node_colors_, static_cast<Index>(color + 1));
+    }
+
+    //! Gives a node the smallest free color if a bond flip brought a node of the same color within two bonds of it.
+    void repair_node_color(Index node_id)
+    {
+        Index const free_color = smallest_free_color(node_id);
+        if (color_is_taken_[node_colors_[node_id]]) { set_node_color(node_id, free_color); }
+    }
+
+    //! Colors the nodes, such that nodes of the same color can be moved at the same time without influencing each other.
+    /**
+     * Two nodes get different colors if they are at most two bonds apart, since the move of a node changes the local
+     * geometry of its next neighbors, which depends on the positions of their next neighbors. The colors are assigned
+     * greedily in the order of the node ids, so they only depend on the triangulation.
+     * The colors are kept from one parallel sweep to the next. Its own flips only change the connectivity around the
+     * new bond, and the two nodes of the new bond are recolored right away if necessary (see repair_node_color()).
+     * All nodes are only colored anew if the connectivity was changed elsewhere, according to Triangulation::connectivity_version().
+     */
+    void update_move_colors()
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::update_move_colors");
+        auto const n_nodes = static_cast<Index>(triangulation.size());
+        if (node_colors_.size()!=triangulation.size() || colored_connectivity_version_!=triangulation.connectivity_version()) {
+            node_colors_.assign(triangulation.size(), std::numeric_limits<Index>::max());
+            n_node_colors_ = 0;
+            for (Index node_id = 0; node_id<n_nodes; ++node_id) { set_node_color(node_id, smallest_free_color(node_id)); }
+        }
+        move_colors_.resize(n_node_colors_);
+        for (auto& color: move_colors_) { color.clear(); }
+        for (Index node_id = 0; node_id<n_nodes; ++node_id) { move_colors_[node_colors_[node_id]].push_back(node_id); }
+        std::erase_if(move_colors_, [](std::vector<Index> const& color) { return color.empty(); });
+    }
+
+    //! `true` if a Verlet neighbor of the same color is so close that the moves of both nodes could bring them closer than the minimal bond length.
+    [[nodiscard]] bool has_close_verlet_neighbour_of_same_color(Index node_id) const
+    {
+        Real const max_displacement = std::max(linear_displacements_[BULK_NODE_DISPLACEMENT], linear_displacements_[BOUNDARY_NODE_DISPLACEMENT]);
+        Real const overlap_range = std::sqrt(min_bond_length_square) + 2*std::sqrt(Real(3))*max_displacement;
+        auto has_close_neighbour = [&](auto const& verlet_neighbour_ids) {
+            for (auto const& verlet_neighbour_id: verlet_neighbour_ids) {
+                auto const other_id = static_cast<Index>(verlet_neighbour_id);
+                if (node_colors_[other_id]==node_colors_[node_id]
+                    && (verlet_neighbour_pos(other_id) - triangulation[node_id].pos).norm_square()<overlap_range*overlap_range) { return true; }
+            }
+            return false;
+        };
+        if (triangulation.uses_compact_verlet_list()) { return has_close_neighbour(triangulation.compact_verlet_list()[node_id]); }
+        return has_close_neighbour(triangulation[node_id].verlet_list);
+    }
+
+    //! Draws the move of a node, and evaluates the constraints and the change of the global geometry without changing the triangulation.
+    /**
+     * If a Verlet neighbor of the same color is close, the evaluation is deferred, see perform_deferred_move().
+     */
+    void propose_parallel_move(Index node_id, Philox4x32& engine, MoveProposal& proposal)
+    {
+        Real const amplitude = linear_displacements_[node_displacement_class(node_id)];
+        proposal.displacement = {amplitude*(2*uniform_real<Real>(engine) - 1), amplitude*(2*uniform_real<Real>(engine) - 1), amplitude*(2*uniform_real<Real>(engine) - 1)};
+        proposal.acceptance_uniform = uniform_real<Real>(engine);
+        proposal.accepted = false;
+        proposal.deferred = has_close_verlet_neighbour_of_same_color(node_id);
+        if (proposal.deferred) { return; }
+        proposal.allowed = new_neighbour_distances_are_between_min_and_max_length(triangulation[node_id], proposal.displacement);
+        if (proposal.allowed) {
+            proposal.geometry_change = triangulation.two_ring_geometry_after_move(node_id, proposal.displacement)
+                    - triangulation.get_two_ring_geometry(node_id);
+        }
+    }
+
+    //! Evaluates and performs a deferred move of a color on the calling thread, after the other moves of the color were performed.
+    void perform_deferred_move(Index node_id, MoveProposal const& proposal, SweepStatistics& statistics)
+    {
+        DisplacementClass const node_class = node_displacement_class(node_id);
+        ++move_attempt;
+        ++statistics.class_attempts[node_class];
+        if (!new_neighbour_distances_are_between_min_and_max_length(triangulation[node_id], proposal.displacement)) {
+            ++bond_length_move_rejection;
+            return;
+        }
+        e_old = geometry_energy_function(triangulation.global_geometry(), prms);
+        e_new = geometry_energy_function(triangulation.global_geometry_after_move(node_id, proposal.displacement), prms);
+        if (move_is_rejected(e_old, e_new, proposal.acceptance_uniform)) {
+            ++move_back;
+            return;
+        }
+        ++statistics.class_accepted[node_class];
+        triangulation.move_node(node_id, proposal.displacement);
+    }
+
+    //! Moves the nodes of a color of parallel_sweep().
+    void parallel_move_color(std::vector<Index> const& color, ThreadPool& pool, ParallelSweepMode mode, SweepStatistics& statistics)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::parallel_move_color");
+        move_proposals_.resize(color.size());
+        std::size_t const n_chunks = (color.size() + parallel_sweep_chunk_size - 1)/parallel_sweep_chunk_size;
+        pool.parallel_for(n_chunks, [&](std::size_t chunk) {
+            std::size_t const chunk_end = std::min(color.size(), (chunk + 1)*parallel_sweep_chunk_size);
+            for (std::size_t i = chunk*parallel_sweep_chunk_size; i<chunk_end; ++i) {
+                MoveProposal& proposal = move_proposals_[i];
+                if (mode==DETERMINISTIC_PARALLEL_SWEEP) {
+                    Philox4x32 engine = keyed_engine(color[i], MOVE_STREAM);
+                    propose_parallel_move(color[i], engine, proposal);
+                }
+                else { propose_parallel_move(color[i], thread_engine(*parallel_seed_), proposal); }
+            }
+        });
+
+        // the energy is not linear in the global geometry, so the moves are accepted one after the other, and every
+        // move is accepted against the geometry after the accepted moves before it
+        Geometry<Real, Index> geometry = triangulation.global_geometry();
+        Real energy = geometry_energy_function(geometry, prms);
+
+        accepted_move_ids_.clear();
+        accepted_move_displacements_.clear();
+        deferred_proposal_positions_.clear();
+        for (std::size_t i = 0; i<color.size(); ++i) {
+            MoveProposal& proposal = move_proposals_[i];
+            if (proposal.deferred) {
+                deferred_proposal_positions_.push_back(static_cast<Index>(i));
+                continue;
+            }
+            DisplacementClass const node_class = node_displacement_class(color[i]);
+            ++move_attempt;
+            ++statistics.class_attempts[node_class];
+            if (!proposal.allowed) {
+                ++bond_length_move_rejection;
+                continue;
+            }
+            // the two-rings of the nodes of a color do not overlap, so the change of the global geometry of every
+            // move is the same as if the moves before it had already been performed
+            Geometry<Real, Index> const new_geometry = geometry + proposal.geometry_change;
+            e_old = energy;
+            e_new = geometry_energy_function(new_geometry, prms);
+            proposal.accepted = !move_is_rejected(e_old, e_new, proposal.acceptance_uniform);
+            if (proposal.accepted) {
+                geometry = new_geometry;
+                energy = e_new;
+            }
+            if (!proposal.accepted) {
+                ++move_back;
+                continue;
+            }
+            ++statistics.class_accepted[node_class];
+            accepted_move_ids_.push_back(color[i]);
+            accepted_move_displacements_.push_back(proposal.displacement);
+        }
+        triangulation.move_nodes(accepted_move_ids_, accepted_move_displacements_, pool);
+        for (Index i: deferred_proposal_positions_) { perform_deferred_move(color[i], move_proposals_[i], statistics); }
+    }
+
+    //! Flip attempt of parallel_sweep(), with the geometry energy function and counter-based random numbers.
+    void parallel_sweep_flip(Index node_id)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::flip_MC_updater");
+        Philox4x32 engine = keyed_engine(node_id, FLIP_STREAM);
+        ++flip_attempt;
+        auto const& nn_ids = triangulation[node_id].nn_ids;
+        std::size_t const j = std::min(nn_ids.size() - 1, static_cast<std::size_t>(uniform_real<Real>(engine)*static_cast<Real>(nn_ids.size())));
+        Index const nn_id = nn_ids[j];
+        e_old = geometry_energy_function(triangulation.global_geometry(), prms);
+        auto const bfd = triangulation.flip_bond(node_id, nn_id, min_bond_length_square, max_bond_length_square);
+        if (!bfd.flipped) {
+            ++bond_length_flip_rejection;
+            return;
+        }
+        e_new = geometry_energy_function(triangulation.global_geometry(), prms);
+        if (move_is_rejected(e_old, e_new, uniform_real<Real>(engine))) {
+            triangulation.unflip_bond(node_id, nn_id, bfd);
+            ++flip_back;
+            return;
+        }
+        repair_node_color(bfd.common_nn_0);
+        repair_node_color(bfd.common_nn_1);
+    }
+
+    MonteCarloUpdater(fp::Triangulation<Real, Index, triangulation_type>& triangulation_inp,
+                      EnergyFunctionParameters const& prms_inp,
+                      std::function<Real(fp::Node<Real, Index> const&, fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> energy_function_inp,
+                      std::shared_ptr<RandomNumberEngine> owned_rng, Real min_bond_length, Real max_bond_length)
+    :MonteCarloUpdater(triangulation_inp, prms_inp, std::move(energy_function_inp), *owned_rng, min_bond_length, max_bond_length)
+    {
+        owned_rng_ = std::move(owned_rng);
+    }
 
 public:
+    //! Maximal number of moves of a color that are evaluated by a single task of parallel_sweep().
+    static constexpr std::size_t parallel_sweep_chunk_size = 64;
 
     /**
      * @param triangulation_inp Reference to the triangulation that will be updated.
@@ -68,6 +686,28 @@ public:
 
     }
 
+    //! Constructor for an updater that owns its random number engine.
+    /**
+     * Same as the constructor above, but the engine is moved into the updater, so the caller does not have to keep it
+     * alive, e.g. `MonteCarloUpdater<..., fp::Xoshiro256StarStar, ...> updater(guv, prms, energy, fp::Xoshiro256StarStar(seed), l_min, l_max)`.
+     * The engine can be accessed with random_number_engine(), e.g. to derive substreams from it.
+     */
+    MonteCarloUpdater(fp::Triangulation<Real, Index, triangulation_type>& triangulation_inp,
+                      EnergyFunctionParameters const& prms_inp,
+                      std::function<Real(fp::Node<Real, Index> const&, fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> energy_function_inp,
+                      RandomNumberEngine&& rng_inp, Real min_bond_length, Real max_bond_length)
+    :MonteCarloUpdater(triangulation_inp, prms_inp, std::move(energy_function_inp),
+                       std::make_shared<RandomNumberEngine>(std::move(rng_inp)), min_bond_length, max_bond_length) { }
+
+    //! @getterFunctionStub
+    /**
+     * @return The random number engine of the updater, whether it is owned by the updater or by the caller.
+     */
+    [[nodiscard]] RandomNumberEngine& random_number_engine() const
+    {
+        return rng;
+    }
+
     //! Implementation of the Metropolis algorithm.
     /**
      * This function implements the [Metropolis algorithm](https://en.wikipedia.org/wiki/Metropolis-Hastings_algorithm)
@@ -79,8 +719,30 @@ public:
     {
         e_diff = e_old - e_new;
         if(kBT_>0){ //temperature can safely be put to 0, this will make the algorithm greedy
-            return (e_diff<0) && (unif_distr_on_01(rng)>std::exp(e_diff/kBT_));
+            return metropolis_rejects(e_diff/kBT_);
+        }else{
+            drawn_log_uniform_.reset();
+            return (e_diff<0);
+        }
+    }
+
+    //! Implementation of the Metropolis–Hastings algorithm for asymmetric proposals.
+    /**
+     * Like move_needs_undoing(), but the acceptance probability of the move is
+     * \f$\min\left(1, e^{(E_{old}-E_{new})/k_BT}\frac{q(x|x')}{q(x'|x)}\right)\f$,
+     * where \f$q(x'|x)\f$ is the probability to propose the new state \f$x'\f$ from the old state \f$x\f$.
+     * At zero temperature the proposal ratio is ignored and the algorithm is greedy.
+     * @param log_proposal_ratio \f$\ln\left(q(x|x')/q(x'|x)\right)\f$.
+     * @return `true` if the move is rejected and needs to be undone, `false` otherwise.
+     */
+    bool move_needs_undoing(Real log_proposal_ratio)
+    {
+        e_diff = e_old - e_new;
+        if(kBT_>0){
+            Real log_acceptance = e_diff/kBT_ + log_proposal_ratio;
+            return metropolis_rejects(log_acceptance);
         }else{
+            drawn_log_uniform_.reset();
             return (e_diff<0);
         }
     }
@@ -101,11 +763,49 @@ public:
                                                                      fp::vec3<Real> const& displacement)
 
     {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::distance_checks");
         return (new_next_neighbour_distances_are_between_min_and_max_length(node, displacement)&&
             new_verlet_neighbour_distances_are_between_min_and_max_length(node, displacement));
 
     }
 
+    //! Pre-update check for moves in which the neighbors of the node move at the same time.
+    /**
+     * Like new_neighbour_distances_are_between_min_and_max_length(fp::Node<Real, Index> const&, fp::vec3<Real> const&),
+     * but the new distance to each next neighbor and Verlet list neighbor is calculated from the displacements of both
+     * nodes of the pair. This is the check for collective moves, like the moves of Triangulation::move_nodes.
+     * If every moved node passes the check, none of the pairs of nodes that change their distance violates the constraints.
+     * @param node @mcuNodeStub
+     * @param node_displacements displacements of all nodes of the triangulation, indexed by the node id.
+     * Nodes that do not move have a zero displacement.
+     * @return `true` if all next neighbor distances stay between the minimal and maximal allowed values and the node
+     * does not start to overlap with any of its Verlet list neighbors, `false` otherwise.
+     */
+    bool new_neighbour_distances_are_between_min_and_max_length(fp::Node<Real, Index> const& node,
+                                                                std::span<vec3<Real> const> node_displacements) const
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::distance_checks");
+        vec3<Real> const& displacement = node_displacements[node.id];
+        auto pair_is_allowed = [&](Index other_id, vec3<Real> const& distance, bool is_bond) {
+            Real const distance_square_old = distance.norm_square();
+            Real const distance_square_new = (distance + node_displacements[other_id] - displacement).norm_square();
+            if (is_bond && (distance_square_new>max_bond_length_square) && (distance_square_old<max_bond_length_square)) { return false; }
+            return !((distance_square_old>min_bond_length_square) && (distance_square_new<min_bond_length_square));
+        };
+        for (std::size_t j = 0; j<node.nn_ids.size(); ++j) {
+            if (!pair_is_allowed(node.nn_ids[j], node.nn_distances[j], true)) { return false; }
+        }
+        auto verlet_neighbours_are_allowed = [&](auto const& verlet_neighbour_ids) {
+            for (auto const& verlet_neighbour_id: verlet_neighbour_ids) {
+                Index const other_id = static_cast<Index>(verlet_neighbour_id);
+                if (!pair_is_allowed(other_id, verlet_neighbour_pos(other_id) - node.pos, false)) { return false; }
+            }
+            return true;
+        };
+        if (triangulation.uses_compact_verlet_list()) { return verlet_neighbours_are_allowed(triangulation.compact_verlet_list()[node.id]); }
+        return verlet_neighbours_are_allowed(node.verlet_list);
+    }
+
     //! Pre-update check to test that the update step will not result in an unphysical configuration.
     /**
      * Iterate through the next neighbor distances of a node which is a collection of
@@ -151,15 +851,10 @@ public:
                                                                      fp::vec3<Real> const& displacement)
 
     {
-
-        Real distance_square_new, distance_square_old;
-        for (auto const& verlet_neighbour_id: node.verlet_list)
-        {
-            distance_square_new=(triangulation[verlet_neighbour_id].pos - node.pos - displacement).norm_square();
-            distance_square_old=(triangulation[verlet_neighbour_id].pos - node.pos).norm_square();
-            if ((distance_square_new<min_bond_length_square)&&(distance_square_old>min_bond_length_square)) { return false; }
+        if (triangulation.uses_compact_verlet_list()) {
+            return verlet_neighbours_do_not_overlap(triangulation.compact_verlet_list()[node.id], node, displacement);
         }
-        return true;
+        return verlet_neighbours_do_not_overlap(node.verlet_list, node, displacement);
     }
 
     //! Attempt a move Monte Carlo Step.
@@ -172,15 +867,440 @@ public:
      */
     void move_MC_updater(fp::Node<Real, Index> const& node, fp::vec3<Real> const& displacement)
     {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::move_MC_updater");
         ++move_attempt;
         if (new_neighbour_distances_are_between_min_and_max_length(node, displacement)) {
-            e_old = energy_function(node, triangulation, prms);
+            e_old = node_energy(node);
             triangulation.move_node(node.id, displacement);
-            e_new = energy_function(node, triangulation, prms);
+            e_new = node_energy(node);
             if (move_needs_undoing()) {triangulation.move_node(node.id, -displacement); ++move_back;}
         }else{++bond_length_move_rejection;}
     }
 
+    //! Attempt a move Monte Carlo step with the staged energy, which can reject the move before its energy is known.
+    /**
+     * The uniform random number of the Metropolis decision is drawn first, which fixes the largest energy increase that
+     * is accepted (see metropolis_threshold()). Then the terms of the AREA_ENERGY_STAGE are evaluated with the area
+     * change from Triangulation::area_change_after_move, and the terms of the GEOMETRY_ENERGY_STAGE are replaced by their
+     * lower bounds. If this lower bound of the energy change already exceeds the threshold, the move is rejected without
+     * calculating the geometry of the two-ring. Otherwise, the full energy change is calculated with
+     * Triangulation::two_ring_geometry_after_move and decided as usual. The triangulation is only changed if the move is
+     * accepted, and the decisions are the same as without early rejections.
+     * Early rejections are counted by move_back and by staged_early_rejection_count().
+     * @param node @mcuNodeStub
+     * @param displacement @mcuDisplacementStub
+     */
+    void staged_move_MC_updater(fp::Node<Real, Index> const& node, fp::vec3<Real> const& displacement)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::staged_move_MC_updater");
+        ++move_attempt;
+        if (!new_neighbour_distances_are_between_min_and_max_length(node, displacement)) {
+            ++bond_length_move_rejection;
+            return;
+        }
+        Real const threshold = metropolis_threshold();
+        Geometry<Real, Index> const before = triangulation.global_geometry();
+        Geometry<Real, Index> const two_ring_before = triangulation.get_two_ring_geometry(node.id);
+        if (std::optional<Real> const area_change = triangulation.area_change_after_move(node.id, displacement)) {
+            Geometry<Real, Index> after_area_change = before;
+            after_area_change.area += *area_change;
+            Real min_energy_change = 0;
+            bool is_bounded = true;
+            for (auto const& term: staged_energy_terms_) {
+                if (term.stage==AREA_ENERGY_STAGE) {
+                    min_energy_change += term.energy(after_area_change, prms) - term.energy(before, prms);
+                }
+                else if (term.min_delta) { min_energy_change += term.min_delta(before, two_ring_before, displacement, prms); }
+                else { is_bounded = false; }
+            }
+            if (is_bounded && min_energy_change>threshold) {
+                drawn_log_uniform_.reset();
+                ++move_back;
+                ++staged_early_rejection;
+                return;
+            }
+        }
+        e_old = staged_energy(before);
+        e_new = staged_energy(before - two_ring_before + triangulation.two_ring_geometry_after_move(node.id, displacement));
+        if (move_needs_undoing()) {
+            ++move_back;
+            return;
+        }
+        triangulation.move_node(node.id, displacement);
+    }
+
+    //! Attempt a multiple-try Metropolis move of a node.
+    /**
+     * The [multiple-try Metropolis](https://doi.org/10.1080/01621459.2000.10473908) algorithm draws `n_tries` candidate
+     * displacements from the cube of side length `2*linear_displacement(c)`, where `c` is the class of the node, and
+     * evaluates the energies of all of them with Triangulation::two_ring_geometry_after_move, without moving the node.
+     * One candidate \f$y\f$ is selected with a probability that is proportional to its Boltzmann weight
+     * \f$w(y)=e^{-E(y)/k_BT}\f$. Then `n_tries - 1` reference displacements are drawn from the cube around \f$y\f$, and
+     * together with the current position \f$x\f$ they make up the reference set \f$x^*\f$. The move to \f$y\f$ is accepted
+     * with the probability \f$\min\left(1, \sum w(y_i)/\sum w(x^*_i)\right)\f$, where both sums are evaluated as
+     * log-sum-exps. This satisfies detailed balance, and it makes larger displacements worth trying: the acceptance rate
+     * per move grows with the number of tries, at the cost of about `2*n_tries - 1` evaluations of the two-ring geometry.
+     * Candidates that break the bond length constraints have zero weight. The move counts as a bond length rejection
+     * if all candidates break them.
+     * At zero temperature, the candidate with the lowest energy is selected, and it is accepted if it does not increase
+     * the energy.
+     *
+     * The energy is evaluated from the global geometry, with the staged energy if it has terms (see
+     * add_staged_energy_term()), and otherwise with the function that is provided by set_geometry_energy_function().
+     * @param node @mcuNodeStub
+     * @param n_tries number of candidate displacements. With one try, this is a plain Metropolis move.
+     */
+    void multiple_try_move_MC_updater(fp::Node<Real, Index> const& node, unsigned n_tries)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::multiple_try_move_MC_updater");
+        ++move_attempt;
+        n_tries = std::max(n_tries, 1u);
+        Index const node_id = node.id;
+        // the method can be called before the first sweep, which marks the boundary nodes, and after the nodes were
+        // reordered elsewhere, which keeps the number of nodes
+        if (is_boundary_node_.size()!=triangulation.size() || classified_connectivity_version_!=triangulation.connectivity_version()) {
+            update_displacement_classes();
+        }
+        Real const amplitude = linear_displacements_[node_displacement_class(node_id)];
+        std::uniform_real_distribution<Real> displacement_distr(-amplitude, amplitude);
+        auto draw_displacement = [&]() { return vec3<Real>{displacement_distr(rng), displacement_distr(rng), displacement_distr(rng)}; };
+        Geometry<Real, Index> const before = triangulation.global_geometry();
+        Geometry<Real, Index> const before_without_two_ring = before - triangulation.get_two_ring_geometry(node_id);
+        e_old = geometry_energy(before);
+
+        try_displacements_.resize(n_tries);
+        try_log_weights_.resize(n_tries);
+        Index selected = 0;
+        for (Index i = 0; i<n_tries; ++i) {
+            try_displacements_[i] = draw_displacement();
+            Real const energy = energy_after_try(node_id, try_displacements_[i], before_without_two_ring);
+            try_log_weights_[i] = kBT_>0 ? -energy/kBT_ : -energy;
+            if (try_log_weights_[i]>try_log_weights_[selected]) { selected = i; }
+        }
+        if (try_log_weights_[selected]==-std::numeric_limits<Real>::infinity()) {
+            ++bond_length_move_rejection;
+            return;
+        }
+        Real log_try_weight_sum = 0;
+        if (kBT_>0) {
+            log_try_weight_sum = log_sum_exp(try_log_weights_);
+            Real const selection_uniform = unif_distr_on_01(rng);
+            Real cumulative_probability = 0;
+            for (Index i = 0; i<n_tries; ++i) {
+                Real const probability = std::exp(try_log_weights_[i] - log_try_weight_sum);
+                if (probability>0) {
+                    selected = i;
+                    cumulative_probability += probability;
+                    if (cumulative_probability>selection_uniform) { break; }
+                }
+            }
+        }
+        vec3<Real> const selected_displacement = try_displacements_[selected];
+        e_new = kBT_>0 ? -kBT_*try_log_weights_[selected] : -try_log_weights_[selected];
+
+        bool rejected;
+        if (kBT_>0) {
+            reference_log_weights_.resize(n_tries);
+            for (Index i = 0; i<n_tries - 1; ++i) {
+                reference_log_weights_[i] = -energy_after_try(node_id, selected_displacement + draw_displacement(), before_without_two_ring)/kBT_;
+            }
+            reference_log_weights_[n_tries - 1] = -e_old/kBT_;
+            rejected = metropolis_rejects(log_try_weight_sum - log_sum_exp(reference_log_weights_));
+        }
+        else { rejected = move_needs_undoing(); }
+        if (rejected) {
+            ++move_back;
+            return;
+        }
+        triangulation.move_node(node_id, selected_displacement);
+    }
+
+    //! Number of candidate displacements of the moves of sweep().
+    /**
+     * With more than one try, sweep() moves the nodes with multiple_try_move_MC_updater() instead of move_MC_updater().
+     * Since every try costs about two evaluations of the two-ring geometry, this pays off if the displacement amplitude
+     * (see reset_linear_displacement()) is increased, such that the nodes decorrelate faster per sweep.
+     * @param n_tries number of candidate displacements of every move. One restores the plain Metropolis moves.
+     */
+    void set_multiple_try_count(unsigned n_tries)
+    {
+        multiple_tries_ = std::max(n_tries, 1u);
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned multiple_try_count() const
+    {
+        return multiple_tries_;
+    }
+
+    //! Add a term to the staged energy of the updater.
+    /**
+     * As soon as the staged energy has a term, it replaces the energy function of the updater in all moves and flips,
+     * and sweep() moves the nodes with staged_move_MC_updater(). The staged energy is the sum of its terms, so it is
+     * only equivalent to the energy function for energies that depend on the node positions exclusively through the
+     * global geometry, like the energies in the demos. Cheap terms that only depend on the area should be added with
+     * the AREA_ENERGY_STAGE, and the other terms with a lower bound of their change, if possible.
+     * @param term the new term.
+     */
+    void add_staged_energy_term(StagedEnergyTerm<Real, Index, EnergyFunctionParameters> term)
+    {
+        staged_energy_terms_.push_back(std::move(term));
+    }
+
+    //! Remove all terms of the staged energy, so that the energy function of the updater is used again.
+    void clear_staged_energy_terms()
+    {
+        staged_energy_terms_.clear();
+    }
+
+    //! Provide the derivatives of the energy with respect to the global geometry, which enable force-biased moves.
+    /**
+     * @param energy_derivative_function_inp A c++ function that returns the partial derivatives of the system energy
+     * with respect to the global area, volume and unit bending energy of the triangulation, stored in the data members
+     * of a Geometry struct with the same names. It is only valid for energies that depend on the node positions
+     * exclusively through the global geometry, like the energies in the demos.
+     * @see force_biased_move_MC_updater(fp::Node<Real, Index> const&, Real)
+     */
+    void set_energy_derivative_function(std::function<fp::Geometry<Real, Index>(fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> energy_derivative_function_inp)
+    {
+        energy_derivative_function = std::move(energy_derivative_function_inp);
+    }
+
+    //! Attempt a force-biased move Monte Carlo Step.
+    /**
+     * Instead of a uniform random displacement, the displacement is drawn from the proposal of the
+     * [Metropolis-adjusted Langevin algorithm](https://en.wikipedia.org/wiki/Metropolis-adjusted_Langevin_algorithm)
+     * \f$\vec{d} = -\tau\nabla_i E + \sqrt{2\tau k_BT}\,\vec{\xi}\f$, where \f$\vec{\xi}\f$ is a vector of standard
+     * normal random numbers and the gradient is calculated with Triangulation::energy_gradient from the derivatives
+     * that are provided by set_energy_derivative_function().
+     * Since the proposal is not symmetric, the move is accepted with the Metropolis–Hastings probability,
+     * see move_needs_undoing(Real). At zero temperature the move becomes a greedy gradient descent step.
+     * The counters of move_MC_updater() are used for the statistics of these moves as well.
+     * @param node @mcuNodeStub
+     * @param time_step the step size \f$\tau\f$ of the Langevin proposal, in units of length squared per energy.
+     */
+    void force_biased_move_MC_updater(fp::Node<Real, Index> const& node, Real time_step)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::force_biased_move_MC_updater");
+        ++move_attempt;
+        Index const node_id = node.id;
+        vec3<Real> const old_gradient = triangulation.energy_gradient(node_id, energy_derivative_function(triangulation, prms));
+        vec3<Real> const old_force = -old_gradient;
+        Real const noise_amplitude = kBT_>0 ? std::sqrt(2*time_step*kBT_) : Real(0);
+        vec3<Real> const displacement = time_step*old_force
+                + noise_amplitude*vec3<Real>{std_normal_distr(rng), std_normal_distr(rng), std_normal_distr(rng)};
+        if (new_neighbour_distances_are_between_min_and_max_length(node, displacement)) {
+            e_old = node_energy(node);
+            triangulation.move_node(node_id, displacement);
+            e_new = node_energy(node);
+            Real log_proposal_ratio = 0;
+            if (kBT_>0) {
+                vec3<Real> const new_gradient = triangulation.energy_gradient(node_id, energy_derivative_function(triangulation, prms));
+                vec3<Real> const forward_noise = displacement - time_step*old_force;
+                vec3<Real> const backward_noise = time_step*new_gradient - displacement;
+                log_proposal_ratio = (forward_noise.norm_square() - backward_noise.norm_square())/(4*time_step*kBT_);
+            }
+            if (move_needs_undoing(log_proposal_ratio)) {triangulation.move_node(node_id, -displacement); ++move_back;}
+        }else{++bond_length_move_rejection;}
+    }
+
+    //! Provide the total energy of the triangulation, which is needed by the Hamiltonian Monte Carlo updater.
+    /**
+     * @param total_energy_function_inp A c++ function that returns the energy of the whole triangulation. It must be
+     * consistent with the energy derivatives that are provided by set_energy_derivative_function().
+     * @see hamiltonian_MC_updater(Real, unsigned)
+     */
+    void set_total_energy_function(std::function<Real(fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)> total_energy_function_inp)
+    {
+        total_energy_function = std::move(total_energy_function_inp);
+    }
+
+    //! Attempt a Hamiltonian Monte Carlo step, which moves all nodes of the triangulation at once.
+    /**
+     * Every node gets a random momentum, drawn from the Maxwell-Boltzmann distribution at the temperature of the updater
+     * with unit mass, and all nodes are integrated together for `n_leapfrog_steps` steps of the velocity Verlet algorithm,
+     * with the forces from Triangulation::energy_gradient. The whole trajectory is then accepted with the
+     * [Hamiltonian Monte Carlo](https://en.wikipedia.org/wiki/Hamiltonian_Monte_Carlo) probability
+     * \f$\min\left(1, e^{-\Delta H/k_BT}\right)\f$, where \f$H\f$ is the sum of the total energy
+     * (see set_total_energy_function()) and the kinetic energy. A rejected trajectory moves every node back to where it started.
+     *
+     * The connectivity of the triangulation does not change during the trajectory, so bond flips should be interleaved
+     * with the trajectories, as in hamiltonian_sweep(). Every integration step moves all nodes at once with
+     * Triangulation::move_nodes. The step is checked against the same bond length and overlap constraints as
+     * move_MC_updater(), taking the displacements of both nodes of each pair into account, and a violation rejects the whole trajectory.
+     * Hence, the trajectories are only efficient if the bonds of the triangulation are not pressed against the
+     * bond length limits of the updater.
+     * The boundary nodes of a planar triangulation do not move during the trajectory.
+     *
+     * Since all nodes move at once, long wavelength undulations decorrelate much faster than with single node moves.
+     * A good time step leads to an acceptance rate of about 60 to 90 percent.
+     * @param time_step time step of the integrator, in units of length per square root of energy.
+     * @param n_leapfrog_steps number of integration steps of the trajectory.
+     */
+    void hamiltonian_MC_updater(Real time_step, unsigned n_leapfrog_steps)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::hamiltonian_MC_updater");
+        ++trajectory_attempt;
+        update_displacement_classes();
+        Index const n_nodes = static_cast<Index>(triangulation.size());
+        trajectory_start_pos_.resize(n_nodes);
+        momenta_.assign(n_nodes, vec3<Real>{0, 0, 0});
+        energy_gradients_.assign(n_nodes, vec3<Real>{0, 0, 0});
+        node_displacements_.assign(n_nodes, vec3<Real>{0, 0, 0});
+        trajectory_node_ids_.resize(n_nodes);
+        std::iota(trajectory_node_ids_.begin(), trajectory_node_ids_.end(), Index(0));
+        Real const momentum_amplitude = std::sqrt(kBT_);
+        for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+            trajectory_start_pos_[node_id] = triangulation[node_id].pos;
+            if (!is_boundary_node_[node_id]) {
+                momenta_[node_id] = momentum_amplitude*vec3<Real>{std_normal_distr(rng), std_normal_distr(rng), std_normal_distr(rng)};
+            }
+        }
+        e_old = total_energy_function(triangulation, prms) + kinetic_energy();
+
+        update_energy_gradients();
+        for (unsigned step = 0; step<n_leapfrog_steps; ++step) {
+            for (Index node_id = 0; node_id<n_nodes; ++node_id) { momenta_[node_id] -= (time_step/2)*energy_gradients_[node_id]; }
+            for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+                if (!is_boundary_node_[node_id]) { node_displacements_[node_id] = time_step*momenta_[node_id]; }
+            }
+            for (Index node_id = 0; node_id<n_nodes; ++node_id) {
+                if (!is_boundary_node_[node_id] && !new_neighbour_distances_are_between_min_and_max_length(triangulation[node_id], node_displacements_)) {
+                    ++bond_length_trajectory_rejection;
+                    restore_trajectory_start();
+                    return;
+                }
+            }
+            triangulation.move_nodes(trajectory_node_ids_, node_displacements_);
+            update_energy_gradients();
+            for (Index node_id = 0; node_id<n_nodes; ++node_id) { momenta_[node_id] -= (time_step/2)*energy_gradients_[node_id]; }
+        }
+        std::fill(node_displacements_.begin(), node_displacements_.end(), vec3<Real>{0, 0, 0});
+
+        e_new = total_energy_function(triangulation, prms) + kinetic_energy();
+        if (move_needs_undoing()) {
+            ++trajectory_back;
+            restore_trajectory_start();
+        }
+    }
+
+    //! Perform one Hamiltonian Monte Carlo trajectory, followed by a flip attempt on every node.
+    /**
+     * The flips are attempted in a random order.
+     * @param time_step same as in hamiltonian_MC_updater().
+     * @param n_leapfrog_steps same as in hamiltonian_MC_updater().
+     */
+    void hamiltonian_sweep(Real time_step, unsigned n_leapfrog_steps)
+    {
+        hamiltonian_MC_updater(time_step, n_leapfrog_steps);
+        if (sweep_order_.size()!=triangulation.size()) {
+            sweep_order_.resize(triangulation.size());
+            std::iota(sweep_order_.begin(), sweep_order_.end(), Index(0));
+        }
+        std::shuffle(sweep_order_.begin(), sweep_order_.end(), rng);
+        for (Index node_id: sweep_order_) {
+            flip_MC_updater(triangulation[node_id]);
+        }
+    }
+
+    //! Attempt a rigid translation of a patch of nodes as a single Monte Carlo step.
+    /**
+     * Collective moves displace many nodes at once and are accepted or rejected as a whole with the
+     * [Metropolis algorithm](https://en.wikipedia.org/wiki/Metropolis-Hastings_algorithm). The geometry of the triangulation
+     * is updated with a single call of Triangulation::move_nodes, and the energy is evaluated once before and once after
+     * the move. If a total energy function was provided with set_total_energy_function(), it is used for the energy of the
+     * collective moves. Otherwise, the energy function of the updater is evaluated on the first node of the move, which is
+     * only correct if the energy function returns the energy of the whole triangulation, as in the demos.
+     * Every pair of nodes that contains a moved node is checked against the bond length and overlap constraints of
+     * move_MC_updater(), and a violation rejects the move.
+     *
+     * The proposal is symmetric if the displacement is drawn from a distribution that is symmetric under \f$\vec{d}\to-\vec{d}\f$.
+     * @param patch ids of the nodes that are moved together, for example from Triangulation::node_patch.
+     * @param displacement 3D vector by which every node of the patch is displaced.
+     */
+    void patch_translation_MC_updater(std::vector<Index> const& patch, fp::vec3<Real> const& displacement)
+    {
+        collective_move_ids_ = patch;
+        collective_move_displacements_.assign(patch.size(), displacement);
+        collective_move_MC_updater();
+    }
+
+    //! Attempt a rigid rotation of a patch of nodes around its centroid as a single Monte Carlo step.
+    /**
+     * See patch_translation_MC_updater() for the treatment of collective moves.
+     * The proposal is symmetric if the angle is drawn from a distribution that is symmetric under \f$\phi\to-\phi\f$.
+     * @param patch ids of the nodes that are rotated together.
+     * @param axis rotation axis. It does not need to be normalized, but it can not be zero.
+     * @param angle rotation angle in radians, with the right-hand rule around `axis`.
+     */
+    void patch_rotation_MC_updater(std::vector<Index> const& patch, fp::vec3<Real> axis, Real angle)
+    {
+        collective_move_ids_ = patch;
+        collective_move_displacements_.resize(patch.size());
+        if (patch.empty()) { return collective_move_MC_updater(); }
+        axis.normalize();
+        vec3<Real> centroid{0, 0, 0};
+        for (Index node_id: patch) { centroid += triangulation[node_id].pos; }
+        centroid = centroid/static_cast<Real>(patch.size());
+        Real const cos_angle = std::cos(angle), sin_angle = std::sin(angle);
+        for (std::size_t i = 0; i<patch.size(); ++i) {
+            vec3<Real> const arm = triangulation[patch[i]].pos - centroid;
+            vec3<Real> const rotated_arm = cos_angle*arm + sin_angle*vec3<Real>::cross(axis, arm) + ((1 - cos_angle)*axis.dot(arm))*axis;
+            collective_move_displacements_[i] = rotated_arm - arm;
+        }
+        collective_move_MC_updater();
+    }
+
+    //! Attempt a long wavelength undulation of a planar triangulation as a single Monte Carlo step.
+    /**
+     * Every bulk node is displaced along the `z` axis by \f$A\cos(k_x x + k_y y + \varphi)\f$, where \f$x, y\f$ are the
+     * coordinates of the node. The boundary nodes do not move.
+     * See patch_translation_MC_updater() for the treatment of collective moves.
+     * The proposal is symmetric if the amplitude is drawn from a distribution that is symmetric under \f$A\to-A\f$.
+     * @param k_x `x` component of the wave vector of the mode.
+     * @param k_y `y` component of the wave vector of the mode.
+     * @param amplitude amplitude \f$A\f$ of the displacement.
+     * @param phase phase \f$\varphi\f$ of the mode.
+     */
+    void fourier_mode_MC_updater(Real k_x, Real k_y, Real amplitude, Real phase = 0)
+    {
+        static_assert(triangulation_type==EXPERIMENTAL_PLANAR_TRIANGULATION, "Fourier mode moves are only implemented for planar triangulations.");
+        update_displacement_classes();
+        collective_move_ids_.clear();
+        collective_move_displacements_.clear();
+        for (auto const& node: triangulation.nodes()) {
+            if (is_boundary_node_[node.id]) { continue; }
+            collective_move_ids_.push_back(node.id);
+            collective_move_displacements_.push_back(vec3<Real>{0, 0, amplitude*std::cos(k_x*node.pos[0] + k_y*node.pos[1] + phase)});
+        }
+        collective_move_MC_updater();
+    }
+
+    //! Attempt a rescaling of the whole triangulation around its mass center as a single Monte Carlo step.
+    /**
+     * Every node is moved to \f$\vec{c} + e^{\lambda}(\vec{r}-\vec{c})\f$, where \f$\vec{c}\f$ is the mass center of
+     * the triangulation (see Triangulation::calculate_mass_center). The move changes the volume of the configuration space
+     * of the \f$N\f$ nodes by the factor \f$e^{3(N-1)\lambda}\f$, which is included in the acceptance probability with
+     * move_needs_undoing(Real). The proposal is then symmetric if \f$\lambda\f$ is drawn from a distribution that is
+     * symmetric under \f$\lambda\to-\lambda\f$.
+     * See patch_translation_MC_updater() for the treatment of collective moves.
+     * @param log_scale the logarithm \f$\lambda\f$ of the scaling factor.
+     */
+    void rescaling_MC_updater(Real log_scale)
+    {
+        static_assert(triangulation_type==SPHERICAL_TRIANGULATION, "Rescaling moves are only implemented for spherical triangulations.");
+        vec3<Real> const mass_center = triangulation.calculate_mass_center();
+        Real const stretch = std::exp(log_scale) - 1;
+        collective_move_ids_.resize(triangulation.size());
+        collective_move_displacements_.resize(triangulation.size());
+        for (auto const& node: triangulation.nodes()) {
+            collective_move_ids_[node.id] = node.id;
+            collective_move_displacements_[node.id] = stretch*(node.pos - mass_center);
+        }
+        Real const n_nodes = static_cast<Real>(triangulation.size());
+        collective_move_MC_updater(3*(n_nodes - 1)*log_scale);
+    }
+
     //! Attempt a flip Monte Carlo Step.
     /**
      * A flip step is attempted between a specified node and one of its randomly chosen next neighbors.
@@ -193,13 +1313,14 @@ public:
      */
     void flip_MC_updater(fp::Node<Real, Index> const& node)
     {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::flip_MC_updater");
         ++flip_attempt;
-        e_old = energy_function(node, triangulation, prms);
-        Index number_nn_ids = node.nn_ids.size();
+        e_old = node_energy(node);
+        Index number_nn_ids = static_cast<Index>(node.nn_ids.size());
         Index nn_id = node.nn_ids[std::uniform_int_distribution<Index>(0, number_nn_ids-1)(rng)];
         auto bfd = triangulation.flip_bond(node.id, nn_id, min_bond_length_square, max_bond_length_square);
         if (bfd.flipped) {
-            e_new = energy_function(node, triangulation, prms);
+            e_new = node_energy(node);
             if (move_needs_undoing()) { triangulation.unflip_bond(node.id, nn_id, bfd); ++flip_back;}
         }else{++bond_length_flip_rejection;}
     }
@@ -217,17 +1338,57 @@ public:
      */
     void flip_MC_updater(fp::Node<Real, Index> const& node, Index id_in_nn_ids)
     {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::flip_MC_updater");
         ++flip_attempt;
-        e_old = energy_function(node, triangulation, prms);
-        Index number_nn_ids = node.nn_ids.size();
+        e_old = node_energy(node);
 //        Index nn_id = index_in_nn_ids;//node.nn_ids[std::uniform_int_distribution<Index>(0, number_nn_ids-1)(rng)];
         auto bfd = triangulation.flip_bond(node.id, id_in_nn_ids, min_bond_length_square, max_bond_length_square);
         if (bfd.flipped) {
-            e_new = energy_function(node, triangulation, prms);
+            e_new = node_energy(node);
             if (move_needs_undoing()) { triangulation.unflip_bond(node.id, id_in_nn_ids, bfd); ++flip_back;}
         }else{++bond_length_flip_rejection;}
     }
 
+    //! Draw the random numbers of the Metropolis decisions in batches, and compare logarithms instead of Boltzmann factors.
+    /**
+     * By default, every uphill move draws a uniform random number \f$u\f$ and is rejected if \f$u>e^{-\Delta E/k_BT}\f$.
+     * With a batch size larger than zero, the uniform numbers are drawn from the random number engine `batch_size` at a
+     * time, and their logarithms are computed in one vectorized loop with approximate_log(). A move is then rejected if
+     * \f$k_BT\ln u>-\Delta E\f$, which is the same decision without an exponential per move. The decisions have the same statistics as before, but
+     * since the numbers are drawn ahead of time, the sequence of random numbers and therefore the trajectory differ from
+     * the default for the same seed.
+     * @param batch_size number of uniform numbers per batch. `0` switches batches off.
+     */
+    void set_log_uniform_batch_size(std::size_t batch_size)
+    {
+        batch_uniforms_.assign(batch_size, 0);
+        batch_log_uniforms_.assign(batch_size, 0);
+        next_batch_uniform_ = batch_size;
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] std::size_t log_uniform_batch_size() const
+    {
+        return batch_uniforms_.size();
+    }
+
+    //! Largest energy increase \f$E_{new}-E_{old}\f$ that the next Metropolis decision accepts.
+    /**
+     * The uniform random number of the next call of move_needs_undoing() is drawn in advance, and the threshold
+     * \f$-k_BT\ln u\f$ is returned. Every energy increase above the threshold is rejected by the next decision, so the
+     * evaluation of an energy can stop as soon as a lower bound of the energy increase exceeds it. Repeated calls before
+     * the decision return the same threshold. With a proposal ratio, see move_needs_undoing(Real), the threshold is
+     * shifted by \f$k_BT\ln\left(q(x|x')/q(x'|x)\right)\f$. At zero temperature the threshold is `0`.
+     */
+    Real metropolis_threshold()
+    {
+        if (kBT_<=0) { return 0; }
+        if (!drawn_log_uniform_) {
+            drawn_log_uniform_ = std::log(batch_uniforms_.empty() ? unif_distr_on_01(rng) : batch_uniforms_[next_batch_index()]);
+        }
+        return -kBT_*(*drawn_log_uniform_);
+    }
+
     //! Reset the temperature of the Monte Carlo updater, at which the Boltzmann weights are evaluated.
     void reset_kBT(Real kBT){
         /**
@@ -238,6 +1399,258 @@ public:
         kBT_=kBT;
     }
 
+    //! Attach a temperature schedule to the sweep driver.
+    /**
+     * From now on, sweep() sets the temperature from the schedule at the beginning of every sweep, which overrides
+     * any temperature that was set with reset_kBT().
+     * @param schedule the annealing schedule.
+     */
+    void set_annealing_schedule(AnnealingSchedule<Real> const& schedule)
+    {
+        annealing_schedule_ = schedule;
+    }
+
+    //! Detach the temperature schedule. The temperature stays at its current value.
+    void clear_annealing_schedule()
+    {
+        annealing_schedule_.reset();
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] std::optional<AnnealingSchedule<Real>> const& annealing_schedule() const
+    {
+        return annealing_schedule_;
+    }
+
+    //! Reset the size of the random displacements that are attempted by sweep().
+    /**
+     * @param linear_displacement the displacement of a node in each direction is drawn uniformly from
+     * `[-linear_displacement, linear_displacement]`. This sets the displacement of all node classes.
+     */
+    void reset_linear_displacement(Real linear_displacement)
+    {
+        linear_displacements_ = {linear_displacement, linear_displacement};
+    }
+
+    //! Reset the size of the random displacements of one node class.
+    /**
+     * @param linear_displacement the displacement of a node in each direction is drawn uniformly from
+     * `[-linear_displacement, linear_displacement]`.
+     * @param displacement_class the class of nodes for which the displacement is set.
+     */
+    void reset_linear_displacement(Real linear_displacement, DisplacementClass displacement_class)
+    {
+        linear_displacements_[displacement_class] = linear_displacement;
+    }
+
+    //! @getterFunctionStub
+    /**
+     * @param displacement_class the class of nodes. Triangulations without a boundary only use BULK_NODE_DISPLACEMENT.
+     * @return the current displacement amplitude of the class.
+     */
+    [[nodiscard]] Real linear_displacement(DisplacementClass displacement_class = BULK_NODE_DISPLACEMENT) const
+    {
+        return linear_displacements_[displacement_class];
+    }
+
+    //! Let sweep() adapt the displacement amplitudes towards a target move acceptance rate.
+    /**
+     * This is meant for the equilibration phase of a simulation.
+     * After each of the following `n_adaptation_sweeps` sweeps, the displacement amplitude of every node class is
+     * multiplied by \f$e^{g(r-r_t)}\f$, where \f$r\f$ is the move acceptance rate of the class in that sweep,
+     * \f$r_t\f$ the target rate and \f$g\f$ the adaptation gain.
+     * A move counts as rejected if it was undone (move_back_count()) or refused because of the bond length
+     * constraints (bond_length_move_rejection_count()).
+     * The amplitudes never exceed the maximal bond length.
+     * Afterwards, the amplitudes are frozen, so that the production run samples with a fixed proposal distribution.
+     * @param target_move_acceptance_rate the acceptance rate, between 0 and 1, that the adaptation aims for.
+     * @param n_adaptation_sweeps number of sweeps after which the amplitudes are frozen.
+     * @param adaptation_gain how strongly the amplitudes react to the deviation from the target rate.
+     */
+    void adapt_linear_displacement(Real target_move_acceptance_rate, unsigned long n_adaptation_sweeps, Real adaptation_gain = 1)
+    {
+        target_move_acceptance_rate_ = target_move_acceptance_rate;
+        remaining_adaptation_sweeps_ = n_adaptation_sweeps;
+        displacement_adaptation_gain_ = adaptation_gain;
+    }
+
+    //! Stop adapting the displacement amplitudes, e.g. when the production run starts early.
+    void freeze_linear_displacement()
+    {
+        remaining_adaptation_sweeps_ = 0;
+    }
+
+    //! @getterFunctionStub
+    /**
+     * @return `true` while sweep() still adapts the displacement amplitudes.
+     */
+    [[nodiscard]] bool linear_displacement_is_adapting() const
+    {
+        return remaining_adaptation_sweeps_>0;
+    }
+
+    //! Perform one Monte Carlo sweep.
+    /**
+     * If an annealing schedule is attached, the temperature is first updated from the schedule.
+     * Then a move is attempted on every node of the triangulation, with a displacement drawn from a cube of side length
+     * `2*linear_displacement(c)`, where `c` is the class of the node, and afterwards a flip is attempted on every node.
+     * The nodes are visited in a random order, which is reshuffled before the flips.
+     * This is the same update scheme that is used in the demos.
+     * The moves use staged_move_MC_updater() if the updater has a staged energy, and multiple_try_move_MC_updater() if
+     * set_multiple_try_count() requested more than one try.
+     */
+    void sweep()
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::sweep");
+        SweepStatistics statistics = begin_sweep();
+        std::array<std::uniform_real_distribution<Real>, 2> displacement_distrs{
+                std::uniform_real_distribution<Real>(-linear_displacements_[BULK_NODE_DISPLACEMENT], linear_displacements_[BULK_NODE_DISPLACEMENT]),
+                std::uniform_real_distribution<Real>(-linear_displacements_[BOUNDARY_NODE_DISPLACEMENT], linear_displacements_[BOUNDARY_NODE_DISPLACEMENT])};
+        for (Index node_id: sweep_order_) {
+            DisplacementClass const node_class = node_displacement_class(node_id);
+            auto& displacement_distr = displacement_distrs[node_class];
+            unsigned long const rejections_before = move_back + bond_length_move_rejection;
+            if (multiple_tries_>1) { multiple_try_move_MC_updater(triangulation[node_id], multiple_tries_); }
+            else {
+                vec3<Real> const displacement{displacement_distr(rng), displacement_distr(rng), displacement_distr(rng)};
+                if (staged_energy_terms_.empty()) { move_MC_updater(triangulation[node_id], displacement); }
+                else { staged_move_MC_updater(triangulation[node_id], displacement); }
+            }
+            ++statistics.class_attempts[node_class];
+            statistics.class_accepted[node_class] += (move_back + bond_length_move_rejection==rejections_before);
+        }
+        std::shuffle(sweep_order_.begin(), sweep_order_.end(), rng);
+        for (Index node_id: sweep_order_) {
+            flip_MC_updater(triangulation[node_id]);
+        }
+        finish_sweep(statistics);
+    }
+
+    //! Perform `n_sweeps` Monte Carlo sweeps.
+    /**
+     * @param n_sweeps number of sweeps.
+     * @see sweep()
+     */
+    void sweep(unsigned long n_sweeps)
+    {
+        for (unsigned long sweep_id = 0; sweep_id<n_sweeps; ++sweep_id) { sweep(); }
+    }
+
+    //! Provide the energy of the triangulation as a function of its global geometry, which is needed by parallel_sweep().
+    /**
+     * @param geometry_energy_function_inp A c++ function that returns the system energy for the global area, volume and
+     * unit bending energy that are stored in a Geometry struct. It must be equivalent to the energy function of the
+     * updater, which is only possible for energies that depend on the node positions exclusively through the global
+     * geometry, like the energies in the demos. It is called concurrently by the fast mode of parallel_sweep().
+     */
+    void set_geometry_energy_function(std::function<Real(fp::Geometry<Real, Index> const&, EnergyFunctionParameters const&)> geometry_energy_function_inp)
+    {
+        geometry_energy_function = std::move(geometry_energy_function_inp);
+    }
+
+    //! Reset the seed of the counter-based random numbers of parallel_sweep().
+    /**
+     * If no seed is set, the first parallel sweep draws one from the random number engine of the updater.
+     * @param seed key of the Philox4x32 streams.
+     */
+    void reset_parallel_seed(std::uint64_t seed)
+    {
+        parallel_seed_ = seed;
+    }
+
+    //! Perform one Monte Carlo sweep, whose node moves are evaluated in parallel.
+    /**
+     * Like sweep(), this attempts a move on every node and then a flip on every node, with the same displacement
+     * amplitudes, annealing schedule, adaptation and counters. The energy is evaluated with the function that is provided
+     * by set_geometry_energy_function(), which has to be set before.
+     *
+     * The nodes are colored such that the moves of the nodes of a color do not change each other's local geometry
+     * (see move_color_count()). The colors are moved one after the other. For every color, the
+     * displacements, the bond length and overlap constraints and the changes of the global geometry are evaluated in
+     * parallel by the threads of the pool, in chunks of #parallel_sweep_chunk_size nodes, without changing the triangulation.
+     * Then the moves are accepted or rejected, depending on the `mode`, and the accepted moves are performed at once with
+     * Triangulation::move_nodes, which reduces the changes of the global geometry with a fixed tree.
+     * The rare moves of nodes that have a Verlet neighbor of the same color within reach are evaluated and performed
+     * afterwards on the calling thread, in the order of the node ids, since their overlap constraints depend on each other.
+     * The flips change the connectivity and are attempted one after the other in a random order, on the calling thread.
+     *
+     * In the DETERMINISTIC_PARALLEL_SWEEP mode, the moves of a color are accepted in the order of the node ids with the
+     * Metropolis criterion of a serial sweep. Since the two-rings of the nodes of a color do not overlap, this samples
+     * the same distribution as sweep(). All random numbers, including the flip order, are drawn from Philox4x32 streams
+     * that are keyed by the seed (see reset_parallel_seed()), the sweep count and the node id, so the result is bitwise
+     * identical for any number of threads, and does not depend on the standard library either.
+     * In the FAST_PARALLEL_SWEEP mode, the moves are accepted in the same way, so it samples the same distribution, but
+     * the random numbers of the proposals are drawn from one Philox4x32 stream per thread, which saves the set up of a
+     * keyed stream per node. Which node gets which numbers depends on the scheduling of the threads, so the result is
+     * not reproducible.
+     *
+     * @param pool thread pool that evaluates the moves.
+     * @param mode one of the modes of the ParallelSweepMode enum.
+     */
+    void parallel_sweep(ThreadPool& pool, ParallelSweepMode mode = DETERMINISTIC_PARALLEL_SWEEP)
+    {
+        FLIPPY_PROFILE_SCOPE("MonteCarloUpdater::parallel_sweep");
+        if (!parallel_seed_) { parallel_seed_ = std::uniform_int_distribution<std::uint64_t>()(rng); }
+        SweepStatistics statistics = begin_sweep();
+        update_move_colors();
+        for (auto const& color: move_colors_) { parallel_move_color(color, pool, mode, statistics); }
+
+        std::iota(sweep_order_.begin(), sweep_order_.end(), Index(0));
+        Philox4x32 order_engine = keyed_engine(0, FLIP_ORDER_STREAM);
+        for (std::size_t i = sweep_order_.size(); i>1; --i) {
+            std::size_t const j = std::min(i - 1, static_cast<std::size_t>(uniform_real<Real>(order_engine)*static_cast<Real>(i)));
+            std::swap(sweep_order_[i - 1], sweep_order_[j]);
+        }
+        for (Index node_id: sweep_order_) { parallel_sweep_flip(node_id); }
+        colored_connectivity_version_ = triangulation.connectivity_version();
+        finish_sweep(statistics);
+    }
+
+    //! Perform `n_sweeps` parallel Monte Carlo sweeps.
+    /**
+     * @param n_sweeps number of sweeps.
+     * @param pool same as in parallel_sweep().
+     * @param mode same as in parallel_sweep().
+     * @see parallel_sweep(ThreadPool&, ParallelSweepMode)
+     */
+    void parallel_sweep(unsigned long n_sweeps, ThreadPool& pool, ParallelSweepMode mode = DETERMINISTIC_PARALLEL_SWEEP)
+    {
+        for (unsigned long sweep_id = 0; sweep_id<n_sweeps; ++sweep_id) { parallel_sweep(pool, mode); }
+    }
+
+    //! @getterFunctionStub
+    /**
+     * @return Number of colors of the last parallel sweep, i.e. the number of parallel steps of its node moves.
+     */
+    [[nodiscard]] std::size_t move_color_count() const
+    {
+        return move_colors_.size();
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long sweep_count() const
+    {
+        return sweep_count_;
+    }
+
+    //! @getterFunctionStub
+    /**
+     * @return Fraction of the moves of the last sweep that were accepted.
+     */
+    [[nodiscard]] Real last_sweep_move_acceptance_rate() const
+    {
+        return last_sweep_move_acceptance_rate_;
+    }
+
+    //! @getterFunctionStub
+    /**
+     * @return Fraction of the flips of the last sweep that were accepted.
+     */
+    [[nodiscard]] Real last_sweep_flip_acceptance_rate() const
+    {
+        return last_sweep_flip_acceptance_rate_;
+    }
+
     //! @getterFunctionStub
     [[nodiscard]] Real kBT(){
     /**
@@ -248,6 +1661,16 @@ public:
         return kBT_;
     }
     //! @getterFunctionStub
+    /**
+     * @return The minimal allowed distance between two nodes, as provided during the instantiation of the updater.
+     */
+    [[nodiscard]] Real min_bond_length() const { return std::sqrt(min_bond_length_square); }
+    //! @getterFunctionStub
+    /**
+     * @return The maximal allowed bond length, as provided during the instantiation of the updater.
+     */
+    [[nodiscard]] Real max_bond_length() const { return std::sqrt(max_bond_length_square); }
+    //! @getterFunctionStub
     [[nodiscard]] unsigned long move_attempt_count() const {
     /**
      * Every time a move is attempted, a private internal state variable `move_attempt` is incremented by move_MC_updater().
@@ -280,6 +1703,16 @@ public:
      */
         return move_back;
     }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long staged_early_rejection_count() const {
+    /**
+     * Number of moves of staged_move_MC_updater() that were rejected because a lower bound of their energy change
+     * exceeded the threshold of the Metropolis decision. They are also counted by move_back_count().
+     * @return current state of `staged_early_rejection`.
+     * @see staged_move_MC_updater(fp::Node<Real, Index> const&, fp::vec3<Real> const&)
+     */
+        return staged_early_rejection;
+    }
     //!@getterFunctionStub
     [[nodiscard]] unsigned long flip_attempt_count() const {
     /**
@@ -312,6 +1745,58 @@ public:
      */
         return flip_back;
     }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long trajectory_attempt_count() const {
+    /**
+     * Every time a Hamiltonian trajectory is attempted by hamiltonian_MC_updater(), a private internal state variable `trajectory_attempt` is incremented.
+     * @return current state of `trajectory_attempt`.
+     */
+        return trajectory_attempt;
+    }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long bond_length_trajectory_rejection_count() const {
+    /**
+     * Every time a Hamiltonian trajectory is rejected because one of its node moves violated the bond length or overlap constraints, a private internal state variable `bond_length_trajectory_rejection` is incremented by hamiltonian_MC_updater().
+     * @return current state of `bond_length_trajectory_rejection`.
+     */
+        return bond_length_trajectory_rejection;
+    }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long trajectory_back_count() const {
+    /**
+     * Every time a Hamiltonian trajectory is rejected because the energy requirement was not satisfied, a private internal state variable `trajectory_back` is incremented by hamiltonian_MC_updater().
+     * This variable does not track the rejections resulting from bond length restriction violations.
+     * @return current state of `trajectory_back`.
+     * @see bond_length_trajectory_rejection_count()
+     */
+        return trajectory_back;
+    }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long collective_move_attempt_count() const {
+    /**
+     * Every time a collective move is attempted, e.g. by patch_translation_MC_updater() or rescaling_MC_updater(), a private internal state variable `collective_move_attempt` is incremented.
+     * @return current state of `collective_move_attempt`.
+     */
+        return collective_move_attempt;
+    }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long bond_length_collective_move_rejection_count() const {
+    /**
+     * Every time a collective move is rejected because it would violate the bond length or overlap constraints, a private internal state variable `bond_length_collective_move_rejection` is incremented.
+     * @return current state of `bond_length_collective_move_rejection`.
+     */
+        return bond_length_collective_move_rejection;
+    }
+    //! @getterFunctionStub
+    [[nodiscard]] unsigned long collective_move_back_count() const {
+    /**
+     * Every time a collective move is rejected because the energy requirement was not satisfied, a private internal state variable `collective_move_back` is incremented.
+     * This variable does not track the rejections resulting from bond length restriction violations.
+     * @return current state of `collective_move_back`.
+     * @see bond_length_collective_move_rejection_count()
+     */
+        return collective_move_back;
+    }
 
 };
 }
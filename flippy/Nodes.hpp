@@ -5,15 +5,30 @@
  * @brief This file contains the fp::Node and fp::Nodes classes, data structures that represent a single node of the triangulation
  * and the collection of all nodes of the triangulation, respectively.
  */
+#include <cstdint>
 #include <vector>
 #include <unordered_set>
 
-#include "external/json.hpp"
-
 #include "vec3.hpp"
 
 namespace fp {
-using Json = nlohmann::json;
+namespace io {
+struct JsonNodesSerializer;
+}
+
+//! Maps the type of serialized node data to the serializer that reads it.
+/**
+ * The headers of flippy/io specialize this template for their data types, with a member `type` that names the serializer,
+ * e.g. flippy/io/json.hpp for fp::Json. This keeps the core headers independent of the serialization libraries.
+ * @tparam EggData type of the serialized data, like the data created by Nodes::make_data() or Triangulation::make_egg_data().
+ */
+template<typename EggData>
+struct egg_data_serializer{};
+
+//! Types of serialized node data that can be read, because egg_data_serializer is specialized for them.
+template<typename EggData>
+concept egg_data = requires { typename egg_data_serializer<EggData>::type; };
+
 //! A data structure containing all geometric and topological information associated with a node.
 /**
  * This is a DUMB DATA STRUCTURE, meaning that it is not responsible for the coherence of the data it contains.
@@ -245,45 +260,42 @@ struct Nodes
      * @param data_inp A standard vector containing all the nodes that are supposed to create a new Nodes class.
      */
     }    //!< Constructor from a vector.
-    explicit Nodes(Json const& node_dict)
+    Nodes(Nodes const& other):data(other.data)
     {
     /**
-     * Initiating nodes from a JSON object of a node collection.
-     * The nodes in the JSON file must be sequentially numbered from 0 to Number_of_nodes - 1.
-     * @param node_dict JSON object that contains a collection of nodes.
-     * @warning If the JSON object is malformed, then the constructor will fail and propagate a runtime error from the JSON parser.
-     */
-        std::vector<Index> nn_ids_temp, verlet_list_temp;
-        data.resize((node_dict.size()));
-        for (auto const& node: node_dict.items()) {
-            auto const& node_id = node.key();
-            fp::indexing_number auto node_index = static_cast<Index>(std::stol(node_id));
-            auto const& raw_pos = node.value()["pos"];
-            vec3<Real> pos{(Real) raw_pos[0], (Real) raw_pos[1], (Real) raw_pos[2]};
-
-            auto const& raw_curv = node.value()["curvature_vec"];
-            vec3<Real> curvature_vec{(Real) raw_curv[0], (Real) raw_curv[1], (Real) raw_curv[2]};
-            Real unit_bending_energy = node.value()["unit_bending_energy"];
-            Real area = node.value()["area"];
-            Real volume = node.value()["volume"];
-
-            nn_ids_temp = node_dict[node_id]["nn_ids"].get<std::vector<Index>>();
-            verlet_list_temp = node_dict[node_id]["verlet_list"].get<std::vector<Index>>();
-            std::vector<vec3<Real>> nn_distances;
-
-            data[static_cast<size_t>(node_index)] = Node<Real, Index>{
-                    .id{node_index},
-                    .area{area},
-                    .volume{volume},
-                    .unit_bending_energy{unit_bending_energy},
-                    .pos{pos},
-                    .curvature_vec{curvature_vec},
-                    .nn_ids{nn_ids_temp},
-                    .nn_distances{nn_distances},
-                    .verlet_list{verlet_list_temp}
-            };
+     * The copies of the Node::nn_ids and Node::nn_distances vectors get the capacity of the originals, so that the
+     * storage that was reserved with reserve_nn_capacity() survives copies of the nodes, e.g. of a whole triangulation.
+     * @param other nodes that are copied.
+     */
+        keep_nn_capacity_of(other);
+    }    //!< Copy constructor that keeps the reserved next neighbor storage.
+    Nodes& operator=(Nodes const& other)
+    {
+    /**
+     * @param other nodes that are copied.
+     * @return a reference to this node collection.
+     * @see Nodes(Nodes const&)
+     */
+        if (this!=&other) {
+            data = other.data;
+            keep_nn_capacity_of(other);
         }
-    }    //!< Constructor from JSON.
+        return *this;
+    }    //!< Copy assignment that keeps the reserved next neighbor storage.
+    Nodes(Nodes&&) noexcept = default;    //!< Move constructor.
+    Nodes& operator=(Nodes&&) noexcept = default;    //!< Move assignment.
+    template<egg_data EggData>
+    explicit Nodes(EggData const& egg_data)
+    :Nodes(egg_data_serializer<EggData>::type::template read<Real, Index>(egg_data))
+    {
+    /**
+     * Initiating nodes from serialized data of a node collection, like the data that is created by make_data().
+     * The serializer is chosen by the type of the data, see egg_data_serializer. E.g., a JSON object can be read if
+     * flippy/io/json.hpp is included.
+     * @param egg_data serialized data that contains a collection of nodes.
+     * @warning If the data is malformed, then the constructor will fail and propagate a runtime error from the serializer.
+     */
+    }    //!< Constructor from serialized data.
 
     typename std::vector<Node<Real, Index>>::iterator begin()
     {
@@ -518,6 +530,29 @@ struct Nodes
         data[node_id].nn_distances[loc_nn_index]=dist;
     } //!< \overload
 
+    void reserve_nn_capacity(Index capacity){
+    /**
+     * Bond flips constantly add and remove next neighbors. Reserving enough storage up front means that
+     * the Node::nn_ids and Node::nn_distances vectors will not have to re-allocate memory during a simulation,
+     * unless a node gains more than `capacity` next neighbors.
+     * @param capacity Number of next neighbors for which storage is reserved.
+     */
+        for (auto& node: data) {
+            node.nn_ids.reserve(capacity);
+            node.nn_distances.reserve(capacity);
+        }
+    } //!< Reserve storage for `capacity` next neighbors in each node.
+
+private:
+    void keep_nn_capacity_of(Nodes const& other)
+    {
+        for (std::size_t i = 0; i<data.size(); ++i) {
+            data[i].nn_ids.reserve(other.data[i].nn_ids.capacity());
+            data[i].nn_distances.reserve(other.data[i].nn_distances.capacity());
+        }
+    }
+public:
+
     [[nodiscard]] Index size() const { return static_cast<Index>(data.size()); } //!< Size of the Nodes data member. @return Size of the data vector, same as the number of nodes.
 
     Node<Real, Index>& operator[](Index node_id) {
@@ -537,25 +572,23 @@ struct Nodes
         return data.at(node_id);
     } //!< @overload
 
-    [[nodiscard]] Json make_data() const{
-    /**
-     * @return JSON object that represents a serialization of the data contained in Nodes.
-     * This JSON object can later be used to reconstruct the Nodes object.
-     */
-        Json json_data;
-        for (auto& node : data) {
-            json_data[std::to_string(node.id)] = {
-                    {"area", node.area},
-                    {"volume", node.volume},
-                    {"unit_bending_energy", node.unit_bending_energy},
-                    {"pos", {node.pos[0], node.pos[1], node.pos[2]}},
-                    {"curvature_vec", {node.curvature_vec[0], node.curvature_vec[1], node.curvature_vec[2]}},
-                    {"nn_ids", node.nn_ids},
-                    {"verlet_list", node.verlet_list},
-            };
-        }
-        return json_data;
-    } //!< Serialize the Nodes struct to a JSON object.
+    template<typename Serializer = io::JsonNodesSerializer>
+    [[nodiscard]] auto make_data() const{
+    /**
+     * @tparam Serializer One of the serializers of flippy/io, e.g. io::JsonNodesSerializer (the default, which needs
+     * flippy/io/json.hpp) or io::BinaryNodesSerializer (which needs flippy/io/binary.hpp).
+     * @return Serialization of the data contained in Nodes, which can later be used to reconstruct the Nodes object.
+     */
+        return Serializer::write(*this);
+    } //!< Serialize the Nodes struct, by default to a JSON object.
 };
+
+#ifdef FLIPPY_EXTERN_TEMPLATES
+// instantiated once in flippy.cpp, see flippy.hpp
+extern template struct Nodes<double, std::uint32_t>;
+extern template struct Nodes<double, std::uint64_t>;
+extern template struct Nodes<float, std::uint32_t>;
+extern template struct Nodes<float, std::uint64_t>;
+#endif
 }
 #endif //FLIPPY_NODES_HPP
@@ -0,0 +1,219 @@
+#ifndef FLIPPY_REPLICAEXCHANGE_HPP
+#define FLIPPY_REPLICAEXCHANGE_HPP
+/**
+ * @file
+ * @brief This file contains the ReplicaExchange class template, a parallel tempering driver that runs several
+ * triangulations at different temperatures on a thread pool.
+ */
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include "custom_concepts.hpp"
+#include "Triangulation.hpp"
+#include "Ensemble.hpp"
+
+namespace fp {
+
+/**
+ * @brief Driver for [replica exchange](https://en.wikipedia.org/wiki/Parallel_tempering) (parallel tempering)
+ * simulations of triangulated surfaces.
+ *
+ * The driver owns an Ensemble with one replica per temperature. In every exchange round, all replicas are advanced by
+ * the user-provided sweep function on the thread pool of the ensemble, and afterwards swaps between replicas at neighboring
+ * temperatures are proposed. An accepted swap exchanges the temperatures of the two replicas, by resetting the kBT of
+ * their updaters, and the meshes themselves are never copied.
+ *
+ * A swap between the temperature slots `i` and `i+1` is accepted with the probability
+ * \f$\min\left(1, e^{(\beta_i-\beta_{i+1})(E_i-E_{i+1})}\right)\f$, where \f$\beta=1/k_BT\f$ and \f$E_i\f$ is the
+ * total energy of the replica that currently is at the temperature slot `i`.
+ * Even and odd neighbor pairs are proposed in alternating rounds.
+ *
+ * @tparam Real @RealStub
+ * @tparam Index @IndexStub
+ * @tparam EnergyFunctionParameters Same as in MonteCarloUpdater.
+ * @tparam RandomNumberEngine Same as in MonteCarloUpdater. The engine must be constructible from a std::seed_seq.
+ * @tparam triangulation_type One of the types specified by the TriangulationType enum.
+ *
+ * @warning The energy function, the sweep function and the total energy function are called concurrently from
+ * several threads, for different replicas. They must not modify any shared state.
+ */
+template<floating_point_number Real, indexing_number Index, typename EnergyFunctionParameters, typename RandomNumberEngine, TriangulationType triangulation_type>
+class ReplicaExchange
+{
+public:
+    using Ensemble = fp::Ensemble<Real, Index, EnergyFunctionParameters, RandomNumberEngine, triangulation_type>;
+    using Replica = typename Ensemble::Replica;
+    using Updater = typename Ensemble::Updater;
+    using EnergyFunction = typename Ensemble::EnergyFunction;
+    using SweepFunction = typename Ensemble::SweepFunction;
+    using TotalEnergyFunction = std::function<Real(fp::Triangulation<Real, Index, triangulation_type> const&, EnergyFunctionParameters const&)>;
+
+private:
+    EnergyFunctionParameters const& prms_;
+    SweepFunction sweep_;
+    TotalEnergyFunction total_energy_;
+    std::vector<Real> kBTs_;
+    Ensemble ensemble_;
+    std::vector<Real> energies_;
+    std::vector<std::size_t> replica_at_temperature_, temperature_of_replica_;
+    std::vector<std::vector<unsigned long>> swap_attempts_, swap_acceptances_;
+    unsigned long exchange_round_{0};
+    std::mt19937_64 exchange_rng_;
+    std::uniform_real_distribution<Real> unif_distr_on_01{0, 1};
+
+    static std::vector<Real> const& checked_kBTs(std::vector<Real> const& kBTs)
+    {
+        if (kBTs.empty()) { throw std::invalid_argument("A replica exchange needs at least one temperature."); }
+        for (Real kBT: kBTs) {
+            if (!(kBT>0)) { throw std::invalid_argument("All replica exchange temperatures must be positive."); }
+        }
+        return kBTs;
+    }
+
+    void sweep_all_replicas()
+    {
+        ensemble_.for_each_replica([this](Replica& replica, std::size_t replica_id) {
+            sweep_(replica);
+            energies_[replica_id] = total_energy_(replica.triangulation, prms_);
+        });
+    }
+
+    void propose_swaps()
+    {
+        for (std::size_t t = exchange_round_%2; t + 1<kBTs_.size(); t += 2) {
+            std::size_t const r_i = replica_at_temperature_[t], r_j = replica_at_temperature_[t + 1];
+            Real log_acceptance = (1/kBTs_[t] - 1/kBTs_[t + 1])*(energies_[r_i] - energies_[r_j]);
+            ++swap_attempts_[t][t + 1];
+            ++swap_attempts_[t + 1][t];
+            if ((log_acceptance>=0) || (unif_distr_on_01(exchange_rng_)<std::exp(log_acceptance))) {
+                replica_at_temperature_[t] = r_j;
+                replica_at_temperature_[t + 1] = r_i;
+                temperature_of_replica_[r_i] = t + 1;
+                temperature_of_replica_[r_j] = t;
+                ensemble_.replica(r_i).updater.reset_kBT(kBTs_[t + 1]);
+                ensemble_.replica(r_j).updater.reset_kBT(kBTs_[t]);
+                ++swap_acceptances_[t][t + 1];
+                ++swap_acceptances_[t + 1][t];
+            }
+        }
+        ++exchange_round_;
+    }
+
+public:
+    /**
+     * @param prototype Triangulation that is copied into every replica.
+     * @param kBTs Temperatures of the replicas. Replica `i` starts at `kBTs[i]`. Swaps are proposed between neighboring
+     * entries of this vector, so it should be sorted. All temperatures must be positive.
+     * @param prms_inp The instance of the struct that contains the parameters of the system energy. It is shared by all replicas.
+     * @param energy_function Energy function that is used by the updaters of all replicas.
+     * @param min_bond_length Same as in MonteCarloUpdater.
+     * @param max_bond_length Same as in MonteCarloUpdater.
+     * @param sweep User-defined function that advances a single replica, e.g. by attempting a move and a flip on every node.
+     * It is called once per replica in every exchange round.
+     * @param total_energy Function that evaluates the total energy of a triangulation. It is used for the swap acceptance.
+     * @param seed Seed from which the random number engines of all replicas and of the swap proposals are derived.
+     * The replica engines are seeded in the same way as in Ensemble, and the swap proposals use the stream that
+     * follows the last replica.
+     * @param n_threads Number of threads that the replicas are distributed on. If set to zero, the number of
+     * hardware threads is used. The pool never has more threads than there are replicas.
+     */
+    ReplicaExchange(fp::Triangulation<Real, Index, triangulation_type> const& prototype, std::vector<Real> kBTs,
+                    EnergyFunctionParameters const& prms_inp, EnergyFunction const& energy_function,
+                    Real min_bond_length, Real max_bond_length,
+                    SweepFunction sweep, TotalEnergyFunction total_energy,
+                    std::uint64_t seed, unsigned n_threads = 0)
+            :prms_(prms_inp), sweep_(std::move(sweep)), total_energy_(std::move(total_energy)),
+             kBTs_(checked_kBTs(kBTs)),
+             ensemble_(prototype, kBTs_.size(), prms_inp, energy_function, min_bond_length, max_bond_length, seed, n_threads)
+    {
+        std::size_t const n_replicas = kBTs_.size();
+        for (std::size_t replica_id = 0; replica_id<n_replicas; ++replica_id) {
+            ensemble_.replica(replica_id).updater.reset_kBT(kBTs_[replica_id]);
+            energies_.push_back(total_energy_(ensemble_.replica(replica_id).triangulation, prms_));
+            replica_at_temperature_.push_back(replica_id);
+            temperature_of_replica_.push_back(replica_id);
+        }
+        std::seed_seq exchange_seeds = make_replica_seed_seq(seed, n_replicas);
+        exchange_rng_.seed(exchange_seeds);
+        swap_attempts_.assign(n_replicas, std::vector<unsigned long>(n_replicas, 0));
+        swap_acceptances_.assign(n_replicas, std::vector<unsigned long>(n_replicas, 0));
+    }
+
+    //! Runs exchange rounds.
+    /**
+     * Every round consists of one call of the sweep function per replica, which are executed in parallel, followed by
+     * swap proposals between neighboring temperatures.
+     * The result only depends on the seed, and not on the number of threads.
+     * @param n_rounds number of exchange rounds.
+     */
+    void run(unsigned long n_rounds)
+    {
+        for (unsigned long round = 0; round<n_rounds; ++round) {
+            sweep_all_replicas();
+            propose_swaps();
+        }
+    }
+
+    //! Number of replicas.
+    [[nodiscard]] std::size_t size() const { return ensemble_.size(); }
+
+    //! Number of threads that the replicas are distributed on.
+    [[nodiscard]] unsigned n_threads() const { return ensemble_.n_threads(); }
+
+    //! Number of exchange rounds that were run so far.
+    [[nodiscard]] unsigned long exchange_round_count() const { return exchange_round_; }
+
+    //! Temperatures of the ensemble, in the order of the temperature slots.
+    [[nodiscard]] std::vector<Real> const& kBTs() const { return kBTs_; }
+
+    //! Access to a replica by its id. The id of a replica does not change when temperatures are swapped.
+    Replica& replica(std::size_t replica_id) { return ensemble_.replica(replica_id); }
+    //! @copydoc replica(std::size_t)
+    Replica const& replica(std::size_t replica_id) const { return ensemble_.replica(replica_id); }
+
+    //! Total energy of a replica, evaluated at the end of its last sweep.
+    [[nodiscard]] Real energy_of_replica(std::size_t replica_id) const { return energies_.at(replica_id); }
+
+    //! Id of the replica that currently is at the temperature `kBTs()[temperature_id]`.
+    [[nodiscard]] std::size_t replica_at_temperature(std::size_t temperature_id) const { return replica_at_temperature_.at(temperature_id); }
+
+    //! Index in `kBTs()` of the temperature at which the replica with id `replica_id` currently is.
+    [[nodiscard]] std::size_t temperature_of_replica(std::size_t replica_id) const { return temperature_of_replica_.at(replica_id); }
+
+    //! @getterFunctionStub
+    /**
+     * @return Matrix of the number of proposed swaps, where the entry `[i][j]` counts the swaps between the temperature
+     * slots `i` and `j`. The matrix is symmetric and only the entries next to the diagonal can be non-zero.
+     */
+    [[nodiscard]] std::vector<std::vector<unsigned long>> const& swap_attempt_count() const { return swap_attempts_; }
+
+    //! @getterFunctionStub
+    /**
+     * @return Matrix of the number of accepted swaps, with the same layout as swap_attempt_count().
+     */
+    [[nodiscard]] std::vector<std::vector<unsigned long>> const& swap_acceptance_count() const { return swap_acceptances_; }
+
+    //! Ratio of accepted and proposed swaps between every pair of temperature slots.
+    /**
+     * @return Matrix with the same layout as swap_attempt_count(). Entries for which no swap was proposed are zero.
+     */
+    [[nodiscard]] std::vector<std::vector<Real>> acceptance_matrix() const
+    {
+        std::vector<std::vector<Real>> ratios(size(), std::vector<Real>(size(), 0));
+        for (std::size_t i = 0; i<size(); ++i) {
+            for (std::size_t j = 0; j<size(); ++j) {
+                if (swap_attempts_[i][j]>0) {
+                    ratios[i][j] = static_cast<Real>(swap_acceptances_[i][j])/static_cast<Real>(swap_attempts_[i][j]);
+                }
+            }
+        }
+        return ratios;
+    }
+};
+
+}
+#endif //FLIPPY_REPLICAEXCHANGE_HPP
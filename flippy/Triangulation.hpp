@@ -6,9 +6,16 @@
  */
 #include<optional>
 #include <set>
+#include <span>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <numeric>
 #include "Nodes.hpp"
 #include "vec3.hpp"
 #include "utilities/utils.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/profiler.hpp"
 #include "Triangulator.hpp"
 
 /**
@@ -45,6 +52,8 @@ namespace fp {
  */
 //! a node needs to have more than the cutoff number of bonds to be allowed to donate one
 static constexpr int BOND_DONATION_CUTOFF = 4;
+//! number of next neighbors for which storage is reserved in each node, s.t. bond flips do not cause re-allocations
+static constexpr int RESERVED_NN_CAPACITY = 12;
 /**@}*/
 
 //! A helper struct; keeps track of bond flips.
@@ -242,10 +251,78 @@ struct Geometry
 
 };
 
+//! Gradients of the global geometric quantities of a triangulation with respect to the position of a single node.
+/**
+ * The data members mirror the data members of fp::Geometry.
+ * @tparam Real @RealStub
+ * @see Triangulation::geometry_gradient(Index)
+ */
+template<floating_point_number Real>
+struct GeometryGradient
+{
+  vec3<Real> area; //!< Gradient of the total area of the triangulation.
+  vec3<Real> volume; //!< Gradient of the total volume of the triangulation.
+  vec3<Real> unit_bending_energy; //!< Gradient of the total unit bending energy of the triangulation.
+};
+
 /**
  * @GlobalsStub
  * @{
  */
+//! Index type that is used to store the ids inside a CompactVerletList.
+/**
+ * If the `Index` type of the triangulation is wider than 32 bits, the ids in the compact Verlet list are stored as
+ * 32-bit integers, which halves the memory footprint of the list. Defining the `FLIPPY_FULL_WIDTH_VERLET_INDICES` macro
+ * before including flippy switches this off and the ids are stored with the full width of `Index`.
+ * @tparam Index @IndexStub
+ */
+#ifdef FLIPPY_FULL_WIDTH_VERLET_INDICES
+template<indexing_number Index>
+using verlet_index_t = Index;
+#else
+template<indexing_number Index>
+using verlet_index_t = std::conditional_t<(sizeof(Index)>sizeof(std::uint32_t)), std::uint32_t, Index>;
+#endif
+/**@}*/
+
+//! A [Verlet list](https://en.wikipedia.org/wiki/Verlet_list) of all nodes, packed into a single array.
+/**
+ * The Verlet neighbors of all nodes are stored in the compressed sparse row (CSR) format:
+ * the ids of the Verlet neighbors of the node `i` are stored in #neighbour_ids between the positions `offsets[i]`
+ * and `offsets[i+1]`, sorted in ascending order.
+ * Compared to the per-node Node::verlet_list vectors, this avoids one heap allocation per node and
+ * lets the overlap checks stream through contiguous memory.
+ *
+ * @tparam Index @IndexStub
+ * @tparam StoredIndex Integer type in which the ids of the Verlet neighbors are stored (see fp::verlet_index_t).
+ * @see Triangulation::set_compact_verlet_list(bool)
+ */
+template<indexing_number Index, indexing_number StoredIndex = Index>
+struct CompactVerletList
+{
+  std::vector<std::size_t> offsets; //!< Start of the Verlet neighbors of each node in #neighbour_ids. Contains one more element than there are nodes.
+  std::vector<StoredIndex> neighbour_ids; //!< Ids of the Verlet neighbors of all nodes, one node after the other.
+
+  //! Verlet neighbors of a single node.
+  /**
+   * @param node_id @NodeIDStub
+   * @return View of the ids of the Verlet neighbors of the node.
+   */
+  [[nodiscard]] std::span<const StoredIndex> operator[](Index node_id) const
+  {
+      return {neighbour_ids.data() + offsets[node_id], offsets[node_id + 1] - offsets[node_id]};
+  }
+
+  //! Number of nodes that the list holds Verlet neighbors for.
+  [[nodiscard]] Index size() const { return offsets.empty() ? 0 : static_cast<Index>(offsets.size() - 1); }
+
+  //! Deletes all Verlet neighbors.
+  void clear()
+  {
+      offsets.clear();
+      neighbour_ids.clear();
+  }
+};
 
 //! This enum defines named types of triangulations that are implemented in flippy.
 /**
@@ -260,6 +337,17 @@ enum TriangulationType{
     //! Create a triangulation which is a sub-triangulation of a plane square.
     EXPERIMENTAL_PLANAR_TRIANGULATION
 };
+
+//! This enum defines the space-filling curves along which the nodes of a triangulation can be reordered.
+/**
+ * @see Triangulation::reorder_nodes(SpaceFillingCurve)
+ */
+enum SpaceFillingCurve{
+    //! Order the nodes along a [Hilbert curve](https://en.wikipedia.org/wiki/Hilbert_curve).
+    HILBERT_CURVE,
+    //! Order the nodes along a [Z-order (Morton) curve](https://en.wikipedia.org/wiki/Z-order_curve).
+    MORTON_CURVE
+};
 /**@}*/
 
 
@@ -303,20 +391,18 @@ public:
     //! Constructor that can re-initiate a triangulation from the stored data.
     /**
      *
-     * @param nodes_input json object that contains data generated by make_egg_data() function, or similarly structured data.
+     * @param nodes_input data generated by make_egg_data() function, or similarly structured data, e.g. a json object
+     * if flippy/io/json.hpp is included. See egg_data_serializer for the data types that can be read.
      * @param verlet_radius_inp Value for [Verlet radius](https://en.wikipedia.org/wiki/Verlet_list).
      */
-    Triangulation(Json const& nodes_input, Real verlet_radius_inp):Triangulation(verlet_radius_inp)
+    template<egg_data EggData>
+    Triangulation(EggData const& nodes_input, Real verlet_radius_inp) requires (triangulation_type==SPHERICAL_TRIANGULATION)
+            :Triangulation(verlet_radius_inp)
     {
-        if constexpr(triangulation_type==SPHERICAL_TRIANGULATION) {
-            nodes_ = Nodes<Real, Index>(nodes_input);
-            all_nodes_are_bulk();
-            initiate_advanced_geometry();
-        }
-        else{
-            static_assert(triangulation_type==SPHERICAL_TRIANGULATION, "currently json initialization is only implemented for spherical triangulations!");
-        }
-
+        // currently initialization from stored data is only implemented for spherical triangulations
+        nodes_ = Nodes<Real, Index>(nodes_input);
+        all_nodes_are_bulk();
+        initiate_advanced_geometry();
     }
 
     //! Constructor that can initiate a spherical triangulation from scratch.
@@ -326,9 +412,9 @@ public:
      * @param R_initial_input Initial radius of the spherical triangulation.
      * @param verlet_radius_inp Value for [Verlet radius](https://en.wikipedia.org/wiki/Verlet_list).
      */
-    Triangulation(Index n_nodes_iter, Real R_initial_input, Real verlet_radius_inp):Triangulation(verlet_radius_inp)
+    Triangulation(Index n_nodes_iter, Real R_initial_input, Real verlet_radius_inp) requires (triangulation_type==SPHERICAL_TRIANGULATION)
+            :Triangulation(verlet_radius_inp)
     {
-        static_assert(triangulation_type==SPHERICAL_TRIANGULATION, "This initialization is intended for spherical triangulations");
         R_initial = R_initial_input;
         nodes_ = triangulate_sphere_nodes(n_nodes_iter);
         all_nodes_are_bulk();
@@ -348,9 +434,10 @@ public:
      * @param width Width of the planar membrane
      * @param verlet_radius_inp Value for [Verlet radius](https://en.wikipedia.org/wiki/Verlet_list).
      */
-    Triangulation(Index n_length, Index n_width, Real length, Real width, Real verlet_radius_inp):Triangulation(verlet_radius_inp)
+    Triangulation(Index n_length, Index n_width, Real length, Real width, Real verlet_radius_inp)
+            requires (triangulation_type==EXPERIMENTAL_PLANAR_TRIANGULATION)
+            :Triangulation(verlet_radius_inp)
     {
-        static_assert(triangulation_type == EXPERIMENTAL_PLANAR_TRIANGULATION, "This initialization is intended for planar triangulations");
         triangulate_planar_nodes(n_length, n_width, length, width);
         orient_plane();
         initiate_advanced_geometry();
@@ -371,12 +458,20 @@ public:
     /**
      * This method creates a Verlet list for each node of the triangulation. All nodes that are inside the `verlet_radius`, of a given node,
      * are included in its Verlet list (Node.verlet_list),
+     * If the compact Verlet list is switched on (see set_compact_verlet_list(bool)),
+     * the Verlet neighbors are stored in a single CompactVerletList instead, and the per-node lists stay empty.
      */
     void make_verlet_list()
     {
+        FLIPPY_PROFILE_SCOPE("Triangulation::make_verlet_list");
         for (auto& node: nodes_) {
             node.verlet_list.clear();
         }
+        compact_verlet_list_.clear();
+        if (use_compact_verlet_list_) {
+            make_compact_verlet_list();
+            return;
+        }
         for (auto node_p = nodes_.begin(); node_p!=nodes_.end(); ++node_p) {
             for (auto other_node_p = nodes_.begin(); other_node_p!=node_p; ++other_node_p) {
                 if ((node_p->pos - other_node_p->pos).norm_square()<verlet_radius_squared)
@@ -389,6 +484,117 @@ public:
         }
     }
 
+    //! Switch between the per-node Verlet lists and a single compact Verlet list.
+    /**
+     * With large Verlet radii, every node has dozens of Verlet neighbors and the Verlet lists dominate the memory
+     * footprint of large triangulations. The compact Verlet list (see CompactVerletList) packs all Verlet neighbors
+     * into one array, optionally with narrower ids (see fp::verlet_index_t).
+     * The Verlet list is re-created with the new storage layout when this method is called.
+     * @param compact If `true`, Node::verlet_list of all nodes will be empty and the Verlet neighbors are accessible
+     * through compact_verlet_list(). If `false` the per-node lists are used.
+     */
+    void set_compact_verlet_list(bool compact)
+    {
+        use_compact_verlet_list_ = compact;
+        make_verlet_list();
+    }
+
+    //! @getterFunctionStub
+    /**
+     * @return `true` if the Verlet neighbors are stored in compact_verlet_list() rather than in the Node::verlet_list of each node.
+     */
+    [[nodiscard]] bool uses_compact_verlet_list() const { return use_compact_verlet_list_; }
+
+    //! Returns a constant reference to the compact Verlet list.
+    /**
+     * @return The compact Verlet list. It is empty unless set_compact_verlet_list(bool) was used to switch it on.
+     */
+    [[nodiscard]] CompactVerletList<Index, verlet_index_t<Index>> const& compact_verlet_list() const { return compact_verlet_list_; }
+
+    //! @getterFunctionStub
+    /**
+     * @return A number that changes whenever the next neighbor ids of the nodes change, i.e. with every bond flip
+     * (including the flips that are undone) and every call of reorder_nodes(SpaceFillingCurve). Data that is derived from
+     * the connectivity can be cached as long as this number stays the same.
+     */
+    [[nodiscard]] unsigned long connectivity_version() const { return connectivity_version_; }
+
+    //! Renumber the nodes, such that nodes that are close in space are also close in memory.
+    /**
+     * The node ids are given by the order in which the triangulation was generated, and after many moves and flips,
+     * neighboring nodes are scattered all over the memory. This method sorts the nodes along a space-filling curve
+     * and renumbers them accordingly. The positions and the geometry of the nodes stay the same, but all ids stored
+     * in the triangulation (Node::id, Node::nn_ids, Node::verlet_list, the compact Verlet list, and the bulk and boundary node ids)
+     * are remapped to the new numbering. The method can be called periodically during a simulation.
+     *
+     * @warning Node ids that were obtained before the reordering, e.g. in a BondFlipData struct, or a vector of ids that is shuffled
+     * to iterate randomly through the nodes, are invalid after the reordering.
+     * @param curve The space-filling curve along which the nodes are sorted.
+     * @return A vector `old_ids`, where `old_ids[new_id]` is the id that the node with the id `new_id` had before the reordering.
+     * @see original_node_ids()
+     */
+    std::vector<Index> reorder_nodes(SpaceFillingCurve curve)
+    {
+        if (lazy_global_geometry_) { update_dirty_global_geometry(); }
+
+        std::vector<std::uint64_t> keys = space_filling_curve_keys(curve);
+        std::vector<Index> old_ids(nodes_.size());
+        std::iota(old_ids.begin(), old_ids.end(), Index(0));
+        std::stable_sort(old_ids.begin(), old_ids.end(), [&keys](Index lhs, Index rhs) { return keys[lhs]<keys[rhs]; });
+        std::vector<Index> new_ids(nodes_.size());
+        for (Index new_id = 0; new_id<nodes_.size(); ++new_id) { new_ids[old_ids[new_id]] = new_id; }
+
+        std::vector<Node<Real, Index>> reordered_nodes;
+        reordered_nodes.reserve(nodes_.size());
+        for (Index new_id = 0; new_id<nodes_.size(); ++new_id) {
+            reordered_nodes.push_back(std::move(nodes_.data[old_ids[new_id]]));
+            Node<Real, Index>& node = reordered_nodes.back();
+            node.id = new_id;
+            for (auto& nn_id: node.nn_ids) { nn_id = new_ids[nn_id]; }
+            for (auto& verlet_neighbour_id: node.verlet_list) { verlet_neighbour_id = new_ids[verlet_neighbour_id]; }
+            std::sort(node.verlet_list.begin(), node.verlet_list.end());
+        }
+        nodes_.data = std::move(reordered_nodes);
+
+        for (auto& node_id: bulk_nodes_ids) { node_id = new_ids[node_id]; }
+        std::sort(bulk_nodes_ids.begin(), bulk_nodes_ids.end());
+        std::set<Index> boundary_nodes_ids_set;
+        for (auto node_id: boundary_nodes_ids_set_) { boundary_nodes_ids_set.insert(new_ids[node_id]); }
+        boundary_nodes_ids_set_ = std::move(boundary_nodes_ids_set);
+
+        if (use_compact_verlet_list_) { reorder_compact_verlet_list(old_ids, new_ids); }
+
+        std::vector<Index> original_node_ids(nodes_.size());
+        for (Index new_id = 0; new_id<nodes_.size(); ++new_id) { original_node_ids[new_id] = original_node_id(old_ids[new_id]); }
+        original_node_ids_ = std::move(original_node_ids);
+
+        if (lazy_global_geometry_) { reset_dirty_region_tracking(); }
+        ++connectivity_version_;
+        return old_ids;
+    }
+
+    //! The id that a node had when the triangulation was created.
+    /**
+     * @param node_id @NodeIDStub
+     * @return The id of the node before any calls to reorder_nodes(SpaceFillingCurve). This is useful to keep the output of a simulation
+     * comparable to the initial state after the nodes were reordered.
+     */
+    [[nodiscard]] Index original_node_id(Index node_id) const
+    {
+        return original_node_ids_.empty() ? node_id : original_node_ids_[node_id];
+    }
+
+    //! The ids that all nodes had when the triangulation was created.
+    /**
+     * @return A vector `original_ids`, where `original_ids[node_id]` is the id the node had before any calls to reorder_nodes(SpaceFillingCurve).
+     */
+    [[nodiscard]] std::vector<Index> original_node_ids() const
+    {
+        std::vector<Index> original_ids(nodes_.size());
+        for (Index node_id = 0; node_id<nodes_.size(); ++node_id) { original_ids[node_id] = original_node_id(node_id); }
+        return original_ids;
+    }
+
     //! Adds the same 3D vector to the positions of each node of the triangulation.
     /**
      * This method is most helpful in shifting a triangulation after its initiation.
@@ -397,7 +603,9 @@ public:
      */
     void translate_all_nodes(vec3<Real> const& translation_vector)
     {
-        for (Index i = 0; i<nodes_.size(); ++i) { move_node(i, translation_vector); }
+        std::vector<Index> node_ids(nodes_.size());
+        std::iota(node_ids.begin(), node_ids.end(), Index{0});
+        move_nodes(node_ids, std::vector<vec3<Real>>(nodes_.size(), translation_vector));
     }
 
     //unit tested
@@ -424,13 +632,111 @@ public:
      */
     void move_node(Index node_id, vec3<Real> const& displacement_vector)
     {
-        pre_update_geometry = get_two_ring_geometry(node_id);
-        nodes_.displace(node_id, displacement_vector);
-        update_two_ring_geometry(node_id);
-        post_update_geometry = get_two_ring_geometry(node_id);
-        update_global_geometry(pre_update_geometry, post_update_geometry);
+        FLIPPY_PROFILE_SCOPE("Triangulation::move_node");
+        if (lazy_global_geometry_) {
+            nodes_.displace(node_id, displacement_vector);
+            update_two_ring_geometry(node_id);
+            mark_two_ring_dirty(node_id);
+        }
+        else {
+            pre_update_geometry = get_two_ring_geometry(node_id);
+            nodes_.displace(node_id, displacement_vector);
+            update_two_ring_geometry(node_id);
+            post_update_geometry = get_two_ring_geometry(node_id);
+            update_global_geometry(pre_update_geometry, post_update_geometry);
+        }
+    }
+
+    //! Number of nodes of the moved region that are recalculated by a single task of the parallel move_nodes.
+    static constexpr std::size_t move_nodes_chunk_size = 256;
+
+    //! Move several nodes of the triangulation at once and update all the geometric quantities that changed.
+    /**
+     * The result is the same as calling move_node(Index, vec3<Real> const&) for every node, but all nodes are displaced
+     * first, then the geometry of every node in the union of the two-rings of the moved nodes is recalculated exactly once,
+     * and the changes of the local geometry are reduced into the global geometry in a single update.
+     * @param node_ids Ids of the nodes that are to be moved. Each id should appear at most once.
+     * @param displacement_vectors 3D vectors by which the nodes are to be displaced, in the same order as `node_ids`.
+     */
+    void move_nodes(std::span<Index const> node_ids, std::span<vec3<Real> const> displacement_vectors)
+    {
+        move_nodes_in_chunks(node_ids, displacement_vectors, [](std::size_t n_chunks, auto const& task) {
+            for (std::size_t chunk = 0; chunk<n_chunks; ++chunk) { task(chunk); }
+        });
+    }
+
+    //! Same as move_nodes(std::span<Index const>, std::span<vec3<Real> const>), but the geometry is recalculated in parallel.
+    /**
+     * The moved region is split into chunks of #move_nodes_chunk_size nodes, which are recalculated by the threads of the pool.
+     * The partial changes of the global geometry are summed in a fixed pairwise tree over the chunks, so the result does
+     * not depend on the number of threads.
+     * @param node_ids Ids of the nodes that are to be moved. Each id should appear at most once.
+     * @param displacement_vectors 3D vectors by which the nodes are to be displaced, in the same order as `node_ids`.
+     * @param pool thread pool that executes the recalculation.
+     */
+    void move_nodes(std::span<Index const> node_ids, std::span<vec3<Real> const> displacement_vectors, ThreadPool& pool)
+    {
+        move_nodes_in_chunks(node_ids, displacement_vectors, [&pool](std::size_t n_chunks, auto const& task) {
+            pool.parallel_for(n_chunks, task);
+        });
+    }
+
+    //! Ids of the nodes that are at most `n_rings` bonds away from a center node.
+    /**
+     * This is a convenient way to select a patch of the triangulation for collective moves.
+     * @param center_node_id Id of the node at the center of the patch.
+     * @param n_rings Number of rings of neighbors around the center node that belong to the patch.
+     * `0` returns only the center node, `1` the center node and its next neighbors, and so on.
+     * @return Ids of the nodes in the patch, ordered by their distance from the center node.
+     */
+    [[nodiscard]] std::vector<Index> node_patch(Index center_node_id, Index n_rings) const
+    {
+        std::vector<Index> patch{center_node_id};
+        std::vector<bool> in_patch(nodes_.size(), false);
+        in_patch[center_node_id] = true;
+        std::size_t ring_begin = 0;
+        for (Index ring = 0; ring<n_rings; ++ring) {
+            std::size_t const ring_end = patch.size();
+            for (std::size_t i = ring_begin; i<ring_end; ++i) {
+                for (Index nn_id: nodes_.nn_ids(patch[i])) {
+                    if (!in_patch[nn_id]) {
+                        in_patch[nn_id] = true;
+                        patch.push_back(nn_id);
+                    }
+                }
+            }
+            ring_begin = ring_end;
+        }
+        return patch;
+    }
+
+    //! Switch the lazy bookkeeping of the global geometry on or off.
+    /**
+     * By default, every node move and bond flip immediately updates the global geometry of the triangulation,
+     * by aggregating the geometry of the changed patch before and after the update.
+     * This is wasteful if the energy function only depends on local quantities (like the curvature of the moved node).
+     * In lazy mode, the moves and flips only mark the changed nodes as dirty. The global geometry is then brought up to date
+     * the next time global_geometry() is called, by only re-summing the contributions of the dirty nodes.
+     * If global_geometry() is never called, the global bookkeeping is skipped entirely.
+     *
+     * @param lazy `true` switches the lazy mode on, `false` switches it off.
+     * Switching the lazy mode off will bring the global geometry up to date immediately.
+     * @see global_geometry()
+     */
+    void set_lazy_global_geometry(bool lazy)
+    {
+        if (lazy_global_geometry_) { update_dirty_global_geometry(); }
+        lazy_global_geometry_ = lazy;
+        if (lazy_global_geometry_) { reset_dirty_region_tracking(); }
     }
 
+    //! @getterFunctionStub
+    /**
+     * @return `true` if the global geometry is updated lazily.
+     * @see set_lazy_global_geometry(bool)
+     */
+    [[nodiscard]] bool lazy_global_geometry() const { return lazy_global_geometry_; }
+
     // unit-tested
     //! Adds a new node to the next neighbor list of a given node and calculates their mutual distance.
     /**
@@ -481,6 +787,7 @@ public:
      * If the flip was not successful, then a default initialized BondFlipData struct will be returned with BondFlipData::flipped = **false**.
      * @note Regardless of the return values, the primary purpose of the function, that of flipping a bond, is accomplished as a side-effect.
      */
+        FLIPPY_PROFILE_SCOPE("Triangulation::flip_bond");
         if constexpr (triangulation_type == TriangulationType::SPHERICAL_TRIANGULATION) {
             return flip_bulk_bond(node_id, nn_id, min_bond_length_square, max_bond_length_square);
         } else if constexpr (triangulation_type == TriangulationType::EXPERIMENTAL_PLANAR_TRIANGULATION){
@@ -546,9 +853,15 @@ public:
      */
     void unflip_bond(Index node_id, Index nn_id, BondFlipData<Index> const& common_nns)
     {
+        FLIPPY_PROFILE_SCOPE("Triangulation::unflip_bond");
         flip_bond_unchecked(common_nns.common_nn_0, common_nns.common_nn_1, nn_id, node_id);
         update_diamond_geometry(node_id, nn_id, common_nns.common_nn_0, common_nns.common_nn_1);
-        update_global_geometry(post_update_geometry, pre_update_geometry);
+        if (lazy_global_geometry_) {
+            mark_diamond_dirty(node_id, nn_id, common_nns.common_nn_0, common_nns.common_nn_1);
+        }
+        else {
+            update_global_geometry(post_update_geometry, pre_update_geometry);
+        }
     }
 
     //! Exchange the next neighborhood between four nodes in a manner that will correspond to
@@ -577,6 +890,7 @@ public:
         emplace_before(common_nn_j_m_1, node_id, common_nn_j_p_1);
         emplace_before(common_nn_j_p_1, nn_id, common_nn_j_m_1);
         delete_connection_between_nodes_of_old_edge(node_id, nn_id);
+        ++connectivity_version_;
         return {.flipped=true, .common_nn_0=common_nn_j_m_1, .common_nn_1=common_nn_j_p_1};
     }
 
@@ -593,48 +907,15 @@ public:
      */
     void update_bulk_node_geometry(Index node_id)
     {
+        FLIPPY_PROFILE_SCOPE("Triangulation::update_bulk_node_geometry");
         update_nn_distance_vectors(node_id);
-
-        Real area_sum = 0.;
-        vec3<Real> face_normal_sum{0., 0., 0.}, local_curvature_vec{0., 0., 0.};
-        vec3<Real> face_normal;
-        indexing_number auto nn_number = (Index) nodes_.nn_ids(node_id).size();
-        Index j_p_1;
-
-        Real face_area, face_normal_norm;
-        vec3<Real> ljj_p_1, lij_p_1, lij;
-        Real cot_at_j, cot_at_j_p_1;
-
-        for (Index j = 0; j<nn_number; ++j) {
-            //return j+1 element of ordered_nn_ids unless j has the last value then wrap around and return 0th element
-            j_p_1 = Neighbors<Index>::plus_one(j,nn_number);
-
-            lij = nodes_.nn_distances(node_id)[j];
-            lij_p_1 = nodes_.nn_distances(node_id)[j_p_1];
-            ljj_p_1 = lij_p_1 - lij;
-
-            cot_at_j = cot_between_vectors(lij, (-1)*ljj_p_1);
-            cot_at_j_p_1 = cot_between_vectors(lij_p_1, ljj_p_1);
-
-
-            face_normal = lij.cross(lij_p_1); //nodes_.nn_distances(node_id)[j].cross(nodes_.nn_distances(node_id)[j_p_1]);
-            face_normal_norm = face_normal.norm();
-#ifdef DEBUG
-            if(face_normal_norm < 1e-10) {
-                throw std::runtime_error("A triangle face is degenerate and Area sum is evaluating to "+std::to_string(face_normal_norm)+". This should not happen.");
-            }
-#endif
-            face_area = mixed_area(lij, lij_p_1, Real(0.5)*face_normal_norm, cot_at_j, cot_at_j_p_1);
-            area_sum += face_area;
-            face_normal_sum += face_area*face_normal/face_normal_norm;
-
-            local_curvature_vec -= (cot_at_j_p_1*lij + cot_at_j*lij_p_1);
-        }
-        nodes_.set_area(node_id, area_sum);
-        nodes_.set_volume(node_id, nodes_[node_id].pos.dot(face_normal_sum)/((Real) 3.)); // 18=3*6: 6 has the aforementioned justification. 3 is part of the formula for the tetrahedron volume
-        nodes_.set_curvature_vec(node_id,  -local_curvature_vec/((Real) 2.*area_sum)); // 2 is part of the formula to calculate the local curvature I just did not divide the vector inside the loop
-        nodes_.set_unit_bending_energy(node_id, local_curvature_vec.dot(local_curvature_vec)/((Real) 8.*area_sum)); // 8 is 2*4, where 4 is the square of the above two and the area in the denominator is what remains after canceling. 1/ comes from the pre-factor to bending energy
-
+        auto const& nn_distances = nodes_.nn_distances(node_id);
+        BulkNodeGeometry const bng = bulk_node_geometry(nodes_[node_id].pos, static_cast<Index>(nn_distances.size()),
+                                                        [&nn_distances](Index j) -> vec3<Real> const& { return nn_distances[j]; });
+        nodes_.set_area(node_id, bng.area);
+        nodes_.set_volume(node_id, bng.volume);
+        nodes_.set_curvature_vec(node_id, bng.curvature_vec);
+        nodes_.set_unit_bending_energy(node_id, bng.unit_bending_energy);
     };
 
 
@@ -659,7 +940,9 @@ public:
         // right-handed, then this normal will point outwards
         un_noremd_face_normal = lij.cross(lij_p_1);
         face_normal_norm = un_noremd_face_normal.norm();
-        area = mixed_area(lij, lij_p_1, face_normal_norm/2.);
+        vec3<Real> ljj_p_1 = lij_p_1 - lij;
+        area = mixed_area(lij, lij_p_1, face_normal_norm/Real(2.),
+                          cot_between_vectors(lij, (-1)*ljj_p_1), cot_between_vectors(lij_p_1, ljj_p_1));
         return std::make_tuple(area, un_noremd_face_normal);
     }
 
@@ -717,7 +1000,7 @@ public:
         Real cot_at_j_p_1 = cot_between_vectors(lij_p_1, ljj_p_1);
         if ((cot_at_j>Real(0.)) && (cot_at_j_p_1>Real(0.))) { // both angles at j and j+1 are smaller than 90 deg so the triangle can only be obtuse at the node
             if (lij.dot(lij_p_1)>Real(0.)) { // cos at i is positive i.e. angle at i is not obtuse
-                return (cot_at_j_p_1*lij.dot(lij) + cot_at_j*lij_p_1.dot(lij_p_1))/8.;
+                return (cot_at_j_p_1*lij.dot(lij) + cot_at_j*lij_p_1.dot(lij_p_1))/Real(8.);
             }
             else {//obtuse at node i.
                 return triangle_area/Real(2.);
@@ -768,6 +1051,154 @@ public:
         }
     };
 
+    //! Geometric quantities of the two-ring of a node, as they would be after a move of the node.
+    /**
+     * This is the speculative counterpart of get_two_ring_geometry(Index): the local geometry of the node and its next
+     * neighbors is recalculated for the displaced position of the node, but the triangulation is not changed.
+     * The difference between the returned geometry and get_two_ring_geometry(Index) is the change that move_node(Index, vec3<Real> const&)
+     * would make to the global geometry.
+     * @param node_id @NodeIDStub
+     * @param displacement displacement of the node.
+     * @return Geometry<Real, Index> object containing the geometric quantities of the displaced node and its next neighbor nodes.
+     */
+    [[nodiscard]] Geometry<Real, Index> two_ring_geometry_after_move(Index node_id, vec3<Real> const& displacement) const
+    {
+        Geometry<Real, Index> trg{};
+        auto const& nn_ids = nodes_.nn_ids(node_id);
+        if (!is_boundary_node(node_id)) {
+            auto const& nn_distances = nodes_.nn_distances(node_id);
+            BulkNodeGeometry const bng = bulk_node_geometry(nodes_[node_id].pos + displacement, static_cast<Index>(nn_ids.size()),
+                                                            [&](Index j) { return nn_distances[j] - displacement; });
+            trg += Geometry<Real, Index>(bng.area, bng.volume, bng.unit_bending_energy);
+        }
+        for (Index nn_id: nn_ids) {
+            if (is_boundary_node(nn_id)) { continue; }
+            auto const& nn_nn_ids = nodes_.nn_ids(nn_id);
+            auto const& nn_nn_distances = nodes_.nn_distances(nn_id);
+            Index const moved_j = static_cast<Index>(std::find(nn_nn_ids.begin(), nn_nn_ids.end(), node_id) - nn_nn_ids.begin());
+            BulkNodeGeometry const bng = bulk_node_geometry(nodes_[nn_id].pos, static_cast<Index>(nn_nn_ids.size()),
+                                                            [&](Index j) { return (j==moved_j) ? nn_nn_distances[j] + displacement : nn_nn_distances[j]; });
+            trg += Geometry<Real, Index>(bng.area, bng.volume, bng.unit_bending_energy);
+        }
+        return trg;
+    }
+
+    //! Global geometry of the triangulation, as it would be after a move of a node.
+    /**
+     * The triangulation is not changed.
+     * @param node_id @NodeIDStub
+     * @param displacement displacement of the node.
+     * @return the global geometry after the hypothetical move.
+     * @see two_ring_geometry_after_move(Index, vec3<Real> const&)
+     */
+    [[nodiscard]] Geometry<Real, Index> global_geometry_after_move(Index node_id, vec3<Real> const& displacement) const
+    {
+        return global_geometry() - get_two_ring_geometry(node_id) + two_ring_geometry_after_move(node_id, displacement);
+    }
+
+    //! Change of the global area by a move of a node, from the triangles around the node only.
+    /**
+     * The mixed areas of the nodes of a triangle add up to the area of the triangle, so a move changes the global area
+     * by the change of the areas of the triangles around the moved node. This is much cheaper than
+     * two_ring_geometry_after_move(Index, vec3<Real> const&), which also recalculates the curvatures of the two-ring, and
+     * can be used to reject moves early. The result agrees with the area change of the two-ring up to rounding.
+     * The triangulation is not changed.
+     * @param node_id @NodeIDStub
+     * @param displacement displacement of the node.
+     * @return The area change, or no value if the node or one of its next neighbors is on the boundary, where the areas
+     * of the nodes do not add up to the areas of the triangles.
+     */
+    [[nodiscard]] std::optional<Real> area_change_after_move(Index node_id, vec3<Real> const& displacement) const
+    {
+        if (!has_closed_bulk_ring(node_id)) { return std::nullopt; }
+        auto const& nn_distances = nodes_.nn_distances(node_id);
+        auto const nn_number = static_cast<Index>(nn_distances.size());
+        Real twice_area_change = 0;
+        for (Index j = 0; j<nn_number; ++j) {
+            vec3<Real> const& lij = nn_distances[j];
+            vec3<Real> const& lij_p_1 = nn_distances[Neighbors<Index>::plus_one(j, nn_number)];
+            twice_area_change += (lij - displacement).cross(lij_p_1 - displacement).norm() - lij.cross(lij_p_1).norm();
+        }
+        return twice_area_change/Real(2.);
+    }
+
+    //! Gradients of the global area, volume and unit bending energy with respect to the position of a node.
+    /**
+     * For a node whose ring of next neighbors is closed and free of boundary nodes, the area and volume gradients are analytic.
+     * The gradient of the total area is given by the cotangent formula
+     * \f$\nabla_i A = \frac{1}{2}\sum_j(\cot\alpha_{ij}+\cot\beta_{ij})(\vec{x}_i-\vec{x}_j) = -A_i\vec{K}_i\f$,
+     * where \f$A_i\f$ is Node::area and \f$\vec{K}_i\f$ is Node::curvature_vec,
+     * and the gradient of the enclosed volume is \f$\nabla_i V = \frac{1}{6}\sum_j \vec{l}_{ij}\times\vec{l}_{i,j+1}\f$.
+     * Both hold, since the mixed areas of the nodes add up to the true triangle areas and the node volumes add up to the
+     * true enclosed volume.
+     * The gradient of the unit bending energy, and all gradients of nodes at or next to a boundary, are calculated by
+     * central differences of two_ring_geometry_after_move(Index, vec3<Real> const&), with a step that is a small fraction of the
+     * mean bond length of the node.
+     * @param node_id @NodeIDStub
+     * @return GeometryGradient with the three gradients.
+     */
+    [[nodiscard]] GeometryGradient<Real> geometry_gradient(Index node_id) const
+    {
+        if (!has_closed_bulk_ring(node_id)) { return central_difference_geometry_gradient(node_id); }
+        return {.area=area_gradient(node_id), .volume=volume_gradient(node_id),
+                .unit_bending_energy=central_difference_unit_bending_energy_gradient(node_id)};
+    }
+
+    //! Analytic gradient of the global area with respect to the position of a node.
+    /**
+     * Only valid for nodes whose ring of next neighbors is closed and free of boundary nodes.
+     * @param node_id @NodeIDStub
+     * @return \f$-A_i\vec{K}_i\f$
+     * @see geometry_gradient(Index)
+     */
+    [[nodiscard]] vec3<Real> area_gradient(Index node_id) const
+    {
+        return -nodes_[node_id].area*nodes_[node_id].curvature_vec;
+    }
+
+    //! Analytic gradient of the global volume with respect to the position of a node.
+    /**
+     * Only valid for nodes whose ring of next neighbors is closed and free of boundary nodes.
+     * @param node_id @NodeIDStub
+     * @return \f$\frac{1}{6}\sum_j \vec{l}_{ij}\times\vec{l}_{i,j+1}\f$
+     * @see geometry_gradient(Index)
+     */
+    [[nodiscard]] vec3<Real> volume_gradient(Index node_id) const
+    {
+        auto const& nn_distances = nodes_.nn_distances(node_id);
+        auto const nn_number = static_cast<Index>(nn_distances.size());
+        vec3<Real> face_normal_sum{0, 0, 0};
+        for (Index j = 0; j<nn_number; ++j) {
+            face_normal_sum += nn_distances[j].cross(nn_distances[Neighbors<Index>::plus_one(j, nn_number)]);
+        }
+        return face_normal_sum/Real(6);
+    }
+
+    //! Gradient of an energy that depends on the position of the nodes only through the global geometry.
+    /**
+     * The energy is assumed to be a function \f$E(A, V, E_b)\f$ of the global area, volume and unit bending energy.
+     * Its gradient is assembled from geometry_gradient(Index) with the chain rule. The central differences of the unit
+     * bending energy are skipped if \f$\partial E/\partial E_b\f$ is zero, so energies that only depend on the area and
+     * the volume have purely analytic gradients away from the boundary.
+     * @param node_id @NodeIDStub
+     * @param energy_derivatives partial derivatives \f$\partial E/\partial A\f$, \f$\partial E/\partial V\f$ and
+     * \f$\partial E/\partial E_b\f$, stored in the data members area, volume and unit_bending_energy of a Geometry.
+     * @return gradient of the energy with respect to the position of the node.
+     */
+    [[nodiscard]] vec3<Real> energy_gradient(Index node_id, Geometry<Real, Index> const& energy_derivatives) const
+    {
+        if (!has_closed_bulk_ring(node_id)) {
+            GeometryGradient<Real> const gradient = central_difference_geometry_gradient(node_id);
+            return energy_derivatives.area*gradient.area + energy_derivatives.volume*gradient.volume
+                    + energy_derivatives.unit_bending_energy*gradient.unit_bending_energy;
+        }
+        vec3<Real> gradient = energy_derivatives.area*area_gradient(node_id) + energy_derivatives.volume*volume_gradient(node_id);
+        if (energy_derivatives.unit_bending_energy!=0) {
+            gradient += energy_derivatives.unit_bending_energy*central_difference_unit_bending_energy_gradient(node_id);
+        }
+        return gradient;
+    }
+
     // unit-tested
     //! Method for stretching or squeezing the initial triangulation shape.
     /**
@@ -786,13 +1217,13 @@ public:
      */
     void scale_node_coordinates(Real x_stretch, Real y_stretch = 1, Real z_stretch = 1)
     {
-        vec3<Real> displ = {0, 0, 0};
-        for (auto& node: nodes_.data) {
-            displ[0] = node.pos[0]*(x_stretch - 1);
-            displ[1] = node.pos[1]*(y_stretch - 1);
-            displ[2] = node.pos[2]*(z_stretch - 1);
-            move_node(node.id, displ);
+        std::vector<Index> node_ids(nodes_.size());
+        std::vector<vec3<Real>> displacements(nodes_.size());
+        for (auto const& node: nodes_.data) {
+            node_ids[node.id] = node.id;
+            displacements[node.id] = vec3<Real>{node.pos[0]*(x_stretch - 1), node.pos[1]*(y_stretch - 1), node.pos[2]*(z_stretch - 1)};
         }
+        move_nodes(node_ids, displacements);
     }
 
     //Todo unittest
@@ -876,19 +1307,27 @@ public:
      * @return Constant reference to the underlying Nodes container.
      */
     const Nodes<Real, Index>& nodes() const { return nodes_; }
-    //! Creates a JSON object with the data of the triangulation.
+    //! Creates serialized data of the triangulation, by default a JSON object.
     /**
-     * Egg refers to the fact that the data can be used to recreate the triangulation using the Triangulation(Json const& nodes_input, Real verlet_radius_inp) constructor.
-     * @note The Triangulation(Json const& nodes_input, Real verlet_radius_inp) constructor is currently only implemented for a spherical Triangulation!
+     * Egg refers to the fact that the data can be used to recreate the triangulation using the Triangulation(EggData const& nodes_input, Real verlet_radius_inp) constructor.
+     * @note The Triangulation(EggData const& nodes_input, Real verlet_radius_inp) constructor is currently only implemented for a spherical Triangulation!
      *
-     * @return Triangulation data in JSON format.
+     * @tparam Serializer one of the serializers of flippy/io, see Nodes::make_data().
+     * @return Triangulation data in the format of the serializer, by default in JSON format.
      */
-    [[nodiscard]] Json make_egg_data() const { return nodes_.make_data(); }
+    template<typename Serializer = io::JsonNodesSerializer>
+    [[nodiscard]] auto make_egg_data() const { return nodes_.template make_data<Serializer>(); }
     //! Information about the global geometric quantities of the triangulation, like global area, volume, and total unit bending energy.
     /**
+     * If the triangulation is in the lazy mode (see set_lazy_global_geometry(bool)), the contributions of all nodes that
+     * were changed since the last call are re-summed before the global geometry is returned.
      * @return Geometric quantities of the triangulation aggregated over all nodes.
      */
-    [[nodiscard]] const Geometry<Real, Index>& global_geometry() const { return global_geometry_; }
+    [[nodiscard]] const Geometry<Real, Index>& global_geometry() const
+    {
+        if (lazy_global_geometry_) { update_dirty_global_geometry(); }
+        return global_geometry_;
+    }
 
     //Todo unittest
     //! Initiates the global geometry of the triangulation.
@@ -908,6 +1347,7 @@ public:
             update_boundary_node_geometry(node_id);
             update_global_geometry(empty, Geometry<Real, Index>(nodes_[node_id]));
         }
+        if (lazy_global_geometry_) { reset_dirty_region_tracking(); }
     }
 
     //! Returns the ids of all nodes that are not on the boundary.
@@ -915,8 +1355,7 @@ public:
      * Only works for triangulations that have a boundary.
      * @return unique set of global ids of all nodes that are not on the boundary.
      */
-    std::set<Index> boundary_nodes_ids_set() const {
-        static_assert(triangulation_type == TriangulationType::EXPERIMENTAL_PLANAR_TRIANGULATION, "This function is only implemented for PLANAR_TRIANGULATION.");
+    std::set<Index> boundary_nodes_ids_set() const requires (triangulation_type==EXPERIMENTAL_PLANAR_TRIANGULATION) {
         return boundary_nodes_ids_set_;
     }
 
@@ -940,12 +1379,23 @@ private:
     Real R_initial;
     Nodes<Real, Index> nodes_;
     std::vector<Index> bulk_nodes_ids;
-    Geometry<Real, Index> global_geometry_;
+    mutable Geometry<Real, Index> global_geometry_;
     Geometry<Real, Index> pre_update_geometry, post_update_geometry;
+    bool lazy_global_geometry_{false};
+    mutable std::vector<Geometry<Real, Index>> accounted_geometry_;
+    mutable std::vector<bool> is_dirty_;
+    mutable std::vector<Index> dirty_nodes_ids_;
+    std::vector<bool> is_in_moved_region_;
+    std::vector<Index> moved_region_ids_;
+    std::vector<Geometry<Real, Index>> chunk_geometry_changes_;
     mutable vec3<Real> l0_, l1_;
     Real verlet_radius{};
     Real verlet_radius_squared{};
+    bool use_compact_verlet_list_{false};
+    CompactVerletList<Index, verlet_index_t<Index>> compact_verlet_list_;
+    std::vector<Index> original_node_ids_;
     std::set<Index> boundary_nodes_ids_set_;
+    unsigned long connectivity_version_{0};
 
     //unit tested
     void initiate_advanced_geometry(){
@@ -955,6 +1405,202 @@ private:
         make_verlet_list();
     }
 
+    //! Fills the compact Verlet list in two passes, first counting the Verlet neighbors of each node and then storing them.
+    void make_compact_verlet_list()
+    {
+        using StoredIndex = verlet_index_t<Index>;
+        if (static_cast<std::size_t>(nodes_.size())>static_cast<std::size_t>(std::numeric_limits<StoredIndex>::max())) {
+            throw std::overflow_error("The triangulation has too many nodes to store their ids in the compact Verlet list. Define FLIPPY_FULL_WIDTH_VERLET_INDICES.");
+        }
+        std::vector<std::size_t>& offsets = compact_verlet_list_.offsets;
+        offsets.assign(static_cast<std::size_t>(nodes_.size()) + 1, 0);
+        for (Index i = 0; i<nodes_.size(); ++i) {
+            for (Index j = 0; j<i; ++j) {
+                if ((nodes_.pos(i) - nodes_.pos(j)).norm_square()<verlet_radius_squared) {
+                    ++offsets[i + 1];
+                    ++offsets[j + 1];
+                }
+            }
+        }
+        for (std::size_t i = 1; i<offsets.size(); ++i) { offsets[i] += offsets[i - 1]; }
+
+        compact_verlet_list_.neighbour_ids.resize(offsets.back());
+        std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+        // the pairs are visited such that each node receives the ids of its neighbors in ascending order
+        for (Index i = 0; i<nodes_.size(); ++i) {
+            for (Index j = 0; j<i; ++j) {
+                if ((nodes_.pos(i) - nodes_.pos(j)).norm_square()<verlet_radius_squared) {
+                    compact_verlet_list_.neighbour_ids[cursor[i]++] = static_cast<StoredIndex>(j);
+                    compact_verlet_list_.neighbour_ids[cursor[j]++] = static_cast<StoredIndex>(i);
+                }
+            }
+        }
+    }
+
+    //! Positions of all nodes along a space-filling curve, that spans the bounding box of the triangulation.
+    [[nodiscard]] std::vector<std::uint64_t> space_filling_curve_keys(SpaceFillingCurve curve) const
+    {
+        if (nodes_.size()==0) { return {}; }
+        vec3<Real> lower = nodes_.pos(0), upper = nodes_.pos(0);
+        for (auto const& node: nodes_) {
+            for (Index k = 0; k<3; ++k) {
+                lower[k] = std::min(lower[k], node.pos[k]);
+                upper[k] = std::max(upper[k], node.pos[k]);
+            }
+        }
+        Real const grid_max = static_cast<Real>((std::uint32_t(1) << SPACE_FILLING_CURVE_BITS) - 1);
+        std::vector<std::uint64_t> keys;
+        keys.reserve(nodes_.size());
+        std::array<std::uint32_t, 3> grid_pos{};
+        for (auto const& node: nodes_) {
+            for (Index k = 0; k<3; ++k) {
+                Real extent = upper[k] - lower[k];
+                grid_pos[k] = (extent>0) ? static_cast<std::uint32_t>((node.pos[k] - lower[k])/extent*grid_max) : 0;
+            }
+            keys.push_back((curve==HILBERT_CURVE) ? hilbert_key(grid_pos[0], grid_pos[1], grid_pos[2])
+                                                  : morton_key(grid_pos[0], grid_pos[1], grid_pos[2]));
+        }
+        return keys;
+    }
+
+    void reorder_compact_verlet_list(std::vector<Index> const& old_ids, std::vector<Index> const& new_ids)
+    {
+        using StoredIndex = verlet_index_t<Index>;
+        CompactVerletList<Index, StoredIndex> reordered_list;
+        reordered_list.offsets.reserve(compact_verlet_list_.offsets.size());
+        reordered_list.neighbour_ids.reserve(compact_verlet_list_.neighbour_ids.size());
+        reordered_list.offsets.push_back(0);
+        for (auto old_id: old_ids) {
+            auto row_begin = reordered_list.neighbour_ids.end() - reordered_list.neighbour_ids.begin();
+            for (auto old_neighbour_id: compact_verlet_list_[old_id]) {
+                reordered_list.neighbour_ids.push_back(static_cast<StoredIndex>(new_ids[old_neighbour_id]));
+            }
+            std::sort(reordered_list.neighbour_ids.begin() + row_begin, reordered_list.neighbour_ids.end());
+            reordered_list.offsets.push_back(reordered_list.neighbour_ids.size());
+        }
+        compact_verlet_list_ = std::move(reordered_list);
+    }
+
+    //! Local geometric quantities of a bulk node, as calculated by bulk_node_geometry().
+    struct BulkNodeGeometry
+    {
+        Real area;
+        Real volume;
+        vec3<Real> curvature_vec;
+        Real unit_bending_energy;
+    };
+
+    //! Calculates the local geometry of a bulk node from its position and the distance vectors to its next neighbors.
+    /**
+     * This is the kernel of update_bulk_node_geometry(Index). It does not read the triangulation, so it can also be
+     * evaluated for hypothetical positions of the node or of its next neighbors.
+     * @param pos position of the node.
+     * @param nn_number number of next neighbors of the node.
+     * @param nn_distance callable that returns the distance vector to the `j`th next neighbor (in the order of Node::nn_ids).
+     */
+    template<typename NNDistance>
+    static BulkNodeGeometry bulk_node_geometry(vec3<Real> const& pos, Index nn_number, NNDistance const& nn_distance)
+    {
+        Real area_sum = 0.;
+        vec3<Real> face_normal_sum{0., 0., 0.}, local_curvature_vec{0., 0., 0.};
+        vec3<Real> face_normal;
+        Index j_p_1;
+
+        Real face_area, face_normal_norm;
+        vec3<Real> ljj_p_1, lij_p_1, lij;
+        Real cot_at_j, cot_at_j_p_1;
+
+        for (Index j = 0; j<nn_number; ++j) {
+            //return j+1 element of ordered_nn_ids unless j has the last value then wrap around and return 0th element
+            j_p_1 = Neighbors<Index>::plus_one(j,nn_number);
+
+            lij = nn_distance(j);
+            lij_p_1 = nn_distance(j_p_1);
+            ljj_p_1 = lij_p_1 - lij;
+
+            cot_at_j = cot_between_vectors(lij, (-1)*ljj_p_1);
+            cot_at_j_p_1 = cot_between_vectors(lij_p_1, ljj_p_1);
+
+
+            face_normal = lij.cross(lij_p_1);
+            face_normal_norm = face_normal.norm();
+#ifdef DEBUG
+            if(face_normal_norm < 1e-10) {
+                throw std::runtime_error("A triangle face is degenerate and Area sum is evaluating to "+std::to_string(face_normal_norm)+". This should not happen.");
+            }
+#endif
+            face_area = mixed_area(lij, lij_p_1, Real(0.5)*face_normal_norm, cot_at_j, cot_at_j_p_1);
+            area_sum += face_area;
+            face_normal_sum += face_area*face_normal/face_normal_norm;
+
+            local_curvature_vec -= (cot_at_j_p_1*lij + cot_at_j*lij_p_1);
+        }
+        return {.area=area_sum,
+                .volume=pos.dot(face_normal_sum)/((Real) 3.), // 18=3*6: 6 has the aforementioned justification. 3 is part of the formula for the tetrahedron volume
+                .curvature_vec=-local_curvature_vec/((Real) 2.*area_sum), // 2 is part of the formula to calculate the local curvature I just did not divide the vector inside the loop
+                .unit_bending_energy=local_curvature_vec.dot(local_curvature_vec)/((Real) 8.*area_sum)}; // 8 is 2*4, where 4 is the square of the above two and the area in the denominator is what remains after canceling. 1/ comes from the pre-factor to bending energy
+    }
+
+    //! `true` if the node is on the boundary of a triangulation type that has a boundary.
+    [[nodiscard]] bool is_boundary_node(Index node_id) const
+    {
+        if constexpr (triangulation_type==SPHERICAL_TRIANGULATION) { return false; }
+        else { return boundary_nodes_ids_set_.contains(node_id); }
+    }
+
+    //! `true` if neither the node nor any of its next neighbors is on the boundary.
+    [[nodiscard]] bool has_closed_bulk_ring(Index node_id) const
+    {
+        if constexpr (triangulation_type==SPHERICAL_TRIANGULATION) { return true; }
+        else {
+            if (is_boundary_node(node_id)) { return false; }
+            for (Index nn_id: nodes_.nn_ids(node_id)) {
+                if (is_boundary_node(nn_id)) { return false; }
+            }
+            return true;
+        }
+    }
+
+    //! Step of the central differences, which is a small fraction of the mean bond length of the node.
+    [[nodiscard]] Real central_difference_step(Index node_id) const
+    {
+        Real mean_bond_length = 0;
+        for (auto const& nn_distance: nodes_.nn_distances(node_id)) { mean_bond_length += nn_distance.norm(); }
+        mean_bond_length /= static_cast<Real>(nodes_.nn_distances(node_id).size());
+        return std::cbrt(std::numeric_limits<Real>::epsilon())*mean_bond_length;
+    }
+
+    //! Central difference approximation of the gradient of the global unit bending energy with respect to the position of a node.
+    [[nodiscard]] vec3<Real> central_difference_unit_bending_energy_gradient(Index node_id) const
+    {
+        Real const step = central_difference_step(node_id);
+        vec3<Real> gradient{0, 0, 0};
+        for (std::size_t direction = 0; direction<3; ++direction) {
+            vec3<Real> displacement{0, 0, 0};
+            displacement[direction] = step;
+            gradient[direction] = (two_ring_geometry_after_move(node_id, displacement).unit_bending_energy
+                                   - two_ring_geometry_after_move(node_id, -displacement).unit_bending_energy)/(2*step);
+        }
+        return gradient;
+    }
+
+    //! Central difference approximation of the gradients of the global geometry with respect to the position of a node.
+    [[nodiscard]] GeometryGradient<Real> central_difference_geometry_gradient(Index node_id) const
+    {
+        Real const step = central_difference_step(node_id);
+        GeometryGradient<Real> gradient{};
+        for (std::size_t direction = 0; direction<3; ++direction) {
+            vec3<Real> displacement{0, 0, 0};
+            displacement[direction] = step;
+            Geometry<Real, Index> const forward = two_ring_geometry_after_move(node_id, displacement);
+            Geometry<Real, Index> const backward = two_ring_geometry_after_move(node_id, -displacement);
+            gradient.area[direction] = (forward.area - backward.area)/(2*step);
+            gradient.volume[direction] = (forward.volume - backward.volume)/(2*step);
+            gradient.unit_bending_energy[direction] = (forward.unit_bending_energy - backward.unit_bending_energy)/(2*step);
+        }
+        return gradient;
+    }
+
     void update_two_ring_geometry_on_a_boundary_free_triangulation(Index node_id){
         update_bulk_node_geometry(node_id);
         for (auto nn_id: nodes_.nn_ids(node_id)) {
@@ -978,9 +1624,8 @@ private:
     }
 
     //unit tested
-    void scale_all_nodes_to_R_init()
+    void scale_all_nodes_to_R_init() requires (triangulation_type==SPHERICAL_TRIANGULATION)
     {
-        static_assert(triangulation_type==SPHERICAL_TRIANGULATION, "This function is only well defined for a spherical triangulation");
         vec3<Real> diff;
         vec3<Real> mass_center = calculate_mass_center();
         for (Index i = 0; i<nodes_.size(); ++i) {
@@ -1064,7 +1709,7 @@ private:
     }
 
     //unit tested
-    void orient_surface_of_a_sphere()
+    void orient_surface_of_a_sphere() requires (triangulation_type==SPHERICAL_TRIANGULATION)
     {
         /**
          * If the initial configuration is spherical, then this function can orient the surface, such
@@ -1076,7 +1721,6 @@ private:
          * a correct cycle every time but not in the same strict order, they might differ by an even
          * permutation. I.e. the ordering {1,2,3,4,5,6} and {6,1,2,3,4,5} are equivalent results.
          */
-        static_assert(triangulation_type==SPHERICAL_TRIANGULATION, "This function is only well defined for a spherical triangulation");
         std::vector<Index> nn_ids_temp;
         vec3<Real> li0, li1;
         vec3<Real> mass_center = calculate_mass_center();
@@ -1091,7 +1735,7 @@ private:
         }
     }
 
-    void orient_plane()
+    void orient_plane() requires (triangulation_type==EXPERIMENTAL_PLANAR_TRIANGULATION)
         {
             /**
              * If the initial configuration is spherical, then this function can orient the surface, such
@@ -1103,7 +1747,6 @@ private:
              * a correct cycle every time but not in the same strict order, they might differ by an even
              * permutation. I.e. the ordering {1,2,3,4,5,6} and {6,1,2,3,4,5} are equivalent results.
              */
-            static_assert(triangulation_type == EXPERIMENTAL_PLANAR_TRIANGULATION, "This function is only well defined for a planar triangulation");
             std::vector<Index> nn_ids_temp;
             vec3<Real> li0, li1;
             vec3<Real> mass_center = calculate_mass_center();
@@ -1126,6 +1769,7 @@ private:
     // Todo unittest
     void initiate_distance_vectors()
     {
+        nodes_.reserve_nn_capacity(static_cast<Index>(RESERVED_NN_CAPACITY));
         for (Node<Real, Index>& node: nodes_.data) {
             node.nn_distances.resize(node.nn_ids.size());
             update_nn_distance_vectors(node.id);
@@ -1147,6 +1791,16 @@ private:
         return res;
     }
 
+    //! Counts the common next neighbors of two nodes, without allocating memory like common_neighbours(Index, Index) does.
+    [[nodiscard]] Index common_neighbour_count(Index node_id_0, Index node_id_1) const
+    {
+        Index count = 0;
+        for (auto const& n0_nn_id: nodes_.nn_ids(node_id_0)) {
+            if (is_member(nodes_.nn_ids(node_id_1), n0_nn_id)) { ++count; }
+        }
+        return count;
+    }
+
     //unit tested
     std::array<Index, 2> two_common_neighbours(Index node_id_0, Index node_id_1) const
     {
@@ -1167,13 +1821,9 @@ private:
 
     std::array<Index, 2> fast_two_common_neighbours(Index node_id_0, Index node_id_1) const
     {
-
-        Index j = nodes_.find_nns_loc_idx(node_id_0, node_id_1);
-        indexing_number auto nn_number = (Index)nodes_.nn_ids(node_id_0).size();
-        Index j_p_1 = Neighbors<Index>::plus_one(j, nn_number);
-        Index j_m_1 = Neighbors<Index>::plus_one(j, nn_number);
-        std::array<Index, 2> res{nodes_.nn_id(node_id_0,j_m_1),
-                nodes_.nn_id(node_id_0,j_p_1)};
+        Neighbors<Index> const j = previous_and_next_neighbour_local_ids(node_id_0, node_id_1);
+        std::array<Index, 2> res{nodes_.nn_id(node_id_0, j.j_m_1),
+                nodes_.nn_id(node_id_0, j.j_p_1)};
         return res;
     }
 
@@ -1240,6 +1890,111 @@ private:
         global_geometry_ += lg_new - lg_old;
     }
 
+    //! Records the current geometry of every node as already accounted for in the global geometry.
+    void reset_dirty_region_tracking()
+    {
+        accounted_geometry_.resize(nodes_.size());
+        for (auto const& node: nodes_) { accounted_geometry_[node.id] = Geometry<Real, Index>(node); }
+        is_dirty_.assign(nodes_.size(), false);
+        dirty_nodes_ids_.clear();
+    }
+
+    void mark_dirty(Index node_id)
+    {
+        if (!is_dirty_[node_id]) {
+            is_dirty_[node_id] = true;
+            dirty_nodes_ids_.push_back(node_id);
+        }
+    }
+
+    void mark_two_ring_dirty(Index node_id)
+    {
+        mark_dirty(node_id);
+        for (auto nn_id: nodes_.nn_ids(node_id)) { mark_dirty(nn_id); }
+    }
+
+    void mark_diamond_dirty(Index node_id, Index nn_id, Index cnn_0, Index cnn_1)
+    {
+        mark_dirty(node_id);
+        mark_dirty(nn_id);
+        mark_dirty(cnn_0);
+        mark_dirty(cnn_1);
+    }
+
+    //! Collects the union of the two-rings of the given nodes into moved_region_ids_, without duplicates.
+    void collect_moved_region(std::span<Index const> node_ids)
+    {
+        is_in_moved_region_.resize(nodes_.size(), false);
+        moved_region_ids_.clear();
+        auto add_to_region = [this](Index node_id) {
+            if (!is_in_moved_region_[node_id]) {
+                is_in_moved_region_[node_id] = true;
+                moved_region_ids_.push_back(node_id);
+            }
+        };
+        for (Index node_id: node_ids) {
+            add_to_region(node_id);
+            for (Index nn_id: nodes_.nn_ids(node_id)) { add_to_region(nn_id); }
+        }
+        for (Index region_node_id: moved_region_ids_) { is_in_moved_region_[region_node_id] = false; }
+    }
+
+    //! Recalculates the geometry of a single node, with the update that fits its position in the triangulation.
+    void update_node_geometry(Index node_id)
+    {
+        if (is_boundary_node(node_id)) { update_boundary_node_geometry(node_id); }
+        else { update_bulk_node_geometry(node_id); }
+    }
+
+    //! Implementation of move_nodes. `for_each_chunk(n_chunks, task)` has to call `task(chunk)` once for every chunk.
+    template<typename ForEachChunk>
+    void move_nodes_in_chunks(std::span<Index const> node_ids, std::span<vec3<Real> const> displacement_vectors,
+                              ForEachChunk const& for_each_chunk)
+    {
+        FLIPPY_PROFILE_SCOPE("Triangulation::move_nodes");
+        collect_moved_region(node_ids);
+        for (std::size_t i = 0; i<node_ids.size(); ++i) { nodes_.displace(node_ids[i], displacement_vectors[i]); }
+        std::size_t const n_chunks = (moved_region_ids_.size() + move_nodes_chunk_size - 1)/move_nodes_chunk_size;
+        chunk_geometry_changes_.assign(n_chunks, Geometry<Real, Index>{});
+        for_each_chunk(n_chunks, [this](std::size_t chunk) {
+            std::size_t const chunk_end = std::min(moved_region_ids_.size(), (chunk + 1)*move_nodes_chunk_size);
+            Geometry<Real, Index> change{};
+            for (std::size_t i = chunk*move_nodes_chunk_size; i<chunk_end; ++i) {
+                Index const node_id = moved_region_ids_[i];
+                Geometry<Real, Index> const old_geometry(nodes_[node_id]);
+                update_node_geometry(node_id);
+                change += Geometry<Real, Index>(nodes_[node_id]) - old_geometry;
+            }
+            chunk_geometry_changes_[chunk] = change;
+        });
+        if (lazy_global_geometry_) {
+            for (Index region_node_id: moved_region_ids_) { mark_dirty(region_node_id); }
+        }
+        else if (n_chunks>0) {
+            // the partial changes are summed in a fixed pairwise tree over the chunks, which bounds the rounding error
+            // and does not depend on the number of threads
+            for (std::size_t stride = 1; stride<n_chunks; stride *= 2) {
+                for (std::size_t chunk = 0; chunk + stride<n_chunks; chunk += 2*stride) {
+                    chunk_geometry_changes_[chunk] += chunk_geometry_changes_[chunk + stride];
+                }
+            }
+            update_global_geometry(Geometry<Real, Index>{}, chunk_geometry_changes_.front());
+        }
+    }
+
+    //! Re-sums the contributions of the dirty nodes into the global geometry and marks them clean.
+    void update_dirty_global_geometry() const
+    {
+        FLIPPY_PROFILE_SCOPE("Triangulation::update_dirty_global_geometry");
+        for (auto node_id: dirty_nodes_ids_) {
+            Geometry<Real, Index> current(nodes_[node_id]);
+            global_geometry_ += current - accounted_geometry_[node_id];
+            accounted_geometry_[node_id] = current;
+            is_dirty_[node_id] = false;
+        }
+        dirty_nodes_ids_.clear();
+    }
+
     // Todo unittest
     void delete_connection_between_nodes_of_old_edge(Index old_node_id0, Index old_node_id1)
     {
@@ -1247,6 +2002,18 @@ private:
         nodes_[old_node_id1].pop_nn(old_node_id0);
     }
 
+    //! Accounts for the flip of a diamond in the global geometry, either directly or by marking the diamond dirty.
+    void update_global_diamond_geometry(Index node_id, Index nn_id, Index cnn_0, Index cnn_1)
+    {
+        if (lazy_global_geometry_) {
+            mark_diamond_dirty(node_id, nn_id, cnn_0, cnn_1);
+        }
+        else {
+            post_update_geometry = calculate_diamond_geometry(node_id, nn_id, cnn_0, cnn_1);
+            update_global_geometry(pre_update_geometry, post_update_geometry);
+        }
+    }
+
     static Nodes<Real, Index> triangulate_sphere_nodes(Index n_iter){
         std::unordered_map<std::string,fp::implementation::SimpleNodeData<Real, Index>> simpleNodeData =
                 fp::implementation::IcosahedronSubTriangulation<Real,Index>::make_corner_nodes();
@@ -1278,8 +2045,8 @@ private:
         for(Index node_id=0; node_id<N_nodes; ++node_id){
             node.id = node_id;
             node.pos = fp::vec3<Real>{
-                    triang.id_to_j(node_id)*length/n_length,
-                    triang.id_to_i(node_id)*width/n_width,
+                    static_cast<Real>(triang.id_to_j(node_id))*length/static_cast<Real>(n_length),
+                    static_cast<Real>(triang.id_to_i(node_id))*width/static_cast<Real>(n_width),
                     0.
             };
 
@@ -1306,15 +2073,15 @@ private:
                     Neighbors<Index> common_nns = previous_and_next_neighbour_global_ids(node_id, nn_id);
                     Real bond_length_square = (nodes_.pos(common_nns.j_m_1) - nodes_.pos(common_nns.j_p_1)).norm_square();
                     if ((bond_length_square < max_bond_length_square) && (bond_length_square > min_bond_length_square)) {
-                        if (common_neighbours(node_id, nn_id).size() == 2) {
-                            pre_update_geometry = calculate_diamond_geometry(node_id, nn_id, common_nns.j_m_1,
-                                                                             common_nns.j_p_1);
+                        if (common_neighbour_count(node_id, nn_id) == 2) {
+                            if (!lazy_global_geometry_) {
+                                pre_update_geometry = calculate_diamond_geometry(node_id, nn_id, common_nns.j_m_1,
+                                                                                 common_nns.j_p_1);
+                            }
                             bfd = flip_bond_unchecked(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
-                            if (common_neighbours(bfd.common_nn_0, bfd.common_nn_1).size() == 2) {
+                            if (common_neighbour_count(bfd.common_nn_0, bfd.common_nn_1) == 2) {
                                 update_diamond_geometry(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
-                                post_update_geometry = calculate_diamond_geometry(node_id, nn_id, common_nns.j_m_1,
-                                                                                  common_nns.j_p_1);
-                                update_global_geometry(pre_update_geometry, post_update_geometry);
+                                update_global_diamond_geometry(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
                             } else {
                                 flip_bond_unchecked(bfd.common_nn_0, bfd.common_nn_1, nn_id, node_id);
                                 bfd.flipped = false;
@@ -1333,14 +2100,14 @@ private:
         BondFlipData<Index> bfd{};
         Real bond_length_square = (nodes_.pos(common_nns.j_m_1) - nodes_.pos(common_nns.j_p_1)).norm_square();
         if ((bond_length_square<max_bond_length_square) && (bond_length_square>min_bond_length_square)) {
-            if (common_neighbours(node_id, nn_id).size() == 2) {
-                pre_update_geometry = calculate_diamond_geometry(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
+            if (common_neighbour_count(node_id, nn_id) == 2) {
+                if (!lazy_global_geometry_) {
+                    pre_update_geometry = calculate_diamond_geometry(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
+                }
                 bfd = flip_bond_unchecked(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
-                if (common_neighbours(bfd.common_nn_0, bfd.common_nn_1).size() == 2) {
+                if (common_neighbour_count(bfd.common_nn_0, bfd.common_nn_1) == 2) {
                     update_diamond_geometry(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
-                    post_update_geometry = calculate_diamond_geometry(node_id, nn_id, common_nns.j_m_1,
-                                                                      common_nns.j_p_1);
-                    update_global_geometry(pre_update_geometry, post_update_geometry);
+                    update_global_diamond_geometry(node_id, nn_id, common_nns.j_m_1, common_nns.j_p_1);
                 }
                 else {
                     flip_bond_unchecked(bfd.common_nn_0, bfd.common_nn_1, nn_id, node_id);
@@ -1353,6 +2120,18 @@ private:
 
 };
 
+#ifdef FLIPPY_EXTERN_TEMPLATES
+// instantiated once in flippy.cpp, see flippy.hpp
+extern template class Triangulation<double, std::uint32_t, SPHERICAL_TRIANGULATION>;
+extern template class Triangulation<double, std::uint64_t, SPHERICAL_TRIANGULATION>;
+extern template class Triangulation<float, std::uint32_t, SPHERICAL_TRIANGULATION>;
+extern template class Triangulation<float, std::uint64_t, SPHERICAL_TRIANGULATION>;
+extern template class Triangulation<double, std::uint32_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+extern template class Triangulation<double, std::uint64_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+extern template class Triangulation<float, std::uint32_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+extern template class Triangulation<float, std::uint64_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+#endif
+
 }
 #endif //FLIPPY_TRIANGULATION_HPP
 
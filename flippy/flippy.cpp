@@ -0,0 +1,31 @@
+/**
+ * @file
+ * @brief Explicit instantiations of the flippy class templates for the common number types, which make up the
+ * optional compiled flippy library.
+ *
+ * Programs that link against the library and define `FLIPPY_EXTERN_TEMPLATES` do not instantiate these classes
+ * themselves, see flippy.hpp.
+ */
+#include <cstdint>
+#include "flippy.hpp"
+
+namespace fp {
+
+template class vec3<double>;
+template class vec3<float>;
+
+template struct Nodes<double, std::uint32_t>;
+template struct Nodes<double, std::uint64_t>;
+template struct Nodes<float, std::uint32_t>;
+template struct Nodes<float, std::uint64_t>;
+
+template class Triangulation<double, std::uint32_t, SPHERICAL_TRIANGULATION>;
+template class Triangulation<double, std::uint64_t, SPHERICAL_TRIANGULATION>;
+template class Triangulation<float, std::uint32_t, SPHERICAL_TRIANGULATION>;
+template class Triangulation<float, std::uint64_t, SPHERICAL_TRIANGULATION>;
+template class Triangulation<double, std::uint32_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+template class Triangulation<double, std::uint64_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+template class Triangulation<float, std::uint32_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+template class Triangulation<float, std::uint64_t, EXPERIMENTAL_PLANAR_TRIANGULATION>;
+
+}
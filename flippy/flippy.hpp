@@ -44,16 +44,41 @@
 /**
  * @file
  * @brief This header file exists for convenience. Including this header will automatically include all parts of flippy in the project.
+ *
+ * flippy is header-only, but it can also be linked as a compiled library, which is built by the `flippy` target of
+ * flippy/CMakeLists.txt from flippy.cpp. The library contains explicit instantiations of vec3, Nodes and Triangulation
+ * for `double` and `float` coordinates, `std::uint32_t` and `std::uint64_t` indices, and spherical and planar
+ * triangulations. If `FLIPPY_EXTERN_TEMPLATES` is defined in all translation units of a program (the `flippy` target
+ * does this for the programs that link against it), the headers declare these instantiations `extern`, so the program
+ * does not compile them again. Other number types, and the class templates that depend on user types, like
+ * MonteCarloUpdater, are still instantiated in the program, as in the header-only mode.
+ *
+ * The core headers do not depend on the bundled json library, which is only needed by the JSON serialization in
+ * io/json.hpp. This header includes io/json.hpp, unless `FLIPPY_NO_JSON` is defined. Programs that do not read or
+ * write JSON can define it, or include the headers that they need directly, and skip the parsing of the json library.
+ * The binary serialization of io/binary.hpp does not need any external library.
  */
 #ifndef FLIPPY_FLIPPY_HPP
 #define FLIPPY_FLIPPY_HPP
 
-#include "external/json.hpp"
 #include "custom_concepts.hpp"
 #include "vec3.hpp"
 #include "utilities/utils.hpp"
+#include "utilities/profiler.hpp"
 #include "Nodes.hpp"
 #include "Triangulation.hpp"
+#include "AnnealingSchedule.hpp"
 #include "MonteCarloUpdater.hpp"
+#include "Minimizer.hpp"
+#include "utilities/fenwick_tree.hpp"
+#include "utilities/random_engines.hpp"
+#include "KineticFlipUpdater.hpp"
+#include "utilities/parallel.hpp"
+#include "Ensemble.hpp"
+#include "ReplicaExchange.hpp"
+#include "io/binary.hpp"
+#ifndef FLIPPY_NO_JSON
+#include "io/json.hpp"
+#endif
 
 #endif //FLIPPY_FLIPPY_HPP
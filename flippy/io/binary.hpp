@@ -0,0 +1,221 @@
+#ifndef FLIPPY_IO_BINARY_HPP
+#define FLIPPY_IO_BINARY_HPP
+/**
+ * @file
+ * @brief This file contains a compact binary serialization of flippy's node collections, which does not need any
+ * external library.
+ *
+ * Binary egg data is much smaller than the JSON serialization of flippy/io/json.hpp, and it is written and read much
+ * faster, since the numbers are stored in their memory representation instead of as text. In turn, it is not human
+ * readable, and it can only be read on machines with the same byte order as the machine that wrote it.
+ */
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../Nodes.hpp"
+
+namespace fp::io {
+
+//! Binary serialization of a node collection, which is created by BinaryNodesSerializer.
+struct BinaryEggData
+{
+    std::vector<std::uint8_t> bytes{}; //!< The serialized data.
+    bool operator==(BinaryEggData const& other) const = default;
+};
+
+//! Serializes a node collection to a compact binary format.
+/**
+ * The data starts with a header that contains the four characters `FLPY`, the format #version as a 32 bit integer,
+ * the size in bytes of the floating point and the index types of the nodes, and the number of nodes as a 64 bit integer.
+ * Then, for every node in the order of the node ids, follow its id, area, volume, unit bending energy, position,
+ * curvature vector, the number of its next neighbors as a 64 bit integer followed by their ids, and the number of its
+ * Verlet list neighbors as a 64 bit integer followed by their ids. All numbers are stored in the byte order of the
+ * machine. The floating point type can be `float`, `double` or `long double`, and the index type can be any unsigned
+ * integer type of 1, 2, 4 or 8 bytes. Data can be read into any of these types, but `long double` data can only be read
+ * on machines with the same `long double` representation, and reading it into a smaller type rounds it.
+ */
+struct BinaryNodesSerializer
+{
+    using egg_data_type = BinaryEggData;
+    //! Version of the binary format, which is stored in the header.
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::array<char, 4> magic{'F', 'L', 'P', 'Y'};
+
+    //! Whether the number types can be stored, which excludes e.g. 2 byte floating point types.
+    template<floating_point_number Real, indexing_number Index>
+    static constexpr bool supports_number_types = (std::is_same_v<Real, float> || std::is_same_v<Real, double> || std::is_same_v<Real, long double>)
+                                                  && (sizeof(Index)==1 || sizeof(Index)==2 || sizeof(Index)==4 || sizeof(Index)==8);
+
+    //! Serialize a node collection to binary data.
+    template<floating_point_number Real, indexing_number Index>
+    requires supports_number_types<Real, Index>
+    static BinaryEggData write(Nodes<Real, Index> const& nodes)
+    {
+        BinaryEggData egg;
+        std::size_t n_bytes = magic.size() + sizeof(version) + 2 + sizeof(std::uint64_t);
+        for (auto const& node: nodes) {
+            n_bytes += sizeof(Index) + 9*sizeof(Real) + 2*sizeof(std::uint64_t) + (node.nn_ids.size() + node.verlet_list.size())*sizeof(Index);
+        }
+        egg.bytes.reserve(n_bytes);
+        for (char c: magic) { append(egg, c); }
+        append(egg, version);
+        append(egg, static_cast<std::uint8_t>(sizeof(Real)));
+        append(egg, static_cast<std::uint8_t>(sizeof(Index)));
+        append(egg, static_cast<std::uint64_t>(nodes.size()));
+        for (auto const& node: nodes) {
+            append(egg, node.id);
+            append(egg, node.area);
+            append(egg, node.volume);
+            append(egg, node.unit_bending_energy);
+            for (Real coordinate: {node.pos.x, node.pos.y, node.pos.z}) { append(egg, coordinate); }
+            for (Real coordinate: {node.curvature_vec.x, node.curvature_vec.y, node.curvature_vec.z}) { append(egg, coordinate); }
+            append(egg, static_cast<std::uint64_t>(node.nn_ids.size()));
+            for (Index nn_id: node.nn_ids) { append(egg, nn_id); }
+            append(egg, static_cast<std::uint64_t>(node.verlet_list.size()));
+            for (Index verlet_id: node.verlet_list) { append(egg, verlet_id); }
+        }
+        return egg;
+    }
+
+    //! Initiating nodes from binary data that was created by write().
+    /**
+     * @param egg binary data of a node collection.
+     * @throws std::runtime_error if the data is not in the binary format of this version, or if it is truncated.
+     */
+    template<floating_point_number Real, indexing_number Index>
+    static Nodes<Real, Index> read(BinaryEggData const& egg)
+    {
+        Reader reader{egg.bytes};
+        std::array<char, 4> stored_magic{};
+        for (char& c: stored_magic) { c = reader.next<char>(); }
+        if (stored_magic!=magic) { throw std::runtime_error("The data is not flippy binary egg data."); }
+        if (reader.next<std::uint32_t>()!=version) {
+            throw std::runtime_error("The flippy binary egg data has an unknown format version.");
+        }
+        reader.real_size = reader.next<std::uint8_t>();
+        reader.index_size = reader.next<std::uint8_t>();
+        if ((reader.real_size!=4 && reader.real_size!=8 && reader.real_size!=sizeof(long double))
+            || (reader.index_size!=1 && reader.index_size!=2 && reader.index_size!=4 && reader.index_size!=8)) {
+            throw std::runtime_error("The flippy binary egg data has unsupported number types.");
+        }
+        auto const n_nodes = static_cast<std::size_t>(reader.next<std::uint64_t>());
+        std::vector<Node<Real, Index>> data(n_nodes);
+        for (std::size_t i = 0; i<n_nodes; ++i) {
+            auto const node_index = reader.index<Index>();
+            if (static_cast<std::size_t>(node_index)>=n_nodes) { throw std::runtime_error("The flippy binary egg data contains an invalid node id."); }
+            Node<Real, Index>& node = data[static_cast<std::size_t>(node_index)];
+            node.id = node_index;
+            node.area = reader.real<Real>();
+            node.volume = reader.real<Real>();
+            node.unit_bending_energy = reader.real<Real>();
+            for (Real* coordinate: {&node.pos.x, &node.pos.y, &node.pos.z}) { *coordinate = reader.real<Real>(); }
+            for (Real* coordinate: {&node.curvature_vec.x, &node.curvature_vec.y, &node.curvature_vec.z}) { *coordinate = reader.real<Real>(); }
+            node.nn_ids.resize(reader.size());
+            for (Index& nn_id: node.nn_ids) { nn_id = reader.index<Index>(); }
+            node.verlet_list.resize(reader.size());
+            for (Index& verlet_id: node.verlet_list) { verlet_id = reader.index<Index>(); }
+        }
+        return Nodes<Real, Index>(std::move(data));
+    }
+
+private:
+    template<typename T>
+    static void append(BinaryEggData& egg, T value)
+    {
+        std::array<std::uint8_t, sizeof(T)> value_bytes{};
+        std::memcpy(value_bytes.data(), &value, sizeof(T));
+        egg.bytes.insert(egg.bytes.end(), value_bytes.begin(), value_bytes.end());
+    }
+
+    //! Reads the numbers of binary egg data one after the other.
+    struct Reader
+    {
+        std::vector<std::uint8_t> const& bytes;
+        std::size_t position{0};
+        std::uint8_t real_size{8}, index_size{8};
+
+        template<typename T>
+        T next()
+        {
+            if (bytes.size() - position<sizeof(T)) {
+                throw std::runtime_error("The flippy binary egg data is truncated.");
+            }
+            T value;
+            std::memcpy(&value, bytes.data() + position, sizeof(T));
+            position += sizeof(T);
+            return value;
+        }
+
+        template<floating_point_number Real>
+        Real real()
+        {
+            switch (real_size) {
+                case 4: return static_cast<Real>(next<float>());
+                case 8: return static_cast<Real>(next<double>());
+                default: return static_cast<Real>(next<long double>());
+            }
+        }
+
+        template<indexing_number Index>
+        Index index()
+        {
+            switch (index_size) {
+                case 1: return static_cast<Index>(next<std::uint8_t>());
+                case 2: return static_cast<Index>(next<std::uint16_t>());
+                case 4: return static_cast<Index>(next<std::uint32_t>());
+                default: return static_cast<Index>(next<std::uint64_t>());
+            }
+        }
+
+        std::size_t size()
+        {
+            auto const n = static_cast<std::size_t>(next<std::uint64_t>());
+            // every element takes at least index_size bytes, which guards against allocating for corrupted sizes
+            if (n>(bytes.size() - position)/index_size) { throw std::runtime_error("The flippy binary egg data is truncated."); }
+            return n;
+        }
+    };
+};
+
+/**
+ * @brief Write binary egg data to a file.
+ * @param file_name @FileNameOrPathFileNameStub The extension `.egg` is appended.
+ * @param data binary data that is supposed to be stored.
+ */
+static inline void binary_dump(std::string const& file_name, BinaryEggData const& data)
+{
+    std::ofstream o(file_name + ".egg", std::ios::binary);
+    o.write(reinterpret_cast<char const*>(data.bytes.data()), static_cast<std::streamsize>(data.bytes.size()));
+}
+
+/**
+ * @brief Read binary egg data from a file that was written by binary_dump().
+ * @param file_name @FileNameOrPathFileNameStub The extension `.egg` is appended if it is missing.
+ * @return The content of the file.
+ */
+static inline BinaryEggData binary_read(std::string file_name)
+{
+    if (!file_name.ends_with(".egg")) { file_name += ".egg"; }
+    std::ifstream o(file_name, std::ios::binary);
+    if (!o) { throw std::runtime_error("Could not open " + file_name + "."); }
+    return BinaryEggData{std::vector<std::uint8_t>(std::istreambuf_iterator<char>(o), std::istreambuf_iterator<char>())};
+}
+
+}
+
+namespace fp {
+//! Binary egg data is read by io::BinaryNodesSerializer.
+template<>
+struct egg_data_serializer<io::BinaryEggData>
+{
+    using type = io::BinaryNodesSerializer;
+};
+}
+#endif //FLIPPY_IO_BINARY_HPP
@@ -0,0 +1,144 @@
+#ifndef FLIPPY_IO_JSON_HPP
+#define FLIPPY_IO_JSON_HPP
+/**
+ * @file
+ * @brief This file contains the JSON serialization of flippy, which is the only part of flippy that needs the bundled
+ * [nlohmann::json](https://github.com/nlohmann/json) library.
+ *
+ * The core headers do not include this file, so translation units that do not read or write JSON do not have to parse
+ * the json library. flippy.hpp includes it, unless `FLIPPY_NO_JSON` is defined.
+ */
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../external/json.hpp"
+#include "../Nodes.hpp"
+
+namespace fp {
+/**
+ * @GlobalsStub
+ * @{
+ */
+//! shortening of the nlohmann::json namespace, which is an [external open source library](https://github.com/nlohmann/json) bundled by flippy.
+using Json = nlohmann::json;
+
+/**
+ * @brief Simple wrapper function around Json objects built in dump() method.
+ * @param file_name @FileNameOrPathFileNameStub
+ * @param data json data object that is supposed to be stored.
+ */
+static inline void json_dump(std::string const& file_name, const Json& data)
+{
+    std::ofstream o(file_name + ".json");
+    o << data.dump();
+    o.close();
+}
+
+/**
+ * @brief Simple wrapper function  that reads the content of a text file into a json object.
+ *
+ * The file name onb the disk needs to end in '.json' for this function to work.
+ * @param file_name @FileNameOrPathFileNameStub
+ * @return Json object that was parsed from the provided file.
+ *
+ * @warning This function will stream any file into the json object.
+ * If the provided file is not a valid json file this will cause runtime errors.
+ */
+static Json inline json_read(std::string file_name)
+{
+    auto pos_json = file_name.find_last_of(".json");
+    auto not_json = (file_name.size() - 1!=pos_json);
+    if (not_json) { file_name = file_name + ".json"; }
+    std::ifstream o(file_name);
+    Json data;
+    o >> data;
+    o.close();
+    return data;
+}
+/**@}*/
+
+namespace io {
+
+//! Serializes a node collection to a JSON object, which maps the id of every node to its data.
+/**
+ * This is the default serializer of Nodes::make_data() and Triangulation::make_egg_data(). The JSON objects can be
+ * stored with json_dump() and read by the constructors of Nodes and Triangulation.
+ */
+struct JsonNodesSerializer
+{
+    using egg_data_type = Json;
+
+    //! Serialize a node collection to a JSON object.
+    template<floating_point_number Real, indexing_number Index>
+    static Json write(Nodes<Real, Index> const& nodes)
+    {
+        Json json_data;
+        for (auto& node : nodes) {
+            json_data[std::to_string(node.id)] = {
+                    {"area", node.area},
+                    {"volume", node.volume},
+                    {"unit_bending_energy", node.unit_bending_energy},
+                    {"pos", {node.pos[0], node.pos[1], node.pos[2]}},
+                    {"curvature_vec", {node.curvature_vec[0], node.curvature_vec[1], node.curvature_vec[2]}},
+                    {"nn_ids", node.nn_ids},
+                    {"verlet_list", node.verlet_list},
+            };
+        }
+        return json_data;
+    }
+
+    //! Initiating nodes from a JSON object of a node collection.
+    /**
+     * The nodes in the JSON file must be sequentially numbered from 0 to Number_of_nodes - 1.
+     * @param node_dict JSON object that contains a collection of nodes.
+     * @warning If the JSON object is malformed, then the function will fail and propagate a runtime error from the JSON parser.
+     */
+    template<floating_point_number Real, indexing_number Index>
+    static Nodes<Real, Index> read(Json const& node_dict)
+    {
+        std::vector<Node<Real, Index>> data(node_dict.size());
+        std::vector<Index> nn_ids_temp, verlet_list_temp;
+        for (auto const& node: node_dict.items()) {
+            auto const& node_id = node.key();
+            fp::indexing_number auto node_index = static_cast<Index>(std::stol(node_id));
+            auto const& raw_pos = node.value()["pos"];
+            vec3<Real> pos{(Real) raw_pos[0], (Real) raw_pos[1], (Real) raw_pos[2]};
+
+            auto const& raw_curv = node.value()["curvature_vec"];
+            vec3<Real> curvature_vec{(Real) raw_curv[0], (Real) raw_curv[1], (Real) raw_curv[2]};
+            Real unit_bending_energy = node.value()["unit_bending_energy"];
+            Real area = node.value()["area"];
+            Real volume = node.value()["volume"];
+
+            nn_ids_temp = node_dict[node_id]["nn_ids"].template get<std::vector<Index>>();
+            verlet_list_temp = node_dict[node_id]["verlet_list"].template get<std::vector<Index>>();
+            std::vector<vec3<Real>> nn_distances;
+
+            data[static_cast<size_t>(node_index)] = Node<Real, Index>{
+                    .id{node_index},
+                    .area{area},
+                    .volume{volume},
+                    .unit_bending_energy{unit_bending_energy},
+                    .pos{pos},
+                    .curvature_vec{curvature_vec},
+                    .nn_ids{nn_ids_temp},
+                    .nn_distances{nn_distances},
+                    .verlet_list{verlet_list_temp}
+            };
+        }
+        return Nodes<Real, Index>(std::move(data));
+    }
+};
+
+}
+
+//! JSON objects are read by io::JsonNodesSerializer.
+template<>
+struct egg_data_serializer<Json>
+{
+    using type = io::JsonNodesSerializer;
+};
+
+}
+#endif //FLIPPY_IO_JSON_HPP
@@ -0,0 +1,97 @@
+#ifndef FLIPPY_FENWICK_TREE_HPP
+#define FLIPPY_FENWICK_TREE_HPP
+/** @file
+ *  @brief This file contains a Fenwick tree (binary indexed tree) of non-negative weights, which is used to draw
+ *  events with a probability proportional to their rate.
+ */
+
+#include <vector>
+#include <cstddef>
+#include "../custom_concepts.hpp"
+
+namespace fp {
+
+/**
+ * @brief Fenwick tree over non-negative weights.
+ *
+ * Setting a weight, the total weight, and finding the entry that belongs to a point of the cumulative weight all cost
+ * \f$O(\log n)\f$ operations. Since the weights are updated incrementally, rounding errors accumulate in the partial sums.
+ * They can be removed by rebuilding the tree with assign().
+ *
+ * @tparam Real @RealStub
+ */
+template<floating_point_number Real>
+class FenwickTree
+{
+private:
+    std::vector<Real> weights_{}, tree_{};
+
+    void add(std::size_t i, Real delta)
+    {
+        for (++i; i<=tree_.size(); i += i & (~i + 1)) { tree_[i - 1] += delta; }
+    }
+
+public:
+    FenwickTree() = default;
+
+    //! Tree of `size` weights that are all zero.
+    explicit FenwickTree(std::size_t size) :weights_(size, 0), tree_(size, 0) { }
+
+    //! Replaces all weights and rebuilds the tree in \f$O(n)\f$ operations.
+    void assign(std::vector<Real> const& weights)
+    {
+        weights_ = weights;
+        tree_ = weights;
+        for (std::size_t i = 1; i<=tree_.size(); ++i) {
+            std::size_t const parent = i + (i & (~i + 1));
+            if (parent<=tree_.size()) { tree_[parent - 1] += tree_[i - 1]; }
+        }
+    }
+
+    //! Sets the weight of entry `i`.
+    void set(std::size_t i, Real weight)
+    {
+        add(i, weight - weights_[i]);
+        weights_[i] = weight;
+    }
+
+    //! Weight of entry `i`.
+    [[nodiscard]] Real weight(std::size_t i) const { return weights_[i]; }
+
+    //! Sum of the weights of the entries `[0, i)`.
+    [[nodiscard]] Real prefix_sum(std::size_t i) const
+    {
+        Real sum = 0;
+        for (; i>0; i -= i & (~i + 1)) { sum += tree_[i - 1]; }
+        return sum;
+    }
+
+    //! Sum of all weights.
+    [[nodiscard]] Real total() const { return prefix_sum(tree_.size()); }
+
+    //! Entry whose cumulative weight interval contains `target`.
+    /**
+     * @param target a value in `[0, total())`.
+     * @return The smallest `i` for which `prefix_sum(i+1)>target`. Entries with zero weight are never returned, as long
+     * as `target` is inside the valid range. Values outside the range are clamped to the last entry with a positive weight.
+     */
+    [[nodiscard]] std::size_t find(Real target) const
+    {
+        std::size_t position = 0, step = 1;
+        while (step*2<=tree_.size()) { step *= 2; }
+        for (; step>0; step /= 2) {
+            if (position + step<=tree_.size() && tree_[position + step - 1]<=target) {
+                position += step;
+                target -= tree_[position - 1];
+            }
+        }
+        while (position>0 && (position>=weights_.size() || weights_[position]<=0)) { --position; }
+        return position;
+    }
+
+    //! Number of entries.
+    [[nodiscard]] std::size_t size() const { return weights_.size(); }
+};
+
+}
+#endif //FLIPPY_FENWICK_TREE_HPP
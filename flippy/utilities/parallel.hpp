@@ -0,0 +1,137 @@
+#ifndef FLIPPY_PARALLEL_HPP
+#define FLIPPY_PARALLEL_HPP
+/** @file
+ *  @brief This file contains a small thread pool that is used by flippy's multi-threaded drivers.
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+namespace fp {
+
+/**
+ * @brief A fixed size pool of worker threads that executes parallel loops.
+ *
+ * The threads are created once, during the construction of the pool, and are reused by every call of parallel_for.
+ * The calling thread takes part in the work, i.e. a pool of size `n` starts `n-1` additional threads.
+ * Tasks are handed out one at a time through an atomic counter, so tasks that take different amounts of time are
+ * still balanced between the threads.
+ *
+ * @warning parallel_for must not be called from inside a task that is being executed by the same pool.
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_, done_cv_;
+    std::function<void(std::size_t)> const* task_{nullptr};
+    std::size_t n_tasks_{0};
+    std::atomic<std::size_t> next_task_{0};
+    std::size_t busy_workers_{0};
+    std::uint64_t generation_{0};
+    bool stopping_{false};
+    std::exception_ptr first_exception_{nullptr};
+
+    void run_tasks()
+    {
+        for (std::size_t task_id = next_task_.fetch_add(1); task_id<n_tasks_; task_id = next_task_.fetch_add(1)) {
+            try { (*task_)(task_id); }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!first_exception_) { first_exception_ = std::current_exception(); }
+            }
+        }
+    }
+
+    void worker_loop()
+    {
+        std::uint64_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [&] { return stopping_ || generation_!=seen_generation; });
+                if (stopping_) { return; }
+                seen_generation = generation_;
+            }
+            run_tasks();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --busy_workers_;
+                if (busy_workers_==0) { done_cv_.notify_one(); }
+            }
+        }
+    }
+
+public:
+    /**
+     * @param n_threads total number of threads that work on a parallel loop, including the calling thread.
+     * If set to zero, the pool will use as many threads as the hardware supports.
+     */
+    explicit ThreadPool(unsigned n_threads = std::thread::hardware_concurrency())
+    {
+        if (n_threads==0) { n_threads = std::max(1u, std::thread::hardware_concurrency()); }
+        workers_.reserve(n_threads - 1);
+        for (unsigned i = 1; i<n_threads; ++i) { workers_.emplace_back([this] { worker_loop(); }); }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& worker: workers_) { worker.join(); }
+    }
+
+    //! Number of threads that work on a parallel loop, including the calling thread.
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers_.size() + 1); }
+
+    //! Calls `task(i)` for every `i` in `[0, n_tasks)` and returns once all calls have finished.
+    /**
+     * The order in which the tasks are executed, and the thread that executes them, are not specified.
+     * If a task throws, the remaining tasks are still executed and the first exception is rethrown to the caller.
+     * @param n_tasks number of tasks.
+     * @param task callable that is invoked with the id of the task.
+     */
+    void parallel_for(std::size_t n_tasks, std::function<void(std::size_t)> const& task)
+    {
+        if (n_tasks==0) { return; }
+        bool const use_workers = !workers_.empty() && n_tasks>1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            n_tasks_ = n_tasks;
+            next_task_.store(0);
+            if (use_workers) {
+                busy_workers_ = workers_.size();
+                ++generation_;
+            }
+        }
+        if (use_workers) { work_cv_.notify_all(); }
+        run_tasks();
+        std::exception_ptr exception;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [&] { return busy_workers_==0; });
+            task_ = nullptr;
+            exception = std::exchange(first_exception_, nullptr);
+        }
+        if (exception) { std::rethrow_exception(exception); }
+    }
+};
+
+}
+#endif //FLIPPY_PARALLEL_HPP
@@ -0,0 +1,211 @@
+#ifndef FLIPPY_PROFILER_HPP
+#define FLIPPY_PROFILER_HPP
+/** @file
+ *  @brief This file contains a lightweight call tree profiler, which records how much time a run spends in the hot
+ *  paths of flippy.
+ *
+ *  The hot paths of Triangulation and MonteCarloUpdater are marked with the FLIPPY_PROFILE_SCOPE macro.
+ *  The macro only records anything if `FLIPPY_PROFILING` is defined before flippy is included, e.g. with
+ *  `-DFLIPPY_PROFILING` on the command line. Otherwise, it expands to nothing and costs nothing.
+ *  Since the macro changes the code of header templates, `FLIPPY_PROFILING` has to be defined consistently in all
+ *  translation units of a program.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../external/json_fwd.hpp"
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define FLIPPY_PROFILE_USE_RDTSC
+#endif
+
+namespace fp {
+
+/**
+ * @brief Call tree of the profiled scopes of one thread.
+ *
+ * Every distinct path of nested scopes is a node of the tree, which accumulates the number of calls and the time that
+ * was spent inside the scope. The profiler of a thread is returned by Profiler::thread_profiler(), so threads that run
+ * independent replicas record independent call trees and never synchronize.
+ * On x86-64 the time is measured in time stamp counter ticks, which are converted to nanoseconds with the rate of the
+ * counter relative to `std::chrono::steady_clock` since the last reset. Elsewhere, the steady clock is read directly.
+ * An enter and exit pair costs about 10 to 20 nanoseconds on x86-64, and somewhat more with the steady clock.
+ */
+class Profiler
+{
+public:
+    //! Current value of the clock of the profiler, in ticks.
+    static std::uint64_t ticks()
+    {
+#ifdef FLIPPY_PROFILE_USE_RDTSC
+        return static_cast<std::uint64_t>(__rdtsc());
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    //! A node of the call tree.
+    struct CallNode{
+        char const* name; //!< Name of the scope. It must be a string literal, or otherwise outlive the profiler.
+        std::size_t parent; //!< Index of the parent node in nodes(). The root is its own parent.
+        std::vector<std::size_t> children{}; //!< Indices of the child nodes in nodes().
+        std::uint64_t calls{0}; //!< Number of times that the scope was entered on this path.
+        std::uint64_t total_ticks{0}; //!< Time spent in the scope on this path, including the time spent in children.
+    };
+
+private:
+    std::vector<CallNode> nodes_{{.name="root", .parent=0}};
+    std::size_t current_{0};
+    std::chrono::steady_clock::time_point start_time_{std::chrono::steady_clock::now()};
+    std::uint64_t start_ticks_{ticks()};
+
+    //! Nanoseconds per tick, measured since the last reset.
+    [[nodiscard]] double ns_per_tick() const
+    {
+#ifdef FLIPPY_PROFILE_USE_RDTSC
+        auto const elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time_).count();
+        std::uint64_t const elapsed_ticks = ticks() - start_ticks_;
+        return elapsed_ticks>0 ? elapsed/static_cast<double>(elapsed_ticks) : 1.;
+#else
+        return 1.;
+#endif
+    }
+
+    [[nodiscard]] static std::uint64_t to_ns(std::uint64_t n_ticks, double ns_per_tick)
+    {
+        return static_cast<std::uint64_t>(static_cast<double>(n_ticks)*ns_per_tick);
+    }
+
+    //! Time spent in a scope itself, excluding the time spent in its child scopes.
+    [[nodiscard]] std::uint64_t self_ticks(std::size_t node_id) const
+    {
+        std::uint64_t children_ticks = 0;
+        for (std::size_t child: nodes_[node_id].children) { children_ticks += nodes_[child].total_ticks; }
+        auto const& node = nodes_[node_id];
+        return node.total_ticks>children_ticks ? node.total_ticks - children_ticks : 0;
+    }
+
+    template<typename Json>
+    [[nodiscard]] Json node_json(std::size_t node_id, double ns_per_tick) const
+    {
+        auto const& node = nodes_[node_id];
+        std::uint64_t const self_ns = to_ns(self_ticks(node_id), ns_per_tick);
+        Json data{{"name", node.name}, {"calls", node.calls}, {"total_ns", to_ns(node.total_ticks, ns_per_tick)}, {"self_ns", self_ns}};
+        data["children"] = Json::array();
+        for (std::size_t child: node.children) { data["children"].push_back(node_json<Json>(child, ns_per_tick)); }
+        return data;
+    }
+
+    void append_folded_stacks(std::size_t node_id, std::string const& prefix, double ns_per_tick, std::string& folded) const
+    {
+        std::string const stack = prefix.empty() ? std::string(nodes_[node_id].name) : prefix + ";" + nodes_[node_id].name;
+        if (std::uint64_t const ns = to_ns(self_ticks(node_id), ns_per_tick); ns>0) { folded += stack + " " + std::to_string(ns) + "\n"; }
+        for (std::size_t child: nodes_[node_id].children) { append_folded_stacks(child, stack, ns_per_tick, folded); }
+    }
+
+public:
+    //! The profiler of the calling thread.
+    static Profiler& thread_profiler()
+    {
+        thread_local Profiler profiler;
+        return profiler;
+    }
+
+    //! Descends into the child scope with the given name, and returns its index in nodes().
+    std::size_t enter(char const* name)
+    {
+        for (std::size_t child: nodes_[current_].children) {
+            if (nodes_[child].name==name || std::strcmp(nodes_[child].name, name)==0) { return current_ = child; }
+        }
+        nodes_.push_back({.name=name, .parent=current_});
+        nodes_[current_].children.push_back(nodes_.size() - 1);
+        return current_ = nodes_.size() - 1;
+    }
+
+    //! Returns to the parent of the scope `node_id` and records one call that took `elapsed_ticks`.
+    void exit(std::size_t node_id, std::uint64_t elapsed_ticks)
+    {
+        ++nodes_[node_id].calls;
+        nodes_[node_id].total_ticks += elapsed_ticks;
+        current_ = nodes_[node_id].parent;
+    }
+
+    //! Discards all recorded calls. Must not be called while a scope is open.
+    void reset()
+    {
+        nodes_ = {{.name="root", .parent=0}};
+        current_ = 0;
+        start_time_ = std::chrono::steady_clock::now();
+        start_ticks_ = ticks();
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] std::vector<CallNode> const& nodes() const { return nodes_; }
+
+    //! Call tree in JSON format.
+    /**
+     * Every node contains its `name`, the number of `calls`, the `total_ns` spent in the scope, the `self_ns` that were
+     * not spent in any of the child scopes, and the list of its `children`.
+     * The json library is only declared by this header, so the caller has to include it, e.g. with flippy/io/json.hpp.
+     */
+    template<typename Json = nlohmann::json>
+    [[nodiscard]] Json json() const
+    {
+        Json data = Json::array();
+        double const tick_ns = ns_per_tick();
+        for (std::size_t child: nodes_[0].children) { data.push_back(node_json<Json>(child, tick_ns)); }
+        return data;
+    }
+
+    //! Call tree in the folded stack format, which is read by flame graph tools.
+    /**
+     * Every line contains the names of the nested scopes separated by `;`, followed by the time in nanoseconds that was
+     * spent in the innermost scope itself, e.g. `MonteCarloUpdater::sweep;MonteCarloUpdater::move_MC_updater 123456`.
+     */
+    [[nodiscard]] std::string folded_stacks() const
+    {
+        std::string folded;
+        double const tick_ns = ns_per_tick();
+        for (std::size_t child: nodes_[0].children) { append_folded_stacks(child, "", tick_ns, folded); }
+        return folded;
+    }
+};
+
+//! Records the time between its construction and destruction as one call of a scope of the thread profiler.
+class ProfileScope
+{
+private:
+    Profiler& profiler_;
+    std::size_t node_id_;
+    std::uint64_t start_;
+
+public:
+    explicit ProfileScope(char const* name)
+            :profiler_(Profiler::thread_profiler()), node_id_(profiler_.enter(name)), start_(Profiler::ticks()) { }
+
+    ProfileScope(ProfileScope const&) = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+
+    ~ProfileScope() { profiler_.exit(node_id_, Profiler::ticks() - start_); }
+};
+
+}
+
+#define FLIPPY_PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define FLIPPY_PROFILE_CONCATENATE(a, b) FLIPPY_PROFILE_CONCATENATE_IMPL(a, b)
+#ifdef FLIPPY_PROFILING
+//! Profiles the rest of the enclosing block as a scope with the given name, if `FLIPPY_PROFILING` is defined.
+#define FLIPPY_PROFILE_SCOPE(name) fp::ProfileScope const FLIPPY_PROFILE_CONCATENATE(flippy_profile_scope_, __LINE__)(name)
+#else
+#define FLIPPY_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif //FLIPPY_PROFILER_HPP
@@ -0,0 +1,347 @@
+#ifndef FLIPPY_RANDOM_ENGINES_HPP
+#define FLIPPY_RANDOM_ENGINES_HPP
+/** @file
+ *  @brief This file contains random number engines that complement the engines of the standard library.
+ */
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include "../custom_concepts.hpp"
+
+namespace fp {
+
+//! Uniform random number in `[0, 1)` from two 32 bit random numbers, with the full resolution of the floating point type.
+/**
+ * Unlike `std::uniform_real_distribution`, the result is specified exactly, so it is the same with every standard library.
+ */
+template<floating_point_number Real>
+[[nodiscard]] constexpr Real uniform_from_bits(std::uint32_t high, std::uint32_t low)
+{
+    constexpr int digits = std::numeric_limits<Real>::digits<64 ? std::numeric_limits<Real>::digits : 64;
+    std::uint64_t const bits = ((static_cast<std::uint64_t>(high) << 32) | low) >> (64 - digits);
+    return static_cast<Real>(bits)/static_cast<Real>(std::uint64_t(1) << (digits - 1))/2;
+}
+
+//! Bound of the absolute error of approximate_log().
+inline constexpr double approximate_log_error = 1e-10;
+
+//! Natural logarithm of a positive normal number, with an absolute error below approximate_log_error.
+/**
+ * The number is split into its exponent and a mantissa in \f$[1/\sqrt{2}, \sqrt{2})\f$ with integer operations, and
+ * the logarithm of the mantissa is a polynomial in \f$s=(m-1)/(m+1)\f$. Unlike `std::log`, the function has no
+ * branches and does not set `errno`, so loops over it are vectorized by the compiler. The result for zero, subnormal,
+ * negative or non-finite numbers is unspecified.
+ */
+[[nodiscard]] constexpr double approximate_log(double x)
+{
+    auto const bits = std::bit_cast<std::uint64_t>(x);
+    std::uint64_t const offset = bits - 0x3FE6A09E667F3BCD; // bits of 1/sqrt(2)
+    auto const exponent = static_cast<double>(static_cast<std::int32_t>(static_cast<std::int64_t>(offset) >> 52));
+    double const mantissa = std::bit_cast<double>(bits - (offset & 0xFFF0000000000000));
+    double const s = (mantissa - 1)/(mantissa + 1);
+    double const s2 = s*s;
+    double const log_mantissa = s*(2 + s2*(2./3 + s2*(2./5 + s2*(2./7 + s2*(2./9 + s2*(2./11))))));
+    return exponent*0.69314718055994530942 + log_mantissa;
+}
+
+//! Engines whose random numbers cover all values of 32 or 64 bit unsigned integers, like the engines of this file and `std::mt19937`.
+template<typename Engine>
+concept full_range_engine = std::uniform_random_bit_generator<Engine> && Engine::min()==0
+        && (Engine::max()==std::numeric_limits<std::uint32_t>::max() || Engine::max()==std::numeric_limits<std::uint64_t>::max());
+
+//! Uniform random number in `[0, 1)` from one or two numbers of a full range engine, see uniform_from_bits().
+template<floating_point_number Real, full_range_engine Engine>
+[[nodiscard]] Real uniform_real(Engine& engine)
+{
+    if constexpr (Engine::max()==std::numeric_limits<std::uint32_t>::max()) {
+        auto const high = static_cast<std::uint32_t>(engine());
+        return uniform_from_bits<Real>(high, static_cast<std::uint32_t>(engine()));
+    }
+    else {
+        auto const bits = static_cast<std::uint64_t>(engine());
+        return uniform_from_bits<Real>(static_cast<std::uint32_t>(bits >> 32), static_cast<std::uint32_t>(bits));
+    }
+}
+
+/**
+ * @brief The counter-based Philox4x32-10 random number engine of
+ * [Salmon et al. (2011)](https://doi.org/10.1145/2063384.2063405).
+ *
+ * The engine maps a 128 bit counter and a 64 bit key to a block of four 32 bit random numbers with a bijection of ten
+ * rounds. Since every block only depends on the counter and the key, any number of independent streams can be created
+ * without a shared state, e.g. one stream per sweep and node, which makes results independent of the order in which
+ * threads draw their numbers.
+ *
+ * As a standard random number engine, the engine returns the four numbers of the block of the current counter one by
+ * one, and then increments the counter.
+ */
+class Philox4x32
+{
+public:
+    using result_type = std::uint32_t;
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+private:
+    static constexpr std::uint32_t multiplier_0 = 0xD2511F53, multiplier_1 = 0xCD9E8D57;
+    static constexpr std::uint32_t key_increment_0 = 0x9E3779B9, key_increment_1 = 0xBB67AE85;
+    static constexpr unsigned n_rounds = 10;
+    //! Number of blocks that fill_uniform() computes at once.
+    static constexpr std::size_t batch_size = 16;
+
+    Key key_{};
+    Counter counter_{};
+    Counter block_{};
+    unsigned next_word_{4};
+
+    static constexpr void increment(Counter& counter)
+    {
+        for (auto& word: counter) {
+            if (++word!=0) { return; }
+        }
+    }
+
+public:
+    //! Engine with the key `seed`, whose stream starts at `counter`.
+    explicit Philox4x32(std::uint64_t seed = 0, Counter counter = {})
+            :key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}, counter_(counter) { }
+
+    //! Engine whose key is generated by a seed sequence, e.g. for the replicas of an Ensemble.
+    explicit Philox4x32(std::seed_seq& seeds)
+    {
+        seeds.generate(key_.begin(), key_.end());
+    }
+
+    //! The block of four random numbers that belongs to a counter and a key.
+    static constexpr Counter block(Counter counter, Key key)
+    {
+        for (unsigned round = 0; round<n_rounds; ++round) {
+            std::uint64_t const product_0 = static_cast<std::uint64_t>(multiplier_0)*counter[0];
+            std::uint64_t const product_1 = static_cast<std::uint64_t>(multiplier_1)*counter[2];
+            counter = {static_cast<std::uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product_1),
+                       static_cast<std::uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product_0)};
+            key[0] += key_increment_0;
+            key[1] += key_increment_1;
+        }
+        return counter;
+    }
+
+    //! Restarts the stream with a new key, at the counter `counter`.
+    void seed(std::uint64_t seed, Counter counter = {})
+    {
+        key_ = {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+        set_counter(counter);
+    }
+
+    //! Restarts the stream at the counter `counter`, with the same key.
+    void set_counter(Counter counter)
+    {
+        counter_ = counter;
+        next_word_ = 4;
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] Key const& key() const { return key_; }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        if (next_word_==4) {
+            block_ = block(counter_, key_);
+            increment(counter_);
+            next_word_ = 0;
+        }
+        return block_[next_word_++];
+    }
+
+    //! Skips `n` random numbers.
+    void discard(unsigned long long n)
+    {
+        for (; n>0; --n) { operator()(); }
+    }
+
+    //! Independent stream number `stream_id` of the key of this engine.
+    /**
+     * The stream uses the upper half of the counter, so it consists of \f$2^{66}\f$ numbers, which do not overlap with
+     * the numbers of any other stream id. Streams can be created in any order and on any thread, e.g. one per node.
+     */
+    [[nodiscard]] Philox4x32 substream(std::uint64_t stream_id) const
+    {
+        Philox4x32 stream(*this);
+        stream.set_counter({0, 0, static_cast<std::uint32_t>(stream_id), static_cast<std::uint32_t>(stream_id >> 32)});
+        return stream;
+    }
+
+    //! Fills `out` with uniform random numbers in `[0, 1)`, the same as consecutive calls of uniform_real().
+    /**
+     * The blocks of consecutive counters do not depend on each other, so they are computed in batches that the
+     * compiler can interleave or vectorize.
+     */
+    template<floating_point_number Real>
+    void fill_uniform(std::span<Real> out)
+    {
+        std::size_t i = 0;
+        if (next_word_%2==0) {
+            for (; i<out.size() && next_word_<4; ++i) { out[i] = uniform_real<Real>(*this); }
+            // the words of the counters of a batch are stored word by word, so that every round is a loop over the
+            // counters of the batch without dependencies, which the compiler vectorizes
+            std::array<std::array<std::uint32_t, batch_size>, 4> words;
+            for (; out.size() - i>=2*batch_size; i += 2*batch_size) {
+                for (std::size_t j = 0; j<batch_size; ++j) {
+                    for (std::size_t k = 0; k<4; ++k) { words[k][j] = counter_[k]; }
+                    increment(counter_);
+                }
+                Key key = key_;
+                for (unsigned round = 0; round<n_rounds; ++round) {
+                    for (std::size_t j = 0; j<batch_size; ++j) {
+                        std::uint64_t const product_0 = static_cast<std::uint64_t>(multiplier_0)*words[0][j];
+                        std::uint64_t const product_1 = static_cast<std::uint64_t>(multiplier_1)*words[2][j];
+                        words[0][j] = static_cast<std::uint32_t>(product_1 >> 32) ^ words[1][j] ^ key[0];
+                        words[2][j] = static_cast<std::uint32_t>(product_0 >> 32) ^ words[3][j] ^ key[1];
+                        words[1][j] = static_cast<std::uint32_t>(product_1);
+                        words[3][j] = static_cast<std::uint32_t>(product_0);
+                    }
+                    key[0] += key_increment_0;
+                    key[1] += key_increment_1;
+                }
+                for (std::size_t j = 0; j<batch_size; ++j) {
+                    out[i + 2*j] = uniform_from_bits<Real>(words[0][j], words[1][j]);
+                    out[i + 2*j + 1] = uniform_from_bits<Real>(words[2][j], words[3][j]);
+                }
+            }
+        }
+        for (; i<out.size(); ++i) { out[i] = uniform_real<Real>(*this); }
+    }
+
+    friend bool operator==(Philox4x32 const& lhs, Philox4x32 const& rhs) = default;
+};
+
+/**
+ * @brief The xoshiro256** random number engine of [Blackman and Vigna (2021)](https://doi.org/10.1145/3460772).
+ *
+ * A fast engine with a state of four 64 bit words and a period of \f$2^{256}-1\f$. Independent streams for threads are
+ * created with jump(), which advances the engine by \f$2^{128}\f$ numbers, or with substream(). Unlike Philox4x32, the
+ * numbers of a stream can only be generated one after the other.
+ */
+class Xoshiro256StarStar
+{
+public:
+    using result_type = std::uint64_t;
+    using State = std::array<std::uint64_t, 4>;
+
+private:
+    State state_{};
+
+    static constexpr std::uint64_t rotate_left(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    //! The splitmix64 generator, which fills the state from a seed as recommended by the authors.
+    static constexpr std::uint64_t splitmix64(std::uint64_t& x)
+    {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27))*0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    //! Advances the state by the jump polynomial `polynomial`.
+    void jump(State const& polynomial)
+    {
+        State jumped{};
+        for (std::uint64_t word: polynomial) {
+            for (int bit = 0; bit<64; ++bit) {
+                if (word & (std::uint64_t(1) << bit)) {
+                    for (std::size_t k = 0; k<jumped.size(); ++k) { jumped[k] ^= state_[k]; }
+                }
+                operator()();
+            }
+        }
+        state_ = jumped;
+    }
+
+public:
+    //! Engine whose state is filled by the splitmix64 generator seeded with `seed`.
+    explicit Xoshiro256StarStar(std::uint64_t seed = 0) { this->seed(seed); }
+
+    //! Engine with the given state, which must not be all zero.
+    explicit Xoshiro256StarStar(State const& state) :state_(state) { }
+
+    //! Engine whose state is generated by a seed sequence, e.g. for the replicas of an Ensemble.
+    explicit Xoshiro256StarStar(std::seed_seq& seeds)
+    {
+        std::array<std::uint32_t, 8> words{};
+        seeds.generate(words.begin(), words.end());
+        for (std::size_t k = 0; k<state_.size(); ++k) { state_[k] = (static_cast<std::uint64_t>(words[2*k]) << 32) | words[2*k + 1]; }
+        if (state_==State{}) { state_[0] = 1; }
+    }
+
+    //! Restarts the engine with the state that belongs to `seed`.
+    void seed(std::uint64_t seed)
+    {
+        for (auto& word: state_) { word = splitmix64(seed); }
+    }
+
+    //! @getterFunctionStub
+    [[nodiscard]] State const& state() const { return state_; }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        std::uint64_t const result = rotate_left(state_[1]*5, 7)*9;
+        std::uint64_t const shifted = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= shifted;
+        state_[3] = rotate_left(state_[3], 45);
+        return result;
+    }
+
+    //! Skips `n` random numbers.
+    void discard(unsigned long long n)
+    {
+        for (; n>0; --n) { operator()(); }
+    }
+
+    //! Advances the engine by \f$2^{128}\f$ numbers, which is the distance between two streams of substream().
+    void jump() { jump({0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C, 0xA9582618E03FC9AA, 0x39ABDC4529B1661C}); }
+
+    //! Advances the engine by \f$2^{192}\f$ numbers, e.g. to separate the streams of different processes.
+    void long_jump() { jump({0x76E15D3EFEFDCBBF, 0xC5004E441C522FB3, 0x77710069854EE241, 0x39109BB02ACBE635}); }
+
+    //! Independent stream number `stream_id`, which starts \f$2^{128}\cdot(\text{stream\_id}+1)\f$ numbers after this engine.
+    /**
+     * Creating the stream takes `stream_id + 1` jumps, so this is meant for a stream per thread. Streams per node are
+     * cheaper with Philox4x32::substream().
+     */
+    [[nodiscard]] Xoshiro256StarStar substream(std::uint64_t stream_id) const
+    {
+        Xoshiro256StarStar stream(*this);
+        for (std::uint64_t k = 0; k<=stream_id; ++k) { stream.jump(); }
+        return stream;
+    }
+
+    //! Fills `out` with uniform random numbers in `[0, 1)`, the same as consecutive calls of uniform_real().
+    template<floating_point_number Real>
+    void fill_uniform(std::span<Real> out)
+    {
+        for (auto& value: out) {
+            std::uint64_t const bits = operator()();
+            value = uniform_from_bits<Real>(static_cast<std::uint32_t>(bits >> 32), static_cast<std::uint32_t>(bits));
+        }
+    }
+
+    friend bool operator==(Xoshiro256StarStar const& lhs, Xoshiro256StarStar const& rhs) = default;
+};
+
+}
+#endif //FLIPPY_RANDOM_ENGINES_HPP
@@ -9,60 +9,86 @@
 #include <utility>
 #include <filesystem>
 #include <type_traits>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <algorithm>
 
 namespace fp {
 /**
  * @GlobalsStub
  * @{
  */
-//! shortening of the nlohmann::json namespace, which is an [external open source library](https://github.com/nlohmann/json) bundled by flippy.
-using Json = nlohmann::json;
-
 /**
- * @brief Simple wrapper function around Json objects built in dump() method.
- * @param file_name @FileNameOrPathFileNameStub
- * @param data json data object that is supposed to be stored.
+ * @brief Convenient wrapper around std::find, which only works for std::vectors.
+ *
+ * @tparam T type of the vector elements.
+ * @param v std::vector in which we want to search.
+ * @param el the value of the element that we want to check for.
+ * @return The function returns `true` if `el` is contained in vector `v` (at least once), otherwise it returns `false`.
  */
-static inline void json_dump(std::string const& file_name, const Json& data)
-{
-    std::ofstream o(file_name + ".json");
-    o << data.dump();
-    o.close();
+template<typename T>
+[[maybe_unused]] static bool is_member(std::vector<T> const& v, T const& el){
+    return (std::find(v.begin(),v.end(), el) != v.end());
 }
 
+//! Number of bits per coordinate that are used by morton_key and hilbert_key.
+static constexpr int SPACE_FILLING_CURVE_BITS = 21;
+
 /**
- * @brief Simple wrapper function  that reads the content of a text file into a json object.
- *
- * The file name onb the disk needs to end in '.json' for this function to work.
- * @param file_name @FileNameOrPathFileNameStub
- * @return Json object that was parsed from the provided file.
+ * @brief Position of a point of a three-dimensional grid along the [Z-order (Morton) curve](https://en.wikipedia.org/wiki/Z-order_curve).
  *
- * @warning This function will stream any file into the json object.
- * If the provided file is not a valid json file this will cause runtime errors.
+ * The key is obtained by interleaving the bits of the three coordinates.
+ * @param x x coordinate on the grid. Only the lowest #SPACE_FILLING_CURVE_BITS bits are used.
+ * @param y y coordinate on the grid. Only the lowest #SPACE_FILLING_CURVE_BITS bits are used.
+ * @param z z coordinate on the grid. Only the lowest #SPACE_FILLING_CURVE_BITS bits are used.
+ * @return Position along the curve. Points with close keys are close in space.
  */
-static Json inline json_read(std::string file_name)
-{
-    auto pos_json = file_name.find_last_of(".json");
-    auto not_json = (file_name.size() - 1!=pos_json);
-    if (not_json) { file_name = file_name + ".json"; }
-    std::ifstream o(file_name);
-    Json data;
-    o >> data;
-    o.close();
-    return data;
+[[maybe_unused]] static std::uint64_t morton_key(std::uint32_t x, std::uint32_t y, std::uint32_t z){
+    std::uint64_t key = 0;
+    for (int bit = SPACE_FILLING_CURVE_BITS - 1; bit>=0; --bit) {
+        key = (key << 1) | ((x >> bit) & 1u);
+        key = (key << 1) | ((y >> bit) & 1u);
+        key = (key << 1) | ((z >> bit) & 1u);
+    }
+    return key;
 }
 
 /**
- * @brief Convenient wrapper around std::find, which only works for std::vectors.
+ * @brief Position of a point of a three-dimensional grid along the [Hilbert curve](https://en.wikipedia.org/wiki/Hilbert_curve).
  *
- * @tparam T type of the vector elements.
- * @param v std::vector in which we want to search.
- * @param el the value of the element that we want to check for.
- * @return The function returns `true` if `el` is contained in vector `v` (at least once), otherwise it returns `false`.
+ * Unlike the Morton curve, the Hilbert curve never jumps, i.e., points with consecutive keys are always neighbors on the grid.
+ * The implementation follows [Skilling 2004](https://doi.org/10.1063/1.1751381), which transforms the coordinates
+ * into the transposed Hilbert index, whose bits are then interleaved like in morton_key().
+ * @param x x coordinate on the grid. Only the lowest #SPACE_FILLING_CURVE_BITS bits are used.
+ * @param y y coordinate on the grid. Only the lowest #SPACE_FILLING_CURVE_BITS bits are used.
+ * @param z z coordinate on the grid. Only the lowest #SPACE_FILLING_CURVE_BITS bits are used.
+ * @return Position along the curve.
  */
-template<typename T>
-[[maybe_unused]] static bool is_member(std::vector<T> const& v, T const& el){
-    return (std::find(v.begin(),v.end(), el) != v.end());
+[[maybe_unused]] static std::uint64_t hilbert_key(std::uint32_t x, std::uint32_t y, std::uint32_t z){
+    std::array<std::uint32_t, 3> X{x, y, z};
+    std::uint32_t const M = 1u << (SPACE_FILLING_CURVE_BITS - 1);
+    std::uint32_t t;
+    for (std::uint32_t Q = M; Q>1; Q >>= 1) {
+        std::uint32_t P = Q - 1;
+        for (auto& Xi: X) {
+            if (Xi & Q) { X[0] ^= P; } // invert
+            else { // exchange
+                t = (X[0] ^ Xi) & P;
+                X[0] ^= t;
+                Xi ^= t;
+            }
+        }
+    }
+    // Gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    t = 0;
+    for (std::uint32_t Q = M; Q>1; Q >>= 1) {
+        if (X[2] & Q) { t ^= Q - 1; }
+    }
+    for (auto& Xi: X) { Xi ^= t; }
+    return morton_key(X[0], X[1], X[2]);
 }
  /**@}*/
 }
@@ -371,6 +371,12 @@ public:
     }
 
 };
+
+#ifdef FLIPPY_EXTERN_TEMPLATES
+// instantiated once in flippy.cpp, see flippy.hpp
+extern template class vec3<double>;
+extern template class vec3<float>;
+#endif
 }
 
 #endif //FLIPPY_VEC3_HPP
@@ -0,0 +1,68 @@
+#include "external/catch.hpp"
+#include <random>
+
+#include "membrane_test_fixture.hpp"
+using namespace fp;
+
+namespace {
+
+using TestEnsemble = fp::Ensemble<double, unsigned, MembraneEnergyParameters, std::mt19937, fp::SPHERICAL_TRIANGULATION>;
+
+bool same_positions(fp::Triangulation<double, unsigned> const& lhs, fp::Triangulation<double, unsigned> const& rhs)
+{
+    for (unsigned node_id = 0; node_id<lhs.size(); ++node_id) {
+        if (lhs[node_id].pos!=rhs[node_id].pos) { return false; }
+    }
+    return true;
+}
+
+}
+
+TEST_CASE("Ensemble")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(2, 5, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.9*guv.global_geometry().volume};
+
+    SECTION("Replicas are independent copies of the prototype")
+    {
+        TestEnsemble ensemble(guv, 3, prms, membrane_surface_energy, l_min, 2*l_min, 11, 2);
+        REQUIRE(ensemble.size()==3);
+        CHECK(ensemble.n_threads()==2);
+        for (std::size_t r = 0; r<ensemble.size(); ++r) {
+            CHECK(same_positions(ensemble.replica(r).triangulation, guv));
+            CHECK(ensemble.replica(r).triangulation.global_geometry().area==Approx(guv.global_geometry().area));
+        }
+
+        ensemble.run(3, membrane_replica_sweep<TestEnsemble::Replica>);
+        for (std::size_t r = 0; r<ensemble.size(); ++r) {
+            CHECK(ensemble.replica(r).updater.move_attempt_count()==3*guv.size());
+            CHECK_FALSE(same_positions(ensemble.replica(r).triangulation, guv));
+        }
+        CHECK_FALSE(same_positions(ensemble.replica(0).triangulation, ensemble.replica(1).triangulation));
+        CHECK_FALSE(same_positions(ensemble.replica(1).triangulation, ensemble.replica(2).triangulation));
+    }
+
+    SECTION("Replica streams are derived from the master seed")
+    {
+        TestEnsemble ensemble(guv, 4, prms, membrane_surface_energy, l_min, 2*l_min, 12345, 4);
+        ensemble.run(2, membrane_replica_sweep<TestEnsemble::Replica>);
+
+        std::seed_seq seeds = fp::make_replica_seed_seq(12345, 2);
+        TestEnsemble::Replica serial_replica(guv, seeds, prms, membrane_surface_energy, l_min, 2*l_min);
+        membrane_replica_sweep<TestEnsemble::Replica>(serial_replica);
+        membrane_replica_sweep<TestEnsemble::Replica>(serial_replica);
+        CHECK(same_positions(ensemble.replica(2).triangulation, serial_replica.triangulation));
+
+        TestEnsemble serial_ensemble(guv, 4, prms, membrane_surface_energy, l_min, 2*l_min, 12345, 1);
+        serial_ensemble.run(2, membrane_replica_sweep<TestEnsemble::Replica>);
+        for (std::size_t r = 0; r<ensemble.size(); ++r) {
+            CHECK(same_positions(ensemble.replica(r).triangulation, serial_ensemble.replica(r).triangulation));
+        }
+    }
+
+    SECTION("Invalid ensemble size")
+    {
+        CHECK_THROWS_AS(TestEnsemble(guv, 0, prms, membrane_surface_energy, l_min, 2*l_min, 1), std::invalid_argument);
+    }
+}
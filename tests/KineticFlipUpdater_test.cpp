@@ -0,0 +1,129 @@
+#include "external/catch.hpp"
+#include <random>
+#include <numeric>
+
+#include "flippy.hpp"
+using namespace fp;
+
+namespace {
+
+struct KineticEnergyParameters{double kappa;};
+
+// linear in the global bending energy, so the incremental rate updates are exact
+double kinetic_bending_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                              fp::Triangulation<double, unsigned> const& trg, KineticEnergyParameters const& prms)
+{
+    return prms.kappa*trg.global_geometry().unit_bending_energy;
+}
+
+using TestKineticUpdater = fp::KineticFlipUpdater<double, unsigned, KineticEnergyParameters, std::mt19937, fp::SPHERICAL_TRIANGULATION>;
+
+}
+
+TEST_CASE("Fenwick tree")
+{
+    fp::FenwickTree<double> tree(7);
+    std::vector<double> weights{0.5, 0, 2, 1, 0, 0.25, 3};
+    for (std::size_t i = 0; i<weights.size(); ++i) { tree.set(i, weights[i]); }
+    CHECK(tree.total()==Approx(6.75));
+    CHECK(tree.prefix_sum(3)==Approx(2.5));
+    CHECK(tree.find(0.)==0);
+    CHECK(tree.find(0.49)==0);
+    CHECK(tree.find(0.5)==2);
+    CHECK(tree.find(2.6)==3);
+    CHECK(tree.find(3.6)==5);
+    CHECK(tree.find(6.7)==6);
+    CHECK(tree.find(100.)==6);
+
+    tree.set(6, 0);
+    CHECK(tree.total()==Approx(3.75));
+    CHECK(tree.find(3.75)==5);
+
+    fp::FenwickTree<double> rebuilt;
+    rebuilt.assign(weights);
+    for (std::size_t i = 0; i<=weights.size(); ++i) {
+        CHECK(rebuilt.prefix_sum(i)==Approx(std::accumulate(weights.begin(), weights.begin() + static_cast<long>(i), 0.)));
+    }
+}
+
+TEST_CASE("Kinetic flips")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(3, 7, 2*l_min);
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> distr(-0.3, 0.3);
+    for (unsigned node_id = 0; node_id<guv.size(); ++node_id) { guv.move_node(node_id, {distr(rng), distr(rng), distr(rng)}); }
+    KineticEnergyParameters prms{.kappa=10};
+    TestKineticUpdater updater(guv, prms, kinetic_bending_energy, rng, l_min, 2*l_min);
+    std::size_t const n_bonds = 3*guv.size() - 6;
+    REQUIRE(updater.bond_count()==n_bonds);
+
+    SECTION("every step flips a bond and the time advances")
+    {
+        REQUIRE(updater.total_flip_rate()>0);
+        double time = updater.kinetic_time();
+        for (int i = 0; i<50; ++i) {
+            REQUIRE(updater.kinetic_flip());
+            CHECK(updater.kinetic_time()>time);
+            time = updater.kinetic_time();
+        }
+        CHECK(updater.flip_count()==50);
+        CHECK(updater.bond_count()==n_bonds);
+        std::size_t n_half_bonds = 0;
+        for (auto const& node: guv.nodes()) { n_half_bonds += node.nn_ids.size(); }
+        CHECK(n_half_bonds==2*n_bonds);
+    }
+
+    SECTION("incrementally updated rates agree with a full refresh")
+    {
+        updater.kinetic_flips(100);
+        std::vector<std::tuple<unsigned, unsigned, double>> incremental;
+        for (auto const& node: guv.nodes()) {
+            for (unsigned nn_id: node.nn_ids) {
+                if (node.id<nn_id) { incremental.emplace_back(node.id, nn_id, updater.flip_rate(node.id, nn_id)); }
+            }
+        }
+        updater.refresh_flip_rates();
+        for (auto const& [node_id, nn_id, rate]: incremental) {
+            CHECK(rate==Approx(updater.flip_rate(node_id, nn_id)).margin(1e-9));
+        }
+    }
+
+    SECTION("the bonds follow a reordering of the nodes and flips of other updaters")
+    {
+        updater.kinetic_flips(20);
+        unsigned long const evaluations = updater.rate_evaluation_count();
+        guv.reorder_nodes(fp::HILBERT_CURVE);
+        REQUIRE(updater.kinetic_flip());
+        CHECK(updater.rate_evaluation_count() - evaluations<50);
+        updater.kinetic_flips(20);
+        std::vector<std::tuple<unsigned, unsigned, double>> incremental;
+        for (auto const& node: guv.nodes()) {
+            for (unsigned nn_id: node.nn_ids) {
+                if (node.id<nn_id) { incremental.emplace_back(node.id, nn_id, updater.flip_rate(node.id, nn_id)); }
+            }
+        }
+        REQUIRE(incremental.size()==n_bonds);
+        updater.refresh_flip_rates();
+        for (auto const& [node_id, nn_id, rate]: incremental) {
+            CHECK(rate==Approx(updater.flip_rate(node_id, nn_id)).margin(1e-9));
+        }
+
+        guv.flip_bond(0, guv[0].nn_ids[0], 0, 4*l_min*l_min);
+        unsigned long const evaluations_before_refresh = updater.rate_evaluation_count();
+        REQUIRE(updater.kinetic_flip());
+        CHECK(updater.rate_evaluation_count() - evaluations_before_refresh>=n_bonds);
+        CHECK(updater.bond_count()==n_bonds);
+    }
+
+    SECTION("at zero temperature the energy never increases")
+    {
+        updater.reset_kBT(0);
+        double energy = kinetic_bending_energy(guv[0], guv, prms);
+        while (updater.flip_count()<200 && updater.kinetic_flip()) {
+            double new_energy = kinetic_bending_energy(guv[0], guv, prms);
+            CHECK(new_energy<=energy + 1e-9*std::abs(energy));
+            energy = new_energy;
+        }
+    }
+}
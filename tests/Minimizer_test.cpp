@@ -0,0 +1,125 @@
+#include "external/catch.hpp"
+#include <random>
+
+#include "membrane_test_fixture.hpp"
+using namespace fp;
+
+namespace {
+
+using TestMinimizer = fp::Minimizer<double, unsigned, MembraneEnergyParameters, std::mt19937, fp::SPHERICAL_TRIANGULATION>;
+
+}
+
+TEST_CASE("FIRE minimizer")
+{
+    double l_min = 1.2, l_max = 4;
+    fp::Triangulation<double, unsigned> guv(3, 6, 2*l_max);
+    guv.scale_node_coordinates(1, 1, 0.8);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.9*guv.global_geometry().volume,
+                                  .K_A=1000, .A_t=guv.global_geometry().area};
+    std::mt19937 rng(3);
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, l_max);
+
+    std::vector<double> initial_bond_lengths;
+    for (auto const& node: guv.nodes()) {
+        for (auto const& nn_distance: node.nn_distances) { initial_bond_lengths.push_back(nn_distance.norm()); }
+    }
+    double const initial_min_bond = *std::min_element(initial_bond_lengths.begin(), initial_bond_lengths.end());
+    double const initial_energy = membrane_total_energy(guv, prms);
+
+    TestMinimizer minimizer(guv, updater, prms, membrane_energy_derivatives, 0.01);
+
+    SECTION("the energy goes down and the bond length constraints hold")
+    {
+        auto result = minimizer.minimize(1e-3, 200, 50);
+        CHECK(result.steps<=200);
+        CHECK(minimizer.step_count()==result.steps);
+        CHECK(membrane_total_energy(guv, prms)<0.5*initial_energy);
+        for (auto const& node: guv.nodes()) {
+            for (auto const& nn_distance: node.nn_distances) {
+                CHECK(nn_distance.norm()>=std::min(l_min, initial_min_bond) - 1e-12);
+                CHECK(nn_distance.norm()<=l_max);
+            }
+        }
+        CHECK(guv.global_geometry().volume==Approx(prms.V_t).epsilon(0.05));
+    }
+
+    SECTION("greedy flips never increase the energy and restore the temperature")
+    {
+        updater.reset_kBT(2.5);
+        double energy = membrane_total_energy(guv, prms);
+        unsigned long accepted = minimizer.greedy_flip_pass();
+        CHECK(membrane_total_energy(guv, prms)<=energy + 1e-9*energy);
+        CHECK(updater.kBT()==2.5);
+        CHECK(accepted==updater.flip_attempt_count() - updater.flip_back_count() - updater.bond_length_flip_rejection_count());
+    }
+
+    SECTION("single steps and reset")
+    {
+        double first_force = minimizer.fire_step();
+        CHECK(first_force>0);
+        for (int i = 0; i<20; ++i) { minimizer.fire_step(); }
+        CHECK(minimizer.step_count()==21);
+        minimizer.reset();
+        CHECK(minimizer.time_step()==0.01);
+    }
+}
+
+TEST_CASE("FIRE minimizer after the nodes are reordered")
+{
+    double l_min = 1.2, l_max = 4;
+    fp::Triangulation<double, unsigned> start(3, 6, 2*l_max);
+    start.scale_node_coordinates(1, 1, 0.8);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.9*start.global_geometry().volume,
+                                  .K_A=1000, .A_t=start.global_geometry().area};
+
+    SECTION("the velocities follow the nodes")
+    {
+        auto run = [&](fp::Triangulation<double, unsigned>& guv, bool reorder) {
+            std::mt19937 rng(3);
+            TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, l_max);
+            TestMinimizer minimizer(guv, updater, prms, membrane_energy_derivatives, 0.01);
+            for (int i = 0; i<10; ++i) { minimizer.fire_step(); }
+            if (reorder) { guv.reorder_nodes(fp::HILBERT_CURVE); }
+            for (int i = 0; i<10; ++i) { minimizer.fire_step(); }
+        };
+        fp::Triangulation<double, unsigned> guv(start), reordered_guv(start);
+        run(guv, false);
+        run(reordered_guv, true);
+        REQUIRE(reordered_guv.original_node_ids()!=guv.original_node_ids());
+        for (auto const& node: reordered_guv.nodes()) {
+            auto const& pos = guv[reordered_guv.original_node_id(node.id)].pos;
+            for (int k = 0; k<3; ++k) { CHECK(node.pos[k]==Approx(pos[k]).margin(1e-9)); }
+        }
+    }
+
+    SECTION("the boundary nodes of a plane stay fixed")
+    {
+        using PlanarTriangulation = fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>;
+        PlanarTriangulation plane(8, 8, 10, 10, 2*l_max);
+        std::vector<fp::vec3<double>> initial_positions;
+        for (auto const& node: plane.nodes()) { initial_positions.push_back(node.pos); }
+        std::mt19937 rng(3);
+        auto surface_energy = [](fp::Node<double, unsigned> const&, PlanarTriangulation const& trg, MembraneEnergyParameters const& p) {
+            return membrane_geometry_energy(trg.global_geometry(), p);
+        };
+        auto energy_derivatives = [](PlanarTriangulation const& trg, MembraneEnergyParameters const& p) {
+            return membrane_geometry_energy_derivatives(trg.global_geometry(), p);
+        };
+        MembraneEnergyParameters const plane_prms{.kappa=10, .K_V=0, .V_t=1, .K_A=1000, .A_t=0.8*plane.global_geometry().area};
+        fp::MonteCarloUpdater<double, unsigned, MembraneEnergyParameters, std::mt19937, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>
+                updater(plane, plane_prms, surface_energy, rng, 0.5, 3);
+        fp::Minimizer<double, unsigned, MembraneEnergyParameters, std::mt19937, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>
+                minimizer(plane, updater, plane_prms, energy_derivatives, 0.01);
+        for (int i = 0; i<5; ++i) { minimizer.fire_step(); }
+        plane.reorder_nodes(fp::MORTON_CURVE);
+        for (int i = 0; i<10; ++i) { minimizer.fire_step(); }
+        bool moved_bulk_node = false;
+        for (auto const& node: plane.nodes()) {
+            bool const moved = node.pos!=initial_positions[plane.original_node_id(node.id)];
+            if (plane.boundary_nodes_ids_set().contains(node.id)) { CHECK_FALSE(moved); }
+            else { moved_bulk_node = moved_bulk_node || moved; }
+        }
+        CHECK(moved_bulk_node);
+    }
+}
@@ -0,0 +1,711 @@
+#include "external/catch.hpp"
+#include <random>
+#include <numbers>
+
+#include "membrane_test_fixture.hpp"
+using namespace fp;
+
+TEST_CASE("Annealing schedules")
+{
+    SECTION("linear")
+    {
+        auto schedule = AnnealingSchedule<double>::linear(2, 0, 10);
+        CHECK(schedule.type()==LINEAR_ANNEALING);
+        CHECK(schedule.kBT(0, 0, 0)==Approx(2));
+        CHECK(schedule.kBT(5, 0, 0)==Approx(1));
+        CHECK(schedule.kBT(10, 0, 0)==Approx(0).margin(1e-15));
+        CHECK(schedule.kBT(20, 0, 0)==Approx(0).margin(1e-15));
+    }
+
+    SECTION("exponential")
+    {
+        auto schedule = AnnealingSchedule<double>::exponential(1, 0.01, 10);
+        CHECK(schedule.kBT(0, 0, 0)==Approx(1));
+        CHECK(schedule.kBT(5, 0, 0)==Approx(0.1));
+        CHECK(schedule.kBT(10, 0, 0)==Approx(0.01));
+        CHECK(schedule.kBT(11, 0, 0)==Approx(0.01));
+        CHECK_THROWS_AS(AnnealingSchedule<double>::exponential(1, 0, 10), std::invalid_argument);
+    }
+
+    SECTION("cyclic")
+    {
+        auto schedule = AnnealingSchedule<double>::cyclic(3, 1, 8);
+        CHECK(schedule.kBT(0, 0, 0)==Approx(3));
+        CHECK(schedule.kBT(2, 0, 0)==Approx(2));
+        CHECK(schedule.kBT(4, 0, 0)==Approx(1));
+        CHECK(schedule.kBT(8, 0, 0)==Approx(3));
+        CHECK(schedule.kBT(12, 0, 0)==Approx(1));
+        CHECK_THROWS_AS(AnnealingSchedule<double>::cyclic(3, 1, 0), std::invalid_argument);
+    }
+
+    SECTION("adaptive")
+    {
+        auto schedule = AnnealingSchedule<double>::adaptive(1, 0.1, 0.3, 0.5);
+        CHECK(schedule.kBT(0, 0.2, 0.9)==Approx(1));
+        CHECK(schedule.kBT(1, 1, 0.9)==Approx(0.5));
+        CHECK(schedule.kBT(2, 0.5, 0.1)==Approx(1));
+        CHECK(schedule.kBT(3, 0.15, 0.9)==Approx(0.1));
+        CHECK(schedule.kBT(4, 0.8, 0.1)==Approx(1));
+        CHECK_THROWS_AS(AnnealingSchedule<double>::adaptive(1, 0.1, 0.3, 1), std::invalid_argument);
+    }
+
+    SECTION("constant and quench")
+    {
+        CHECK(AnnealingSchedule<double>::constant(1.5).kBT(100, 7, 0.5)==Approx(1.5));
+        CHECK(AnnealingSchedule<double>::quench().type()==CONSTANT_KBT);
+        CHECK(AnnealingSchedule<double>::quench().kBT(100, 7, 0.5)==0);
+    }
+}
+
+TEST_CASE("Sweep driver")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(3, 7, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*guv.global_geometry().volume};
+    std::mt19937 rng(1234);
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+    updater.reset_linear_displacement(l_min/8);
+
+    SECTION("every node is visited once per sweep")
+    {
+        updater.sweep(3);
+        CHECK(updater.sweep_count()==3);
+        CHECK(updater.move_attempt_count()==3*guv.size());
+        CHECK(updater.flip_attempt_count()==3*guv.size());
+        CHECK(updater.last_sweep_move_acceptance_rate()>0);
+        CHECK(updater.last_sweep_move_acceptance_rate()<=1);
+        CHECK(updater.last_sweep_flip_acceptance_rate()>=0);
+        CHECK(updater.last_sweep_flip_acceptance_rate()<=1);
+    }
+
+    SECTION("the schedule sets the temperature of every sweep")
+    {
+        updater.set_annealing_schedule(AnnealingSchedule<double>::linear(4, 0, 4));
+        REQUIRE(updater.annealing_schedule().has_value());
+        for (double expected_kBT: {4., 3., 2., 1., 0., 0.}) {
+            updater.sweep();
+            CHECK(updater.kBT()==Approx(expected_kBT).margin(1e-15));
+        }
+        updater.clear_annealing_schedule();
+        updater.reset_kBT(0.5);
+        updater.sweep();
+        CHECK(updater.kBT()==Approx(0.5));
+    }
+
+    SECTION("a quench never increases the energy")
+    {
+        updater.set_annealing_schedule(AnnealingSchedule<double>::quench());
+        double energy = membrane_total_energy(guv, prms);
+        for (int i = 0; i<5; ++i) {
+            updater.sweep();
+            double new_energy = membrane_total_energy(guv, prms);
+            CHECK(new_energy<=energy + 1e-9*std::abs(energy));
+            energy = new_energy;
+        }
+        CHECK(updater.kBT()==0);
+    }
+}
+
+TEST_CASE("Metropolis decisions with precomputed logarithms")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> const start(5, 9, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*start.global_geometry().volume};
+
+    SECTION("batches give the same acceptance rates as the default decisions")
+    {
+        auto acceptance_rate = [&](std::size_t batch_size) {
+            fp::Triangulation<double, unsigned> guv(start);
+            std::mt19937 rng(77);
+            TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+            updater.reset_linear_displacement(l_min/4);
+            updater.reset_kBT(50);
+            updater.set_log_uniform_batch_size(batch_size);
+            CHECK(updater.log_uniform_batch_size()==batch_size);
+            updater.sweep(4);
+            return static_cast<double>(updater.move_attempt_count() - updater.move_back_count() - updater.bond_length_move_rejection_count())
+                   /static_cast<double>(updater.move_attempt_count());
+        };
+        double const default_rate = acceptance_rate(0);
+        CHECK(default_rate>0.1);
+        CHECK(default_rate<0.9);
+        CHECK(acceptance_rate(256)==Approx(default_rate).margin(0.03));
+        CHECK(acceptance_rate(7)==Approx(default_rate).margin(0.03));
+    }
+
+    SECTION("the threshold is drawn once per decision and is exponentially distributed")
+    {
+        fp::Triangulation<double, unsigned> guv(start);
+        std::mt19937 rng(78);
+        TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+        updater.set_log_uniform_batch_size(100);
+        updater.reset_kBT(2);
+        double sum = 0;
+        int const n_decisions = 4000;
+        for (int i = 0; i<n_decisions; ++i) {
+            double const threshold = updater.metropolis_threshold();
+            REQUIRE(threshold>=0);
+            REQUIRE(updater.metropolis_threshold()==threshold);
+            sum += threshold;
+            CHECK_FALSE(updater.move_needs_undoing());
+        }
+        CHECK(sum/n_decisions==Approx(2).margin(0.15));
+        updater.reset_kBT(0);
+        CHECK(updater.metropolis_threshold()==0);
+    }
+}
+
+TEST_CASE("Staged energies with early rejections")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> const start(5, 9, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*start.global_geometry().volume};
+    double const K_A = 1000, A_t = 0.95*start.global_geometry().area;
+    using Term = fp::StagedEnergyTerm<double, unsigned, MembraneEnergyParameters>;
+    Term const area_term{.energy=[=](fp::Geometry<double, unsigned> const& geometry, MembraneEnergyParameters const&) {
+        double const dA = geometry.area - A_t;
+        return K_A*dA*dA/A_t;
+    }, .stage=fp::AREA_ENERGY_STAGE};
+    Term shape_term{.energy=[](fp::Geometry<double, unsigned> const& geometry, MembraneEnergyParameters const& p) {
+        double const dV = geometry.volume - p.V_t;
+        return p.kappa*geometry.unit_bending_energy + p.K_V*dV*dV/p.V_t;
+    }};
+    auto staged_run = [&](Term const& second_term, double kBT) {
+        fp::Triangulation<double, unsigned> guv(start);
+        std::mt19937 rng(79);
+        TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+        updater.reset_linear_displacement(l_min/4);
+        updater.reset_kBT(kBT);
+        updater.add_staged_energy_term(area_term);
+        updater.add_staged_energy_term(second_term);
+        auto staged_energy = [&]() {
+            return area_term.energy(guv.global_geometry(), prms) + second_term.energy(guv.global_geometry(), prms);
+        };
+        double const energy_before = staged_energy();
+        updater.sweep(3);
+        return std::tuple{guv, updater.move_back_count(), updater.staged_early_rejection_count(), energy_before, staged_energy()};
+    };
+
+    SECTION("early rejections do not change the decisions")
+    {
+        auto const [unbounded, unbounded_move_back, unbounded_early_rejections, e0, e1] = staged_run(shape_term, 1);
+        CHECK(unbounded_early_rejections==0);
+        Term bounded_term = shape_term;
+        bounded_term.min_delta = [](fp::Geometry<double, unsigned> const& global, fp::Geometry<double, unsigned> const& two_ring,
+                                    fp::vec3<double> const& displacement, MembraneEnergyParameters const& p) {
+            double const max_volume_change = displacement.norm()*two_ring.area/3;
+            return -p.kappa*two_ring.unit_bending_energy - 2*p.K_V*std::abs(global.volume - p.V_t)*max_volume_change/p.V_t;
+        };
+        auto const [bounded, bounded_move_back, bounded_early_rejections, e2, e3] = staged_run(bounded_term, 1);
+        CHECK(bounded_early_rejections>0);
+        CHECK(bounded_move_back==unbounded_move_back);
+        for (unsigned node_id = 0; node_id<start.size(); ++node_id) {
+            CHECK(bounded[node_id].pos==unbounded[node_id].pos);
+        }
+        CHECK(bounded.global_geometry().area==Approx(unbounded.global_geometry().area));
+    }
+
+    SECTION("at zero temperature the staged energy never increases")
+    {
+        auto const [guv, move_back, early_rejections, energy_before, energy_after] = staged_run(shape_term, 0);
+        CHECK(move_back>0);
+        CHECK(energy_after<energy_before);
+        fp::Geometry<double, unsigned> sum{};
+        for (auto const& node: guv.nodes()) { sum += node; }
+        CHECK(guv.global_geometry().area==Approx(sum.area).epsilon(1e-10));
+    }
+}
+
+namespace {
+
+struct PlanarEnergyParameters{double kappa;};
+
+double planar_surface_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                             fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION> const& trg,
+                             PlanarEnergyParameters const& prms)
+{
+    return prms.kappa*trg.global_geometry().unit_bending_energy;
+}
+
+double planar_geometry_energy(fp::Geometry<double, unsigned> const& geometry, PlanarEnergyParameters const& prms)
+{
+    return prms.kappa*geometry.unit_bending_energy;
+}
+
+}
+
+TEST_CASE("Multiple-try Metropolis moves")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> const start(3, 7, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*start.global_geometry().volume};
+    struct MultipleTryRun{fp::Triangulation<double, unsigned> triangulation; double acceptance_rate, mean_volume;};
+    auto run = [&](unsigned n_tries, double kBT, unsigned long n_sweeps) {
+        fp::Triangulation<double, unsigned> guv(start);
+        std::mt19937 rng(80);
+        TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+        updater.set_geometry_energy_function(membrane_geometry_energy);
+        updater.reset_linear_displacement(l_min/8);
+        updater.reset_kBT(kBT);
+        updater.set_multiple_try_count(n_tries);
+        CHECK(updater.multiple_try_count()==n_tries);
+        updater.sweep(5);
+        double volume_sum = 0;
+        for (unsigned long sweep_id = 0; sweep_id<n_sweeps; ++sweep_id) {
+            updater.sweep();
+            volume_sum += guv.global_geometry().volume;
+        }
+        double const acceptance_rate = static_cast<double>(updater.move_attempt_count() - updater.move_back_count() - updater.bond_length_move_rejection_count())
+                                       /static_cast<double>(updater.move_attempt_count());
+        return MultipleTryRun{guv, acceptance_rate, volume_sum/static_cast<double>(n_sweeps)};
+    };
+
+    SECTION("more tries accept more of the large displacements and sample the same distribution")
+    {
+        MultipleTryRun const single = run(1, 1, 200);
+        MultipleTryRun const multiple = run(6, 1, 200);
+        CHECK(multiple.acceptance_rate>single.acceptance_rate + 0.1);
+        CHECK(multiple.mean_volume==Approx(single.mean_volume).epsilon(0.01));
+        fp::Geometry<double, unsigned> sum{};
+        for (auto const& node: multiple.triangulation.nodes()) { sum += node; }
+        CHECK(multiple.triangulation.global_geometry().volume==Approx(sum.volume).epsilon(1e-10));
+    }
+
+    SECTION("at zero temperature the moves never increase the energy")
+    {
+        double const energy_before = membrane_geometry_energy(start.global_geometry(), prms);
+        MultipleTryRun const quench = run(4, 0, 3);
+        CHECK(membrane_geometry_energy(quench.triangulation.global_geometry(), prms)<energy_before);
+    }
+
+    SECTION("moves can be made directly on a fresh updater")
+    {
+        fp::Triangulation<double, unsigned> guv(start);
+        std::mt19937 rng(80);
+        TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+        updater.set_geometry_energy_function(membrane_geometry_energy);
+        updater.reset_linear_displacement(0.1);
+        updater.multiple_try_move_MC_updater(guv[5], 4);
+        CHECK(updater.move_attempt_count()==1);
+        fp::Geometry<double, unsigned> sum{};
+        for (auto const& node: guv.nodes()) { sum += node; }
+        CHECK(guv.global_geometry().volume==Approx(sum.volume).epsilon(1e-10));
+
+        // the boundary nodes of a plane are found anew after the nodes were reordered, which keeps their number
+        fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION> plane(10, 10, 20, 20, 2*l_min);
+        PlanarEnergyParameters planar_prms{.kappa=1};
+        fp::MonteCarloUpdater<double, unsigned, PlanarEnergyParameters, std::mt19937, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>
+                planar_updater(plane, planar_prms, planar_surface_energy, rng, l_min, 2*l_min);
+        planar_updater.set_geometry_energy_function(planar_geometry_energy);
+        planar_updater.reset_linear_displacement(0.2, BULK_NODE_DISPLACEMENT);
+        planar_updater.reset_linear_displacement(0, BOUNDARY_NODE_DISPLACEMENT);
+        planar_updater.multiple_try_move_MC_updater(plane[0], 4);
+        plane.reorder_nodes(fp::MORTON_CURVE);
+        auto const boundary = plane.boundary_nodes_ids_set();
+        std::vector<fp::vec3<double>> initial_positions;
+        for (auto const& node: plane.nodes()) { initial_positions.push_back(node.pos); }
+        for (unsigned node_id = 0; node_id<plane.size(); ++node_id) { planar_updater.multiple_try_move_MC_updater(plane[node_id], 4); }
+        unsigned moved_bulk_nodes = 0;
+        for (unsigned node_id = 0; node_id<plane.size(); ++node_id) {
+            if (boundary.contains(node_id)) { CHECK(plane[node_id].pos==initial_positions[node_id]); }
+            else if (plane[node_id].pos!=initial_positions[node_id]) { ++moved_bulk_nodes; }
+        }
+        CHECK(moved_bulk_nodes>0);
+    }
+}
+
+TEST_CASE("Updaters that own their random number engine")
+{
+    using XoshiroUpdater = fp::MonteCarloUpdater<double, unsigned, MembraneEnergyParameters, fp::Xoshiro256StarStar, fp::SPHERICAL_TRIANGULATION>;
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> const start(3, 7, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*start.global_geometry().volume};
+    auto run = [&](std::uint64_t seed) {
+        fp::Triangulation<double, unsigned> guv(start);
+        XoshiroUpdater updater(guv, prms, membrane_surface_energy, fp::Xoshiro256StarStar(seed), l_min, 2*l_min);
+        updater.reset_linear_displacement(l_min/8);
+        updater.sweep(3);
+        CHECK(updater.move_attempt_count()==3*guv.size());
+        CHECK_FALSE(updater.random_number_engine()==fp::Xoshiro256StarStar(seed));
+        return guv;
+    };
+    auto const first = run(5);
+    auto const second = run(5);
+    auto const other = run(6);
+    for (unsigned node_id = 0; node_id<start.size(); ++node_id) { CHECK(first[node_id].pos==second[node_id].pos); }
+    CHECK_FALSE(first[0].pos==other[0].pos);
+}
+
+TEST_CASE("Displacement adaptation")
+{
+    double l_min = 2;
+
+    SECTION("spherical triangulation")
+    {
+        fp::Triangulation<double, unsigned> guv(3, 7, 2*l_min);
+        MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*guv.global_geometry().volume};
+        std::mt19937 rng(4321);
+        TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+
+        double const initial_displacement = GENERATE(1e-3, 2.);
+        updater.reset_linear_displacement(initial_displacement);
+        updater.adapt_linear_displacement(0.3, 40);
+        CHECK(updater.linear_displacement_is_adapting());
+        updater.sweep(40);
+        CHECK_FALSE(updater.linear_displacement_is_adapting());
+        double const adapted_displacement = updater.linear_displacement();
+        if (initial_displacement<0.1) { CHECK(adapted_displacement>10*initial_displacement); }
+        else { CHECK(adapted_displacement<initial_displacement); }
+        CHECK(adapted_displacement<=2*l_min);
+
+        // the displacement is frozen during production
+        updater.sweep(3);
+        CHECK(updater.linear_displacement()==adapted_displacement);
+        // a sphere has no boundary nodes, so their amplitude is not adapted
+        CHECK(updater.linear_displacement(BOUNDARY_NODE_DISPLACEMENT)==initial_displacement);
+    }
+
+    SECTION("freezing stops the adaptation early")
+    {
+        fp::Triangulation<double, unsigned> guv(2, 5, 2*l_min);
+        MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*guv.global_geometry().volume};
+        std::mt19937 rng(99);
+        TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+        updater.reset_linear_displacement(0.01);
+        updater.adapt_linear_displacement(0.3, 100);
+        updater.sweep();
+        updater.freeze_linear_displacement();
+        double const frozen_displacement = updater.linear_displacement();
+        updater.sweep(2);
+        CHECK(updater.linear_displacement()==frozen_displacement);
+    }
+
+    SECTION("boundary and bulk nodes of a planar triangulation have separate amplitudes")
+    {
+        fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION> plane(10, 10, 20, 20, 2*l_min);
+        PlanarEnergyParameters prms{.kappa=1};
+        std::mt19937 rng(7);
+        fp::MonteCarloUpdater<double, unsigned, PlanarEnergyParameters, std::mt19937, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>
+                updater(plane, prms, planar_surface_energy, rng, l_min, 2*l_min);
+        updater.reset_linear_displacement(0.2, BULK_NODE_DISPLACEMENT);
+        updater.reset_linear_displacement(0, BOUNDARY_NODE_DISPLACEMENT);
+
+        std::vector<fp::vec3<double>> initial_positions;
+        for (auto const& node: plane.nodes()) { initial_positions.push_back(node.pos); }
+        updater.sweep(2);
+        auto const boundary = plane.boundary_nodes_ids_set();
+        REQUIRE_FALSE(boundary.empty());
+        unsigned moved_bulk_nodes = 0;
+        for (unsigned node_id = 0; node_id<plane.size(); ++node_id) {
+            if (boundary.contains(node_id)) { CHECK(plane[node_id].pos==initial_positions[node_id]); }
+            else if (plane[node_id].pos!=initial_positions[node_id]) { ++moved_bulk_nodes; }
+        }
+        CHECK(moved_bulk_nodes>0);
+
+        updater.adapt_linear_displacement(0.3, 5);
+        updater.sweep(5);
+        // a zero amplitude is a fixed point of the multiplicative adaptation
+        CHECK(updater.linear_displacement(BOUNDARY_NODE_DISPLACEMENT)==0);
+        CHECK(updater.linear_displacement(BULK_NODE_DISPLACEMENT)!=0.2);
+    }
+}
+
+TEST_CASE("Force-biased moves")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(3, 7, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*guv.global_geometry().volume};
+    std::mt19937 rng(99);
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+    updater.set_energy_derivative_function(membrane_energy_derivatives);
+
+    SECTION("at zero temperature the moves descend the energy")
+    {
+        updater.reset_kBT(0);
+        double energy = membrane_total_energy(guv, prms);
+        for (int i = 0; i<3; ++i) {
+            for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+                updater.force_biased_move_MC_updater(guv[node_id], 1e-3);
+                double new_energy = membrane_total_energy(guv, prms);
+                CHECK(new_energy<=energy + 1e-9*std::abs(energy));
+                energy = new_energy;
+            }
+        }
+        CHECK(updater.move_attempt_count()==3*guv.size());
+        CHECK(updater.move_back_count()<updater.move_attempt_count());
+        CHECK(energy<membrane_total_energy(fp::Triangulation<double, unsigned>(3, 7, 2*l_min), prms));
+    }
+
+    SECTION("at finite temperature most small steps are accepted")
+    {
+        updater.reset_kBT(1);
+        for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+            updater.force_biased_move_MC_updater(guv[node_id], 1e-3);
+        }
+        CHECK(updater.move_attempt_count()==guv.size());
+        CHECK(updater.move_back_count() + updater.bond_length_move_rejection_count()<guv.size()/2);
+    }
+}
+
+TEST_CASE("Hamiltonian Monte Carlo")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(3, 7, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*guv.global_geometry().volume};
+    std::mt19937 rng(5);
+    // the bonds of the initial mesh are close to l_min, and a single constraint violation rejects the whole trajectory
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, 0.75*l_min, 2*l_min);
+    updater.set_energy_derivative_function(membrane_energy_derivatives);
+    updater.set_total_energy_function(membrane_total_energy);
+
+    SECTION("short trajectories conserve the Hamiltonian and are mostly accepted")
+    {
+        updater.reset_kBT(1);
+        for (int i = 0; i<20; ++i) { updater.hamiltonian_MC_updater(0.005, 5); }
+        CHECK(updater.trajectory_attempt_count()==20);
+        CHECK(updater.trajectory_back_count() + updater.bond_length_trajectory_rejection_count()<=4);
+        CHECK(updater.move_attempt_count()==0);
+    }
+
+    SECTION("a rejected trajectory restores the triangulation")
+    {
+        updater.reset_kBT(1);
+        auto const start = guv;
+        // a huge time step always breaks the bond length constraints or the energy conservation
+        updater.hamiltonian_MC_updater(50, 3);
+        CHECK(updater.trajectory_back_count() + updater.bond_length_trajectory_rejection_count()==1);
+        for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+            for (std::size_t i = 0; i<3; ++i) {
+                CHECK(guv[node_id].pos[i]==Approx(start[node_id].pos[i]).margin(1e-12));
+            }
+        }
+        CHECK(guv.global_geometry().volume==Approx(start.global_geometry().volume));
+        CHECK(guv.global_geometry().unit_bending_energy==Approx(start.global_geometry().unit_bending_energy));
+    }
+
+    SECTION("at zero temperature trajectories never increase the energy")
+    {
+        updater.reset_kBT(0);
+        double energy = membrane_total_energy(guv, prms);
+        for (int i = 0; i<5; ++i) {
+            updater.hamiltonian_sweep(0.005, 4);
+            double new_energy = membrane_total_energy(guv, prms);
+            CHECK(new_energy<=energy + 1e-9*std::abs(energy));
+            energy = new_energy;
+        }
+        CHECK(updater.flip_attempt_count()==5*guv.size());
+        CHECK(energy<membrane_total_energy(fp::Triangulation<double, unsigned>(3, 7, 2*l_min), prms));
+    }
+}
+
+TEST_CASE("Collective moves")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(3, 7, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*guv.global_geometry().volume};
+    std::mt19937 rng(11);
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, 0.75*l_min, 2*l_min);
+
+    SECTION("a move that breaks the bond length constraints is rejected before anything moves")
+    {
+        auto const start = guv;
+        updater.patch_translation_MC_updater(guv.node_patch(3, 1), {3*l_min, 0, 0});
+        updater.rescaling_MC_updater(1);
+        CHECK(updater.collective_move_attempt_count()==2);
+        CHECK(updater.bond_length_collective_move_rejection_count()==2);
+        CHECK(updater.collective_move_back_count()==0);
+        for (unsigned node_id = 0; node_id<guv.size(); ++node_id) { CHECK(guv[node_id].pos==start[node_id].pos); }
+    }
+
+    SECTION("a move that is rejected by the energy is undone")
+    {
+        updater.reset_kBT(0);
+        auto const start = guv;
+        double const energy = membrane_total_energy(guv, prms);
+        // the target volume is smaller than the volume of the initial sphere, so growing costs energy
+        updater.rescaling_MC_updater(0.05);
+        CHECK(updater.collective_move_back_count()==1);
+        CHECK(membrane_total_energy(guv, prms)==Approx(energy));
+        for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+            for (std::size_t i = 0; i<3; ++i) { CHECK(guv[node_id].pos[i]==Approx(start[node_id].pos[i]).margin(1e-12)); }
+        }
+    }
+
+    SECTION("at zero temperature collective moves never increase the energy")
+    {
+        updater.reset_kBT(0);
+        updater.set_total_energy_function(membrane_total_energy);
+        std::uniform_real_distribution<double> distr(-0.1, 0.1);
+        std::uniform_int_distribution<unsigned> node_distr(0, static_cast<unsigned>(guv.size()) - 1);
+        double energy = membrane_total_energy(guv, prms);
+        for (int i = 0; i<30; ++i) {
+            auto const patch = guv.node_patch(node_distr(rng), 2);
+            updater.patch_translation_MC_updater(patch, {distr(rng), distr(rng), distr(rng)});
+            updater.patch_rotation_MC_updater(patch, {distr(rng), distr(rng), 1}, distr(rng));
+            updater.rescaling_MC_updater(distr(rng)/10);
+            double const new_energy = membrane_total_energy(guv, prms);
+            CHECK(new_energy<=energy + 1e-9*std::abs(energy));
+            energy = new_energy;
+        }
+        CHECK(updater.collective_move_attempt_count()==90);
+        CHECK(updater.move_attempt_count()==0);
+        CHECK(energy<membrane_total_energy(fp::Triangulation<double, unsigned>(3, 7, 2*l_min), prms));
+        auto rebuilt = guv;
+        rebuilt.make_global_geometry();
+        CHECK(guv.global_geometry().volume==Approx(rebuilt.global_geometry().volume));
+        CHECK(guv.global_geometry().unit_bending_energy==Approx(rebuilt.global_geometry().unit_bending_energy));
+    }
+
+    SECTION("rigid rotations keep the shape of the patch")
+    {
+        auto const patch = guv.node_patch(0, 1);
+        auto const start = guv;
+        updater.reset_kBT(1e9);
+        updater.patch_rotation_MC_updater(patch, {0, 1, 1}, 0.05);
+        REQUIRE(updater.collective_move_back_count() + updater.bond_length_collective_move_rejection_count()==0);
+        for (unsigned i: patch) {
+            for (unsigned j: patch) {
+                CHECK((guv[i].pos - guv[j].pos).norm()==Approx((start[i].pos - start[j].pos).norm()));
+            }
+        }
+    }
+}
+
+TEST_CASE("Fourier mode moves")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned, fp::EXPERIMENTAL_PLANAR_TRIANGULATION> plane(10, 10, 20, 20, 2*l_min);
+    PlanarEnergyParameters prms{.kappa=1};
+    std::mt19937 rng(13);
+    fp::MonteCarloUpdater<double, unsigned, PlanarEnergyParameters, std::mt19937, fp::EXPERIMENTAL_PLANAR_TRIANGULATION>
+            updater(plane, prms, planar_surface_energy, rng, 0.75*l_min, 2*l_min);
+    updater.reset_kBT(1e9);
+    auto const start = plane;
+    double const wave_number = 2*std::numbers::pi/20;
+    updater.fourier_mode_MC_updater(wave_number, 0, 0.2);
+    REQUIRE(updater.collective_move_back_count() + updater.bond_length_collective_move_rejection_count()==0);
+
+    auto const boundary = plane.boundary_nodes_ids_set();
+    for (unsigned node_id = 0; node_id<plane.size(); ++node_id) {
+        vec3<double> const displacement = plane[node_id].pos - start[node_id].pos;
+        CHECK(displacement[0]==0);
+        CHECK(displacement[1]==0);
+        double const expected = boundary.contains(node_id) ? 0 : 0.2*std::cos(wave_number*start[node_id].pos[0]);
+        CHECK(displacement[2]==Approx(expected).margin(1e-12));
+    }
+    CHECK(plane.global_geometry().unit_bending_energy>start.global_geometry().unit_bending_energy);
+}
+
+namespace {
+
+struct ParallelRun{
+    fp::Triangulation<double, unsigned> triangulation;
+    unsigned long move_attempts, move_rejections, flip_attempts, flip_rejections;
+    std::size_t n_colors;
+};
+
+ParallelRun run_parallel_sweeps(fp::Triangulation<double, unsigned> const& start, MembraneEnergyParameters const& prms,
+                                unsigned n_threads, fp::ParallelSweepMode mode, std::uint64_t seed = 2024, double kBT = 1)
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(start);
+    std::mt19937 rng(99);
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+    updater.set_geometry_energy_function(membrane_geometry_energy);
+    updater.reset_parallel_seed(seed);
+    updater.reset_linear_displacement(l_min/8);
+    updater.reset_kBT(kBT);
+    fp::ThreadPool pool(n_threads);
+    updater.parallel_sweep(5, pool, mode);
+    CHECK(updater.sweep_count()==5);
+    return {guv, updater.move_attempt_count(), updater.move_back_count() + updater.bond_length_move_rejection_count(),
+            updater.flip_attempt_count(), updater.flip_back_count() + updater.bond_length_flip_rejection_count(),
+            updater.move_color_count()};
+}
+
+//! Mean volume over the sweeps after the first n_equilibration ones.
+double mean_parallel_sweep_volume(fp::Triangulation<double, unsigned> const& start, MembraneEnergyParameters const& prms,
+                                  fp::ParallelSweepMode mode, std::uint64_t seed, int n_equilibration, int n_sweeps)
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(start);
+    std::mt19937 rng(99);
+    TestUpdater updater(guv, prms, membrane_surface_energy, rng, l_min, 2*l_min);
+    updater.set_geometry_energy_function(membrane_geometry_energy);
+    updater.reset_parallel_seed(seed);
+    updater.reset_linear_displacement(l_min/8);
+    fp::ThreadPool pool(2);
+    updater.parallel_sweep(n_equilibration, pool, mode);
+    double volume_sum = 0;
+    for (int sweep = 0; sweep<n_sweeps; ++sweep) {
+        updater.parallel_sweep(1, pool, mode);
+        volume_sum += guv.global_geometry().volume;
+    }
+    return volume_sum/n_sweeps;
+}
+
+}
+
+TEST_CASE("Parallel sweep")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> const start(4, 9, 4*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.8*start.global_geometry().volume};
+
+    SECTION("the deterministic mode gives bitwise identical results for any number of threads")
+    {
+        ParallelRun const serial = run_parallel_sweeps(start, prms, 1, fp::DETERMINISTIC_PARALLEL_SWEEP);
+        ParallelRun const parallel = run_parallel_sweeps(start, prms, 4, fp::DETERMINISTIC_PARALLEL_SWEEP);
+        for (unsigned node_id = 0; node_id<start.size(); ++node_id) {
+            CHECK(serial.triangulation[node_id].pos==parallel.triangulation[node_id].pos);
+            CHECK(serial.triangulation[node_id].nn_ids==parallel.triangulation[node_id].nn_ids);
+        }
+        CHECK(serial.triangulation.global_geometry().area==parallel.triangulation.global_geometry().area);
+        CHECK(serial.triangulation.global_geometry().volume==parallel.triangulation.global_geometry().volume);
+        CHECK(serial.triangulation.global_geometry().unit_bending_energy==parallel.triangulation.global_geometry().unit_bending_energy);
+        CHECK(serial.move_rejections==parallel.move_rejections);
+        CHECK(serial.flip_rejections==parallel.flip_rejections);
+
+        ParallelRun const other_seed = run_parallel_sweeps(start, prms, 1, fp::DETERMINISTIC_PARALLEL_SWEEP, 2025);
+        CHECK_FALSE(other_seed.triangulation[0].pos==serial.triangulation[0].pos);
+    }
+
+    SECTION("every node is moved and flipped once per sweep, and the global geometry stays consistent")
+    {
+        for (auto mode: {fp::DETERMINISTIC_PARALLEL_SWEEP, fp::FAST_PARALLEL_SWEEP}) {
+            ParallelRun const run = run_parallel_sweeps(start, prms, 2, mode);
+            CHECK(run.move_attempts==5*start.size());
+            CHECK(run.flip_attempts==5*start.size());
+            CHECK(run.move_rejections<run.move_attempts);
+            CHECK(run.n_colors>1);
+            CHECK(run.n_colors<start.size()/4);
+            fp::Geometry<double, unsigned> sum{};
+            for (auto const& node: run.triangulation.nodes()) { sum += node; }
+            CHECK(run.triangulation.global_geometry().area==Approx(sum.area).epsilon(1e-10));
+            CHECK(run.triangulation.global_geometry().volume==Approx(sum.volume).epsilon(1e-10));
+            CHECK(run.triangulation.global_geometry().unit_bending_energy==Approx(sum.unit_bending_energy).epsilon(1e-10));
+        }
+    }
+
+    SECTION("the fast mode samples the same distribution as the deterministic mode")
+    {
+        MembraneEnergyParameters const soft_prms{.kappa=10, .K_V=20, .V_t=0.8*start.global_geometry().volume};
+        double const deterministic = mean_parallel_sweep_volume(start, soft_prms, fp::DETERMINISTIC_PARALLEL_SWEEP, 7, 100, 400);
+        double const fast = mean_parallel_sweep_volume(start, soft_prms, fp::FAST_PARALLEL_SWEEP, 8, 100, 400);
+        // the bending rigidity keeps the vesicle well above the target volume of the soft constraint
+        CHECK(deterministic>soft_prms.V_t + 50);
+        CHECK(deterministic<start.global_geometry().volume);
+        CHECK(fast==Approx(deterministic).epsilon(0.015));
+    }
+
+    SECTION("at zero temperature the deterministic mode never increases the energy")
+    {
+        fp::Triangulation<double, unsigned> previous(start);
+        for (std::uint64_t seed = 1; seed<4; ++seed) {
+            ParallelRun const run = run_parallel_sweeps(previous, prms, 2, fp::DETERMINISTIC_PARALLEL_SWEEP, seed, 0);
+            double const energy_before = membrane_total_energy(previous, prms);
+            CHECK(membrane_total_energy(run.triangulation, prms)<=energy_before + 1e-9*std::abs(energy_before));
+            previous = run.triangulation;
+        }
+    }
+}
@@ -62,6 +62,35 @@ TEST_CASE("pop emplace test"){
 }
 
 
+TEST_CASE("reserve_nn_capacity test"){
+    Nodes<double, unsigned short> icosa_nodes(ICOSA_DATA);
+    icosa_nodes.reserve_nn_capacity(12);
+    for (auto const& node: icosa_nodes) {
+        CHECK(node.nn_ids.capacity()>=12);
+        CHECK(node.nn_distances.capacity()>=12);
+        CHECK(node.nn_ids.size()==5);
+    }
+
+    SECTION("copies keep the reserved storage") {
+        Nodes<double, unsigned short> copied_nodes(icosa_nodes);
+        Nodes<double, unsigned short> assigned_nodes(ICOSA_DATA);
+        assigned_nodes = icosa_nodes;
+        for (auto const* nodes: {&copied_nodes, &assigned_nodes}) {
+            for (auto const& node: *nodes) {
+                CHECK(node.nn_ids.capacity()>=12);
+                CHECK(node.nn_distances.capacity()>=12);
+                CHECK(node.nn_ids.size()==5);
+            }
+        }
+        Triangulation<double, unsigned> const trg(2, 5, 2);
+        Triangulation<double, unsigned> const copied_trg(trg);
+        for (auto const& node: copied_trg.nodes()) {
+            CHECK(node.nn_ids.capacity()>=12);
+            CHECK(node.nn_distances.capacity()>=12);
+        }
+    }
+}
+
 TEST_CASE("get_distance_to test"){
     using real = double;
     using idx = unsigned short;
@@ -0,0 +1,133 @@
+#include "external/catch.hpp"
+#include <atomic>
+#include <numeric>
+#include <random>
+
+#include "membrane_test_fixture.hpp"
+using namespace fp;
+
+namespace {
+
+using TestReplicaExchange = fp::ReplicaExchange<double, unsigned, MembraneEnergyParameters, std::mt19937, fp::SPHERICAL_TRIANGULATION>;
+
+}
+
+TEST_CASE("ThreadPool")
+{
+    for (unsigned n_threads: {1u, 2u, 4u}) {
+        fp::ThreadPool pool(n_threads);
+        CHECK(pool.size()==n_threads);
+
+        std::vector<std::atomic<int>> calls(1000);
+        for (auto& c: calls) { c = 0; }
+        pool.parallel_for(calls.size(), [&](std::size_t i) { ++calls[i]; });
+        pool.parallel_for(calls.size(), [&](std::size_t i) { ++calls[i]; });
+        for (auto const& c: calls) { CHECK(c==2); }
+
+        std::atomic<int> finished{0};
+        CHECK_THROWS_AS(pool.parallel_for(100, [&](std::size_t i) {
+            if (i==17) { throw std::runtime_error("task failed"); }
+            ++finished;
+        }), std::runtime_error);
+        CHECK(finished==99);
+
+        // the pool is still usable after an exception
+        std::atomic<std::size_t> sum{0};
+        pool.parallel_for(10, [&](std::size_t i) { sum += i; });
+        CHECK(sum==45);
+    }
+}
+
+TEST_CASE("Replica exchange")
+{
+    double l_min = 2;
+    fp::Triangulation<double, unsigned> guv(2, 5, 2*l_min);
+    MembraneEnergyParameters prms{.kappa=10, .K_V=100, .V_t=0.9*guv.global_geometry().volume};
+    std::vector<double> kBTs{1, 2, 4, 8};
+
+    SECTION("Temperatures are swapped and not meshes")
+    {
+        TestReplicaExchange rex(guv, kBTs, prms, membrane_surface_energy, l_min, 2*l_min, membrane_replica_sweep<TestReplicaExchange::Replica>,
+                                membrane_total_energy, 42, 2);
+        REQUIRE(rex.size()==kBTs.size());
+        std::vector<fp::Triangulation<double, unsigned> const*> meshes;
+        for (std::size_t r = 0; r<rex.size(); ++r) { meshes.push_back(&rex.replica(r).triangulation); }
+
+        rex.run(20);
+        CHECK(rex.exchange_round_count()==20);
+
+        std::vector<std::size_t> replica_ids;
+        for (std::size_t t = 0; t<rex.size(); ++t) {
+            std::size_t r = rex.replica_at_temperature(t);
+            replica_ids.push_back(r);
+            CHECK(rex.temperature_of_replica(r)==t);
+            CHECK(rex.replica(r).updater.kBT()==Approx(kBTs[t]));
+            CHECK(&rex.replica(r).triangulation==meshes[r]);
+            CHECK(rex.energy_of_replica(r)==Approx(membrane_total_energy(rex.replica(r).triangulation, prms)));
+        }
+        std::sort(replica_ids.begin(), replica_ids.end());
+        std::vector<std::size_t> all_ids(rex.size());
+        std::iota(all_ids.begin(), all_ids.end(), 0);
+        CHECK(replica_ids==all_ids);
+
+        auto const& attempts = rex.swap_attempt_count();
+        auto const acceptance = rex.acceptance_matrix();
+        for (std::size_t i = 0; i<rex.size(); ++i) {
+            for (std::size_t j = 0; j<rex.size(); ++j) {
+                CHECK(attempts[i][j]==attempts[j][i]);
+                CHECK(acceptance[i][j]==Approx(acceptance[j][i]));
+                CHECK(acceptance[i][j]>=0);
+                CHECK(acceptance[i][j]<=1);
+                if ((i>j ? i - j : j - i)!=1) { CHECK(attempts[i][j]==0); }
+            }
+        }
+        // pairs (0,1) and (2,3) are proposed in even rounds, the pair (1,2) in odd rounds
+        CHECK(attempts[0][1]==10);
+        CHECK(attempts[1][2]==10);
+        CHECK(attempts[2][3]==10);
+    }
+
+    SECTION("Swaps without an energy difference are always accepted")
+    {
+        TestReplicaExchange rex(guv, kBTs, prms, membrane_surface_energy, l_min, 2*l_min,
+                                [](TestReplicaExchange::Replica&) { },
+                                [](fp::Triangulation<double, unsigned> const&, MembraneEnergyParameters const&) { return 0.; },
+                                7, 1);
+        rex.run(1);
+        CHECK(rex.replica_at_temperature(0)==1);
+        CHECK(rex.replica_at_temperature(1)==0);
+        CHECK(rex.replica_at_temperature(2)==3);
+        CHECK(rex.replica_at_temperature(3)==2);
+        rex.run(1);
+        CHECK(rex.replica_at_temperature(1)==3);
+        CHECK(rex.replica_at_temperature(2)==0);
+        CHECK(rex.replica(3).updater.kBT()==Approx(kBTs[1]));
+        auto const acceptance = rex.acceptance_matrix();
+        for (std::size_t t = 0; t + 1<rex.size(); ++t) { CHECK(acceptance[t][t + 1]==Approx(1)); }
+    }
+
+    SECTION("The result does not depend on the number of threads")
+    {
+        TestReplicaExchange rex_serial(guv, kBTs, prms, membrane_surface_energy, l_min, 2*l_min, membrane_replica_sweep<TestReplicaExchange::Replica>,
+                                       membrane_total_energy, 3, 1);
+        TestReplicaExchange rex_parallel(guv, kBTs, prms, membrane_surface_energy, l_min, 2*l_min, membrane_replica_sweep<TestReplicaExchange::Replica>,
+                                         membrane_total_energy, 3, 4);
+        rex_serial.run(5);
+        rex_parallel.run(5);
+        CHECK(rex_serial.swap_acceptance_count()==rex_parallel.swap_acceptance_count());
+        for (std::size_t r = 0; r<rex_serial.size(); ++r) {
+            CHECK(rex_serial.temperature_of_replica(r)==rex_parallel.temperature_of_replica(r));
+            for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+                CHECK(rex_serial.replica(r).triangulation[node_id].pos==rex_parallel.replica(r).triangulation[node_id].pos);
+            }
+        }
+    }
+
+    SECTION("Invalid temperatures")
+    {
+        CHECK_THROWS_AS(TestReplicaExchange(guv, {}, prms, membrane_surface_energy, l_min, 2*l_min, membrane_replica_sweep<TestReplicaExchange::Replica>,
+                                            membrane_total_energy, 1), std::invalid_argument);
+        CHECK_THROWS_AS(TestReplicaExchange(guv, {1, 0}, prms, membrane_surface_energy, l_min, 2*l_min, membrane_replica_sweep<TestReplicaExchange::Replica>,
+                                            membrane_total_energy, 1), std::invalid_argument);
+    }
+}
@@ -1,5 +1,6 @@
 #include "external/catch.hpp"
 #include <array>
+#include <random>
 #include <iostream>
 
 #define TESTING_FLIPPY_TRIANGULATION_ndh6jclc0qnp274b = 1
@@ -152,7 +153,388 @@ TEST_CASE("Proper move")
         }
     }
 
+    SECTION("area_change_after_move agrees with the area change of the moved triangulation") {
+        vec3<double> displ2{0.1, -0.2, 0.15};
+        double const area_before = icosa_triangulation.global_geometry().area;
+        auto const area_change = icosa_triangulation.area_change_after_move(3, displ2);
+        REQUIRE(area_change.has_value());
+        CHECK(*area_change==Approx(icosa_triangulation.two_ring_geometry_after_move(3, displ2).area
+                                   - icosa_triangulation.get_two_ring_geometry(3).area));
+        icosa_triangulation.move_node(3, displ2);
+        CHECK(area_before + *area_change==Approx(icosa_triangulation.global_geometry().area));
+    }
+
+}
+TEST_CASE("Lazy global geometry")
+{
+    using idx = unsigned long;
+    double small_number = 1e-8;
+    Triangulation<double, idx, SPHERICAL_TRIANGULATION> eager_sphere(8, 1, 0);
+    Triangulation<double, idx, SPHERICAL_TRIANGULATION> lazy_sphere(eager_sphere);
+    lazy_sphere.set_lazy_global_geometry(true);
+    CHECK(lazy_sphere.lazy_global_geometry());
+    CHECK(!eager_sphere.lazy_global_geometry());
+
+    std::mt19937_64 rng(1234);
+    std::uniform_int_distribution<idx> rid(0, eager_sphere.size()-1);
+    std::uniform_real_distribution<double> displ_distr(-0.01, 0.01);
+
+    SECTION("moves and flips give the same global geometry as the eager bookkeeping"){
+        for (unsigned int repeat = 0; repeat<200; ++repeat) {
+            idx node_id = rid(rng);
+            vec3<double> displ{displ_distr(rng), displ_distr(rng), displ_distr(rng)};
+            eager_sphere.move_node(node_id, displ);
+            lazy_sphere.move_node(node_id, displ);
+
+            auto const& nn_ids = eager_sphere[node_id].nn_ids;
+            idx nn_id = nn_ids[repeat%nn_ids.size()];
+            auto bfd_eager = eager_sphere.flip_bond(node_id, nn_id, 0, max_float);
+            auto bfd_lazy = lazy_sphere.flip_bond(node_id, nn_id, 0, max_float);
+            CHECK(bfd_eager.flipped==bfd_lazy.flipped);
+            if (bfd_eager.flipped && repeat%3==0) {
+                eager_sphere.unflip_bond(node_id, nn_id, bfd_eager);
+                lazy_sphere.unflip_bond(node_id, nn_id, bfd_lazy);
+            }
+            if (repeat%50==0) {
+                CHECK(Approx(eager_sphere.global_geometry().area).margin(small_number)==lazy_sphere.global_geometry().area);
+            }
+        }
+        CHECK(Approx(eager_sphere.global_geometry().area).margin(small_number)==lazy_sphere.global_geometry().area);
+        CHECK(Approx(eager_sphere.global_geometry().volume).margin(small_number)==lazy_sphere.global_geometry().volume);
+        CHECK(Approx(eager_sphere.global_geometry().unit_bending_energy).margin(small_number)==lazy_sphere.global_geometry().unit_bending_energy);
+    }
+
+    SECTION("switching the lazy mode off brings the global geometry up to date"){
+        for (unsigned int repeat = 0; repeat<20; ++repeat) {
+            idx node_id = rid(rng);
+            vec3<double> displ{displ_distr(rng), displ_distr(rng), displ_distr(rng)};
+            eager_sphere.move_node(node_id, displ);
+            lazy_sphere.move_node(node_id, displ);
+        }
+        lazy_sphere.set_lazy_global_geometry(false);
+        CHECK(Approx(eager_sphere.global_geometry().area).margin(small_number)==lazy_sphere.global_geometry_.area);
+        CHECK(Approx(eager_sphere.global_geometry().volume).margin(small_number)==lazy_sphere.global_geometry_.volume);
+    }
+}
+
+TEST_CASE("Compact Verlet list")
+{
+    using idx = unsigned long;
+    static_assert(std::is_same_v<verlet_index_t<unsigned long long>, std::uint32_t>);
+    static_assert(std::is_same_v<verlet_index_t<unsigned short>, unsigned short>);
+
+    Triangulation<double, idx, SPHERICAL_TRIANGULATION> sphere(6, 1, 0.5);
+    Triangulation<double, idx, SPHERICAL_TRIANGULATION> compact_sphere(sphere);
+    CHECK(!compact_sphere.uses_compact_verlet_list());
+    compact_sphere.set_compact_verlet_list(true);
+    CHECK(compact_sphere.uses_compact_verlet_list());
+    auto const& compact_list = compact_sphere.compact_verlet_list();
+    REQUIRE(compact_list.size()==sphere.size());
+
+    std::size_t n_neighbours = 0;
+    for (idx node_id = 0; node_id<sphere.size(); ++node_id) {
+        CHECK(compact_sphere[node_id].verlet_list.empty());
+        auto row = compact_list[node_id];
+        CHECK(std::is_sorted(row.begin(), row.end()));
+        std::vector<idx> compact_row(row.begin(), row.end());
+        std::vector<idx> verlet_list = sphere[node_id].verlet_list;
+        std::sort(verlet_list.begin(), verlet_list.end());
+        CHECK(compact_row==verlet_list);
+        n_neighbours += verlet_list.size();
+    }
+    CHECK(n_neighbours>0);
+    CHECK(compact_list.neighbour_ids.size()==n_neighbours);
+
+    compact_sphere.set_compact_verlet_list(false);
+    CHECK(compact_sphere.compact_verlet_list().size()==0);
+    CHECK(compact_sphere[0].verlet_list==sphere[0].verlet_list);
+}
+
+template<floating_point_number Real, indexing_number Index, TriangulationType triangulation_type>
+void reordering_test(Triangulation<Real, Index, triangulation_type>& trg, SpaceFillingCurve curve)
+{
+    Triangulation<Real, Index, triangulation_type> original(trg);
+    std::vector<Index> old_ids = trg.reorder_nodes(curve);
+    std::vector<Index> original_ids = trg.original_node_ids();
+    CHECK(old_ids==original_ids);
+
+    std::vector<Index> sorted_ids(old_ids);
+    std::sort(sorted_ids.begin(), sorted_ids.end());
+    for (Index i = 0; i<trg.size(); ++i) { CHECK(sorted_ids[i]==i); }
+
+    std::vector<Index> new_ids(trg.size());
+    for (Index i = 0; i<trg.size(); ++i) { new_ids[old_ids[i]] = i; }
+    for (Index node_id = 0; node_id<trg.size(); ++node_id) {
+        auto const& node = trg[node_id];
+        auto const& original_node = original[old_ids[node_id]];
+        CHECK(node.id==node_id);
+        CHECK(node.pos==original_node.pos);
+        CHECK(node.area==original_node.area);
+        for (std::size_t j = 0; j<node.nn_ids.size(); ++j) {
+            CHECK(node.nn_ids[j]==new_ids[original_node.nn_ids[j]]);
+            CHECK(node.nn_distances[j]==original_node.nn_distances[j]);
+        }
+        CHECK(node.verlet_list.size()==original_node.verlet_list.size());
+    }
+
+    auto geometry = trg.global_geometry();
+    trg.make_global_geometry();
+    CHECK(Approx(geometry.area).epsilon(1e-10)==trg.global_geometry().area);
+    CHECK(Approx(geometry.unit_bending_energy).epsilon(1e-10)==trg.global_geometry().unit_bending_energy);
+}
+
+TEST_CASE("Space-filling curves")
+{
+    SECTION("hilbert curve visits all grid points of a cube before leaving it, without jumps") {
+        std::vector<std::pair<std::uint64_t, std::array<std::uint32_t, 3>>> keyed_points;
+        for (std::uint32_t x = 0; x<4; ++x) {
+            for (std::uint32_t y = 0; y<4; ++y) {
+                for (std::uint32_t z = 0; z<4; ++z) { keyed_points.push_back({hilbert_key(x, y, z), {x, y, z}}); }
+            }
+        }
+        std::sort(keyed_points.begin(), keyed_points.end());
+        for (std::size_t i = 0; i<keyed_points.size(); ++i) {
+            CHECK(keyed_points[i].first==i);
+            if (i>0) {
+                unsigned int manhattan_distance = 0;
+                for (std::size_t k = 0; k<3; ++k) {
+                    auto a = keyed_points[i].second[k], b = keyed_points[i - 1].second[k];
+                    manhattan_distance += (a>b) ? a - b : b - a;
+                }
+                CHECK(manhattan_distance==1);
+            }
+        }
+    }
+
+    SECTION("morton keys interleave the coordinate bits") {
+        CHECK(morton_key(0, 0, 0)==0);
+        CHECK(morton_key(0, 0, 1)==1);
+        CHECK(morton_key(0, 1, 0)==2);
+        CHECK(morton_key(1, 0, 0)==4);
+        CHECK(morton_key(3, 3, 3)==63);
+    }
+
+    SECTION("reordering a sphere along a hilbert curve") {
+        Triangulation<double, unsigned int, SPHERICAL_TRIANGULATION> sphere(6, 10, 4);
+        reordering_test(sphere, HILBERT_CURVE);
+        SECTION("reordering twice composes the original ids") {
+            std::vector<unsigned int> first_original_ids = sphere.original_node_ids();
+            std::vector<unsigned int> old_ids = sphere.reorder_nodes(MORTON_CURVE);
+            for (unsigned int i = 0; i<sphere.size(); ++i) {
+                CHECK(sphere.original_node_id(i)==first_original_ids[old_ids[i]]);
+            }
+        }
+    }
+
+    SECTION("reordering a sphere with a compact Verlet list") {
+        Triangulation<double, unsigned long, SPHERICAL_TRIANGULATION> sphere(6, 10, 4);
+        sphere.set_compact_verlet_list(true);
+        auto old_ids = sphere.reorder_nodes(MORTON_CURVE);
+        Triangulation<double, unsigned long, SPHERICAL_TRIANGULATION> rebuilt(sphere);
+        rebuilt.make_verlet_list();
+        CHECK(sphere.compact_verlet_list().offsets==rebuilt.compact_verlet_list().offsets);
+        CHECK(sphere.compact_verlet_list().neighbour_ids==rebuilt.compact_verlet_list().neighbour_ids);
+    }
+
+    SECTION("reordering a plane keeps the boundary intact") {
+        Triangulation<double, unsigned int, EXPERIMENTAL_PLANAR_TRIANGULATION> plane(10, 10, 10, 10, 2);
+        auto boundary = plane.boundary_nodes_ids_set();
+        reordering_test(plane, HILBERT_CURVE);
+        std::set<unsigned int> original_boundary;
+        for (auto node_id: plane.boundary_nodes_ids_set()) { original_boundary.insert(plane.original_node_id(node_id)); }
+        CHECK(original_boundary==boundary);
+    }
 }
+
+template<TriangulationType triangulation_type>
+GeometryGradient<double> moved_geometry_gradient(Triangulation<double, unsigned, triangulation_type> const& trg, unsigned node_id, double step)
+{
+    GeometryGradient<double> gradient{};
+    for (std::size_t direction = 0; direction<3; ++direction) {
+        vec3<double> displacement{0, 0, 0};
+        displacement[direction] = step;
+        auto forward = trg, backward = trg;
+        forward.move_node(node_id, displacement);
+        backward.move_node(node_id, -displacement);
+        auto const& f = forward.global_geometry();
+        auto const& b = backward.global_geometry();
+        gradient.area[direction] = (f.area - b.area)/(2*step);
+        gradient.volume[direction] = (f.volume - b.volume)/(2*step);
+        gradient.unit_bending_energy[direction] = (f.unit_bending_energy - b.unit_bending_energy)/(2*step);
+    }
+    return gradient;
+}
+
+void check_vec3_approx(vec3<double> const& v, vec3<double> const& target, double relative_margin, double scale)
+{
+    for (std::size_t i = 0; i<3; ++i) { CHECK(v[i]==Approx(target[i]).margin(relative_margin*scale)); }
+}
+
+TEST_CASE("Geometry gradients")
+{
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> distr(-0.3, 0.3);
+
+    SECTION("spherical triangulation")
+    {
+        Triangulation<double, unsigned> guv(4, 10, 4);
+        guv.scale_node_coordinates(1, 1, 0.7);
+        for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+            guv.move_node(node_id, {distr(rng), distr(rng), distr(rng)});
+        }
+
+        for (unsigned node_id: {0u, 7u, 33u, 101u}) {
+            vec3<double> displacement{distr(rng), distr(rng), distr(rng)};
+            auto moved = guv;
+            moved.move_node(node_id, displacement);
+            auto speculative = guv.global_geometry_after_move(node_id, displacement);
+            CHECK(speculative.area==Approx(moved.global_geometry().area).epsilon(1e-12));
+            CHECK(speculative.volume==Approx(moved.global_geometry().volume).epsilon(1e-12));
+            CHECK(speculative.unit_bending_energy==Approx(moved.global_geometry().unit_bending_energy).epsilon(1e-10));
+            check_vec3_approx(guv[node_id].pos, moved[node_id].pos - displacement, 1e-12, 1);
+
+            auto gradient = guv.geometry_gradient(node_id);
+            auto numeric = moved_geometry_gradient(guv, node_id, 1e-5);
+            check_vec3_approx(gradient.area, numeric.area, 1e-6, numeric.area.norm());
+            check_vec3_approx(gradient.volume, numeric.volume, 1e-6, numeric.volume.norm());
+            check_vec3_approx(gradient.unit_bending_energy, numeric.unit_bending_energy, 1e-4, numeric.unit_bending_energy.norm());
+            check_vec3_approx(guv.area_gradient(node_id), -guv[node_id].area*guv[node_id].curvature_vec, 1e-12, 1);
+
+            Geometry<double, unsigned> energy_derivatives(2., -3., 5.);
+            check_vec3_approx(guv.energy_gradient(node_id, energy_derivatives),
+                              2.*gradient.area - 3.*gradient.volume + 5.*gradient.unit_bending_energy, 1e-12, 1);
+            Geometry<double, unsigned> area_and_volume_derivatives(2., -3., 0.);
+            check_vec3_approx(guv.energy_gradient(node_id, area_and_volume_derivatives),
+                              2.*gradient.area - 3.*gradient.volume, 1e-12, 1);
+        }
+    }
+
+    SECTION("planar triangulation")
+    {
+        Triangulation<double, unsigned, EXPERIMENTAL_PLANAR_TRIANGULATION> plane(10, 10, 20, 20, 4);
+        auto const boundary = plane.boundary_nodes_ids_set();
+        for (unsigned node_id = 0; node_id<plane.size(); ++node_id) {
+            if (!boundary.contains(node_id)) { plane.move_node(node_id, {distr(rng), distr(rng), distr(rng)}); }
+        }
+        std::vector<unsigned> bulk_next_to_boundary, deep_bulk;
+        for (unsigned node_id = 0; node_id<plane.size(); ++node_id) {
+            if (boundary.contains(node_id)) { continue; }
+            bool touches_boundary = std::any_of(plane[node_id].nn_ids.begin(), plane[node_id].nn_ids.end(),
+                                                [&](unsigned nn_id) { return boundary.contains(nn_id); });
+            (touches_boundary ? bulk_next_to_boundary : deep_bulk).push_back(node_id);
+        }
+        REQUIRE_FALSE(bulk_next_to_boundary.empty());
+        REQUIRE_FALSE(deep_bulk.empty());
+
+        for (unsigned node_id: {*boundary.begin(), bulk_next_to_boundary.front(), deep_bulk.front()}) {
+            auto gradient = plane.geometry_gradient(node_id);
+            auto numeric = moved_geometry_gradient(plane, node_id, 1e-5);
+            double area_scale = std::max(1., numeric.area.norm());
+            check_vec3_approx(gradient.area, numeric.area, 1e-5, area_scale);
+            check_vec3_approx(gradient.unit_bending_energy, numeric.unit_bending_energy, 1e-4,
+                              std::max(1., numeric.unit_bending_energy.norm()));
+            Geometry<double, unsigned> energy_derivatives(2., 0., 5.);
+            check_vec3_approx(plane.energy_gradient(node_id, energy_derivatives),
+                              2.*gradient.area + 5.*gradient.unit_bending_energy, 1e-12, 1);
+        }
+    }
+}
+
+template<TriangulationType triangulation_type>
+void check_batched_move(Triangulation<double, unsigned, triangulation_type> trg, std::vector<unsigned> const& node_ids,
+                        std::vector<vec3<double>> const& displacements)
+{
+    auto sequential = trg;
+    for (std::size_t i = 0; i<node_ids.size(); ++i) { sequential.move_node(node_ids[i], displacements[i]); }
+    trg.move_nodes(node_ids, displacements);
+    for (unsigned node_id = 0; node_id<trg.size(); ++node_id) {
+        check_vec3_approx(trg[node_id].pos, sequential[node_id].pos, 1e-12, 1);
+        CHECK(trg[node_id].area==Approx(sequential[node_id].area).margin(1e-12));
+        CHECK(trg[node_id].unit_bending_energy==Approx(sequential[node_id].unit_bending_energy).margin(1e-10));
+    }
+    CHECK(trg.global_geometry().area==Approx(sequential.global_geometry().area).epsilon(1e-12));
+    CHECK(trg.global_geometry().volume==Approx(sequential.global_geometry().volume).epsilon(1e-12));
+    CHECK(trg.global_geometry().unit_bending_energy==Approx(sequential.global_geometry().unit_bending_energy).epsilon(1e-10));
+    auto rebuilt = trg;
+    rebuilt.make_global_geometry();
+    CHECK(trg.global_geometry().area==Approx(rebuilt.global_geometry().area).epsilon(1e-12));
+    CHECK(trg.global_geometry().unit_bending_energy==Approx(rebuilt.global_geometry().unit_bending_energy).epsilon(1e-10));
+}
+
+TEST_CASE("Batched node moves")
+{
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> distr(-0.3, 0.3);
+
+    SECTION("node patches grow ring by ring")
+    {
+        Triangulation<double, unsigned> guv(4, 10, 4);
+        CHECK(guv.node_patch(11, 0)==std::vector<unsigned>{11});
+        auto one_ring = guv.node_patch(11, 1);
+        CHECK(one_ring.size()==guv[11].nn_ids.size() + 1);
+        auto two_rings = guv.node_patch(11, 2);
+        CHECK(std::equal(one_ring.begin(), one_ring.end(), two_rings.begin()));
+        std::set<unsigned> unique_ids(two_rings.begin(), two_rings.end());
+        CHECK(unique_ids.size()==two_rings.size());
+        CHECK(guv.node_patch(11, 100).size()==guv.size());
+    }
+
+    SECTION("moving a patch of a sphere at once is the same as moving its nodes one by one")
+    {
+        Triangulation<double, unsigned> guv(4, 10, 4);
+        auto patch = guv.node_patch(5, 2);
+        std::vector<vec3<double>> displacements;
+        for (std::size_t i = 0; i<patch.size(); ++i) { displacements.push_back({distr(rng), distr(rng), distr(rng)}); }
+        check_batched_move(guv, patch, displacements);
+        guv.set_lazy_global_geometry(true);
+        check_batched_move(guv, patch, displacements);
+    }
+
+    SECTION("moving bulk and boundary nodes of a plane at once")
+    {
+        Triangulation<double, unsigned, EXPERIMENTAL_PLANAR_TRIANGULATION> plane(10, 10, 20, 20, 4);
+        unsigned const corner = *plane.boundary_nodes_ids_set().begin();
+        auto patch = plane.node_patch(corner, 3);
+        std::vector<vec3<double>> displacements;
+        for (std::size_t i = 0; i<patch.size(); ++i) { displacements.push_back({distr(rng), distr(rng), distr(rng)}); }
+        check_batched_move(plane, patch, displacements);
+    }
+
+    SECTION("the parallel recalculation gives the same result for every number of threads")
+    {
+        Triangulation<double, unsigned> guv(12, 10, 4);
+        std::vector<unsigned> node_ids;
+        std::vector<vec3<double>> displacements;
+        for (unsigned node_id = 0; node_id<guv.size(); node_id += 2) {
+            node_ids.push_back(node_id);
+            displacements.push_back({distr(rng), distr(rng), distr(rng)});
+        }
+        REQUIRE(guv.size()>4*Triangulation<double, unsigned>::move_nodes_chunk_size);
+        auto serial = guv, single_thread = guv;
+        serial.move_nodes(node_ids, displacements);
+        ThreadPool pool(3), one_thread_pool(1);
+        guv.move_nodes(node_ids, displacements, pool);
+        single_thread.move_nodes(node_ids, displacements, one_thread_pool);
+        CHECK(guv.global_geometry().area==serial.global_geometry().area);
+        CHECK(guv.global_geometry().volume==serial.global_geometry().volume);
+        CHECK(guv.global_geometry().unit_bending_energy==single_thread.global_geometry().unit_bending_energy);
+        for (unsigned node_id = 0; node_id<guv.size(); ++node_id) {
+            CHECK(guv[node_id].unit_bending_energy==serial[node_id].unit_bending_energy);
+        }
+    }
+
+    SECTION("translating the whole triangulation does not change its shape")
+    {
+        Triangulation<double, unsigned> guv(4, 10, 4);
+        auto const before = guv.global_geometry();
+        vec3<double> const mass_center = guv.calculate_mass_center();
+        guv.translate_all_nodes({1, -2, 3});
+        CHECK(guv.global_geometry().area==Approx(before.area).epsilon(1e-12));
+        CHECK(guv.global_geometry().unit_bending_energy==Approx(before.unit_bending_energy).epsilon(1e-10));
+        check_vec3_approx(guv.calculate_mass_center(), mass_center + vec3<double>{1, -2, 3}, 1e-12, 1);
+    }
+}
+
 TEST_CASE("Proper topology change")
 {
 
@@ -171,6 +553,20 @@ TEST_CASE("Proper topology change")
         CHECK(icosa[7].nn_ids==std::vector<unsigned long>{2,0,1,6,11,8});
     }
 
+    SECTION("the connectivity version changes with every flip and unflip, but not with moves"){
+        Triangulation<double, unsigned long, SPHERICAL_TRIANGULATION> sphere(3, 1, 0);
+        unsigned long const version = sphere.connectivity_version();
+        sphere.move_node(0, {0.01, 0, 0});
+        CHECK(sphere.connectivity_version()==version);
+        unsigned long const nn_id = sphere[0].nn_ids[0];
+        auto const bfd = sphere.flip_bond(0, nn_id, 0, max_float);
+        REQUIRE(bfd.flipped);
+        CHECK(sphere.connectivity_version()!=version);
+        unsigned long const flipped_version = sphere.connectivity_version();
+        sphere.unflip_bond(0, nn_id, bfd);
+        CHECK(sphere.connectivity_version()!=flipped_version);
+    }
+
     SECTION("Property check: unflip reverses flip"){
         using idx = unsigned long;
         double r_init = 1;
@@ -212,6 +608,9 @@ TEST_CASE("Proper topology change")
         std::sort(cnns.begin(), cnns.end());
         CHECK(two_cnns==std::array<unsigned long, 2>{1, 6});
         CHECK(cnns==std::vector<unsigned long>{1, 6});
+
+        CHECK(icosa_triangulation.common_neighbour_count(5, 7)==2);
+        CHECK(icosa_triangulation.common_neighbour_count(0, 11)==0);
     }
 
     SECTION("CHECK new two common neighbours on STAR_DATA examples") {
@@ -0,0 +1,115 @@
+#include "external/catch.hpp"
+#include <cstdint>
+#include <random>
+
+// the core headers and the binary serialization must not depend on the json library
+#include "Triangulation.hpp"
+#include "MonteCarloUpdater.hpp"
+#include "io/binary.hpp"
+#ifdef INCLUDE_NLOHMANN_JSON_HPP_
+#error "The core headers of flippy include the json library."
+#endif
+#include "io/json.hpp"
+
+using namespace fp;
+static constexpr auto max_float = 3.40282347e+38F;
+
+namespace {
+
+//! A small triangulation whose nodes were moved and flipped, such that its data is not symmetric.
+fp::Triangulation<double, unsigned> shuffled_triangulation()
+{
+    fp::Triangulation<double, unsigned> trg(3, 5, 1.5);
+    std::mt19937 rng(81);
+    std::uniform_real_distribution<double> displacement_distr(-0.05, 0.05);
+    for (unsigned node_id = 0; node_id<trg.size(); ++node_id) {
+        trg.move_node(node_id, {displacement_distr(rng), displacement_distr(rng), displacement_distr(rng)});
+        trg.flip_bond(node_id, trg[node_id].nn_ids[0], 0, max_float);
+    }
+    trg.make_verlet_list();
+    return trg;
+}
+
+template<floating_point_number Real, indexing_number Index, floating_point_number OtherReal, indexing_number OtherIndex>
+void check_same_nodes(Nodes<Real, Index> const& nodes, Nodes<OtherReal, OtherIndex> const& other_nodes, double epsilon)
+{
+    REQUIRE(nodes.size()==other_nodes.size());
+    for (std::size_t i = 0; i<nodes.size(); ++i) {
+        auto const& node = nodes.data[i];
+        auto const& other_node = other_nodes.data[i];
+        CHECK(static_cast<std::size_t>(node.id)==static_cast<std::size_t>(other_node.id));
+        CHECK(node.area==Approx(other_node.area).epsilon(epsilon));
+        CHECK(node.volume==Approx(other_node.volume).epsilon(epsilon));
+        CHECK(node.unit_bending_energy==Approx(other_node.unit_bending_energy).epsilon(epsilon));
+        for (int k = 0; k<3; ++k) {
+            CHECK(node.pos[k]==Approx(other_node.pos[k]).epsilon(epsilon));
+            CHECK(node.curvature_vec[k]==Approx(other_node.curvature_vec[k]).epsilon(epsilon).margin(epsilon));
+        }
+        REQUIRE(node.nn_ids.size()==other_node.nn_ids.size());
+        for (std::size_t j = 0; j<node.nn_ids.size(); ++j) {
+            CHECK(static_cast<std::size_t>(node.nn_ids[j])==static_cast<std::size_t>(other_node.nn_ids[j]));
+        }
+        CHECK(node.verlet_list.size()==other_node.verlet_list.size());
+    }
+}
+
+}
+
+TEST_CASE("Serialization of the nodes")
+{
+    auto const trg = shuffled_triangulation();
+
+    SECTION("json egg data recreates the triangulation")
+    {
+        fp::Json const egg = trg.make_egg_data();
+        CHECK(egg.size()==trg.size());
+        fp::Triangulation<double, unsigned> copy(egg, 1.5);
+        check_same_nodes(trg.nodes(), copy.nodes(), 1e-12);
+        CHECK(copy.global_geometry().volume==Approx(trg.global_geometry().volume).epsilon(1e-12));
+    }
+
+    SECTION("binary egg data recreates the triangulation exactly, and is read into other number types")
+    {
+        io::BinaryEggData const egg = trg.make_egg_data<io::BinaryNodesSerializer>();
+        Nodes<double, unsigned> const nodes(egg);
+        for (std::size_t i = 0; i<trg.size(); ++i) {
+            CHECK(nodes.data[i].pos==trg.nodes().data[i].pos);
+            CHECK(nodes.data[i].verlet_list==trg.nodes().data[i].verlet_list);
+        }
+        check_same_nodes(trg.nodes(), nodes, 0);
+        fp::Triangulation<double, unsigned> copy(egg, 1.5);
+        CHECK(copy.global_geometry().area==Approx(trg.global_geometry().area).epsilon(1e-12));
+
+        check_same_nodes(trg.nodes(), Nodes<float, std::uint64_t>(egg), 1e-6);
+        auto const float_egg = Nodes<float, std::uint64_t>(egg).make_data<io::BinaryNodesSerializer>();
+        CHECK(float_egg.bytes.size()<egg.bytes.size() + 4*trg.size());
+        check_same_nodes(trg.nodes(), Nodes<double, unsigned>(float_egg), 1e-6);
+    }
+
+    SECTION("binary egg data of 2 byte indices and long double numbers is read back")
+    {
+        Nodes<long double, unsigned short> const wide_nodes(trg.make_egg_data<io::BinaryNodesSerializer>());
+        io::BinaryEggData const wide_egg = wide_nodes.make_data<io::BinaryNodesSerializer>();
+        Nodes<long double, unsigned short> const wide_copy(wide_egg);
+        for (std::size_t i = 0; i<trg.size(); ++i) { CHECK(wide_copy.data[i].pos==wide_nodes.data[i].pos); }
+        check_same_nodes(wide_nodes, wide_copy, 0);
+        check_same_nodes(trg.nodes(), Nodes<double, unsigned char>(wide_egg), 1e-12);
+    }
+
+    SECTION("binary egg data is much smaller than json egg data")
+    {
+        auto const binary_size = trg.make_egg_data<io::BinaryNodesSerializer>().bytes.size();
+        auto const json_size = trg.make_egg_data().dump().size();
+        CHECK(2*binary_size<json_size);
+    }
+
+    SECTION("malformed binary egg data is rejected")
+    {
+        io::BinaryEggData egg = trg.make_egg_data<io::BinaryNodesSerializer>();
+        io::BinaryEggData truncated{std::vector<std::uint8_t>(egg.bytes.begin(), egg.bytes.end() - 3)};
+        CHECK_THROWS_AS((Nodes<double, unsigned>(truncated)), std::runtime_error);
+        egg.bytes[0] = 'X';
+        CHECK_THROWS_AS((Nodes<double, unsigned>(egg)), std::runtime_error);
+        CHECK_THROWS_AS((Nodes<double, unsigned>(io::BinaryEggData{})), std::runtime_error);
+    }
+}
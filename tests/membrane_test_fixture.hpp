@@ -0,0 +1,54 @@
+#ifndef FLIPPY_MEMBRANE_TEST_FIXTURE_HPP
+#define FLIPPY_MEMBRANE_TEST_FIXTURE_HPP
+// Energy and sweep of a vesicle with bending rigidity, a volume constraint and an optional area constraint, which are
+// shared by the tests of the updaters, the minimizer and the replica containers.
+#include <random>
+
+#include "flippy.hpp"
+
+struct MembraneEnergyParameters{double kappa, K_V, V_t, K_A = 0, A_t = 1;};
+
+inline double membrane_geometry_energy(fp::Geometry<double, unsigned> const& geometry, MembraneEnergyParameters const& prms)
+{
+    double dV = geometry.volume - prms.V_t;
+    double dA = geometry.area - prms.A_t;
+    return prms.kappa*geometry.unit_bending_energy + prms.K_V*dV*dV/prms.V_t + prms.K_A*dA*dA/prms.A_t;
+}
+
+//! Derivatives of membrane_geometry_energy() with respect to the area, the volume and the unit bending energy.
+inline fp::Geometry<double, unsigned> membrane_geometry_energy_derivatives(fp::Geometry<double, unsigned> const& geometry,
+                                                                           MembraneEnergyParameters const& prms)
+{
+    double dV = geometry.volume - prms.V_t;
+    double dA = geometry.area - prms.A_t;
+    return fp::Geometry<double, unsigned>(2*prms.K_A*dA/prms.A_t, 2*prms.K_V*dV/prms.V_t, prms.kappa);
+}
+
+inline double membrane_total_energy(fp::Triangulation<double, unsigned> const& trg, MembraneEnergyParameters const& prms)
+{
+    return membrane_geometry_energy(trg.global_geometry(), prms);
+}
+
+inline double membrane_surface_energy([[maybe_unused]] fp::Node<double, unsigned> const& node,
+                                      fp::Triangulation<double, unsigned> const& trg, MembraneEnergyParameters const& prms)
+{
+    return membrane_total_energy(trg, prms);
+}
+
+inline fp::Geometry<double, unsigned> membrane_energy_derivatives(fp::Triangulation<double, unsigned> const& trg,
+                                                                  MembraneEnergyParameters const& prms)
+{
+    return membrane_geometry_energy_derivatives(trg.global_geometry(), prms);
+}
+
+using TestUpdater = fp::MonteCarloUpdater<double, unsigned, MembraneEnergyParameters, std::mt19937, fp::SPHERICAL_TRIANGULATION>;
+
+//! One sweep of node moves and bond flips of an fp::Replica, with a fixed displacement amplitude.
+template<typename Replica>
+void membrane_replica_sweep(Replica& replica)
+{
+    replica.updater.reset_linear_displacement(0.2);
+    replica.updater.sweep();
+}
+
+#endif //FLIPPY_MEMBRANE_TEST_FIXTURE_HPP
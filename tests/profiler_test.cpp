@@ -0,0 +1,85 @@
+#define FLIPPY_PROFILING
+#include "external/catch.hpp"
+#include <thread>
+#include <string>
+
+// Only the profiler is included, since FLIPPY_PROFILING must be defined consistently for all flippy templates of a program.
+#include "utilities/profiler.hpp"
+#include "external/json.hpp"
+
+namespace {
+
+void profiled_inner() { FLIPPY_PROFILE_SCOPE("inner"); }
+
+void profiled_outer(int n_inner)
+{
+    FLIPPY_PROFILE_SCOPE("outer");
+    for (int i = 0; i<n_inner; ++i) { profiled_inner(); }
+}
+
+}
+
+TEST_CASE("Profiler call tree")
+{
+    fp::Profiler& profiler = fp::Profiler::thread_profiler();
+    profiler.reset();
+    for (int i = 0; i<3; ++i) { profiled_outer(2); }
+    profiled_inner();
+
+    SECTION("scopes are recorded per call path")
+    {
+        auto const& nodes = profiler.nodes();
+        REQUIRE(nodes.size()==4);
+        REQUIRE(nodes[0].children.size()==2);
+        auto const& outer = nodes[nodes[0].children[0]];
+        auto const& top_level_inner = nodes[nodes[0].children[1]];
+        CHECK(std::string(outer.name)=="outer");
+        CHECK(outer.calls==3);
+        REQUIRE(outer.children.size()==1);
+        auto const& nested_inner = nodes[outer.children[0]];
+        CHECK(std::string(nested_inner.name)=="inner");
+        CHECK(nested_inner.calls==6);
+        CHECK(nested_inner.total_ticks<=outer.total_ticks);
+        CHECK(std::string(top_level_inner.name)=="inner");
+        CHECK(top_level_inner.calls==1);
+    }
+
+    SECTION("json export")
+    {
+        auto const data = profiler.json();
+        REQUIRE(data.size()==2);
+        CHECK(data[0]["name"]=="outer");
+        CHECK(data[0]["calls"]==3);
+        CHECK(data[0]["children"][0]["name"]=="inner");
+        CHECK(data[0]["children"][0]["calls"]==6);
+        // self and child times are converted from ticks separately, so they may differ from the total by a rounding step
+        auto const self_plus_children = static_cast<double>(data[0]["self_ns"].get<std::uint64_t>() + data[0]["children"][0]["total_ns"].get<std::uint64_t>());
+        CHECK(self_plus_children==Approx(static_cast<double>(data[0]["total_ns"].get<std::uint64_t>())).margin(2));
+    }
+
+    SECTION("folded stacks export")
+    {
+        std::string const folded = profiler.folded_stacks();
+        CHECK(folded.find("outer;inner ")!=std::string::npos);
+        CHECK(folded.find("\ninner ")!=std::string::npos);
+    }
+
+    SECTION("every thread records its own call tree")
+    {
+        std::size_t other_thread_nodes = 0;
+        std::thread worker([&] {
+            profiled_outer(1);
+            other_thread_nodes = fp::Profiler::thread_profiler().nodes().size();
+        });
+        worker.join();
+        CHECK(other_thread_nodes==3);
+        CHECK(profiler.nodes().size()==4);
+    }
+
+    SECTION("reset discards all calls")
+    {
+        profiler.reset();
+        CHECK(profiler.nodes().size()==1);
+        CHECK(profiler.folded_stacks().empty());
+    }
+}
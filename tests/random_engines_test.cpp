@@ -0,0 +1,151 @@
+#include "external/catch.hpp"
+#include <cmath>
+#include <limits>
+#include <set>
+#include <span>
+#include <vector>
+
+#include "utilities/random_engines.hpp"
+
+TEST_CASE("Philox4x32")
+{
+    using fp::Philox4x32;
+
+    SECTION("the blocks match the known answers of the reference implementation")
+    {
+        CHECK(Philox4x32::block({0, 0, 0, 0}, {0, 0})==Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+        CHECK(Philox4x32::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+              ==Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+        CHECK(Philox4x32::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+              ==Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+    }
+
+    SECTION("the engine returns the blocks of consecutive counters")
+    {
+        Philox4x32 engine(0x299f31d0a4093822, {0xffffffff, 7, 0, 3});
+        auto const first = Philox4x32::block({0xffffffff, 7, 0, 3}, engine.key());
+        auto const second = Philox4x32::block({0, 8, 0, 3}, engine.key());
+        for (auto word: first) { CHECK(engine()==word); }
+        for (auto word: second) { CHECK(engine()==word); }
+    }
+
+    SECTION("seeding and resetting the counter restart the stream")
+    {
+        Philox4x32 engine(42);
+        auto const a = engine();
+        engine.discard(5);
+        engine.set_counter({});
+        CHECK(engine()==a);
+        engine.seed(43);
+        CHECK(engine()!=a);
+        engine.seed(42);
+        CHECK(engine()==a);
+        Philox4x32 copy(42);
+        copy();
+        CHECK(engine==copy);
+    }
+
+    SECTION("uniform numbers cover [0, 1)")
+    {
+        CHECK(fp::uniform_from_bits<double>(0, 0)==0);
+        CHECK(fp::uniform_from_bits<double>(0x80000000, 0)==0.5);
+        CHECK(fp::uniform_from_bits<double>(0xffffffff, 0xffffffff)<1);
+        CHECK(fp::uniform_from_bits<float>(0xffffffff, 0xffffffff)<1);
+        Philox4x32 engine(7);
+        std::set<int> bins;
+        for (int i = 0; i<1000; ++i) {
+            auto const high = engine();
+            double const u = fp::uniform_from_bits<double>(high, engine());
+            REQUIRE(u>=0);
+            REQUIRE(u<1);
+            bins.insert(static_cast<int>(10*u));
+        }
+        CHECK(bins.size()==10);
+    }
+}
+
+TEST_CASE("Xoshiro256StarStar")
+{
+    using fp::Xoshiro256StarStar;
+
+    SECTION("the numbers match the reference implementation")
+    {
+        Xoshiro256StarStar engine(Xoshiro256StarStar::State{1, 2, 3, 4});
+        CHECK(engine()==11520);
+        CHECK(engine()==0);
+        CHECK(engine()==1509978240);
+        CHECK(engine()==1215971899390074240);
+        CHECK(engine()==1216172134540287360);
+        CHECK(Xoshiro256StarStar(0).state()[0]==0xE220A8397B1DCDAF);
+    }
+
+    SECTION("jumps commute with the steps of the engine, and substreams differ")
+    {
+        Xoshiro256StarStar jumped_first(2024);
+        jumped_first.jump();
+        jumped_first.discard(3);
+        Xoshiro256StarStar stepped_first(2024);
+        stepped_first.discard(3);
+        stepped_first.jump();
+        CHECK(jumped_first==stepped_first);
+
+        Xoshiro256StarStar const engine(2024);
+        Xoshiro256StarStar jumped_twice(engine);
+        jumped_twice.jump();
+        jumped_twice.jump();
+        CHECK(engine.substream(1)==jumped_twice);
+        std::set<std::uint64_t> first_numbers;
+        for (std::uint64_t stream_id = 0; stream_id<4; ++stream_id) { first_numbers.insert(engine.substream(stream_id)()); }
+        CHECK(first_numbers.size()==4);
+        Xoshiro256StarStar long_jumped(engine);
+        long_jumped.long_jump();
+        CHECK_FALSE(long_jumped==jumped_twice);
+    }
+}
+
+TEST_CASE("Batches of uniform numbers")
+{
+    SECTION("Philox4x32 batches are the same as single numbers, also in the middle of a block")
+    {
+        for (unsigned offset: {0u, 1u, 2u, 3u}) {
+            fp::Philox4x32 batch_engine(11, {5, 0, 0, 0});
+            fp::Philox4x32 single_engine(batch_engine);
+            batch_engine.discard(offset);
+            single_engine.discard(offset);
+            std::vector<double> batch(37);
+            batch_engine.fill_uniform(std::span<double>(batch));
+            for (double u: batch) { CHECK(u==fp::uniform_real<double>(single_engine)); }
+            CHECK(batch_engine==single_engine);
+        }
+    }
+
+    SECTION("Xoshiro256StarStar batches are the same as single numbers")
+    {
+        fp::Xoshiro256StarStar batch_engine(11);
+        fp::Xoshiro256StarStar single_engine(batch_engine);
+        std::vector<float> batch(19);
+        batch_engine.fill_uniform(std::span<float>(batch));
+        for (float u: batch) { CHECK(u==fp::uniform_real<float>(single_engine)); }
+    }
+
+    SECTION("Philox4x32 substreams are independent of the counter of the engine")
+    {
+        fp::Philox4x32 engine(3);
+        auto const first = engine.substream(9)();
+        engine.discard(10);
+        CHECK(engine.substream(9)()==first);
+        CHECK(engine.substream(10)()!=first);
+    }
+}
+
+TEST_CASE("Approximate logarithm")
+{
+    CHECK(fp::approximate_log(1)==Approx(0).margin(fp::approximate_log_error));
+    CHECK(fp::approximate_log(0.5)==Approx(std::log(0.5)).margin(fp::approximate_log_error));
+    fp::Xoshiro256StarStar engine(5);
+    for (int i = 0; i<100000; ++i) {
+        double const u = fp::uniform_real<double>(engine);
+        double const x = std::ldexp(u + 0x1p-60, -(i%900));
+        REQUIRE(std::abs(fp::approximate_log(x) - std::log(x))<fp::approximate_log_error);
+    }
+}